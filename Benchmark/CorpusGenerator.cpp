@@ -0,0 +1,73 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// CorpusGenerator.cpp
+//
+// Created By: Bryan J Muscedere
+// Date: 19/10/26.
+//
+// Writes a synthetic C/C++ project with a compilation database so it can
+// be extracted by ClangEx or shared with others to reproduce a benchmark.
+//
+// Copyright (C) 2017, Bryan J. Muscedere
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <boost/program_options.hpp>
+#include "SyntheticCorpus.h"
+
+using namespace std;
+namespace po = boost::program_options;
+
+/**
+ * Main method that generates the corpus.
+ * Usage: CorpusGenerator [options] outputDir
+ * @param argc The number of arguments.
+ * @param argv The arguments.
+ * @return Return code.
+ */
+int main(int argc, const char** argv){
+    SyntheticCorpus::Settings settings;
+    string outputDir;
+
+    po::options_description desc("Options");
+    desc.add_options()("help,h", "Print this help message.");
+    SyntheticCorpus::addOptions(desc, settings);
+    desc.add_options()("output", po::value<string>(&outputDir), "The directory to write the corpus to.");
+    po::positional_options_description positional;
+    positional.add("output", 1);
+
+    po::variables_map vm;
+    try {
+        po::store(po::command_line_parser(argc, argv).options(desc).positional(positional).run(), vm);
+        po::notify(vm);
+        if (vm.count("help")){
+            cout << "Usage: CorpusGenerator [options] outputDir" << endl << desc;
+            return 0;
+        }
+        if (outputDir.empty()) throw po::error("You must specify an output directory!");
+    } catch (po::error& e){
+        cerr << "Error: " << e.what() << endl << desc;
+        return 1;
+    }
+
+    SyntheticCorpus corpus(settings);
+    if (!corpus.generate(outputDir)){
+        cerr << "Error writing the corpus to " << outputDir << "!" << endl;
+        return 1;
+    }
+
+    cout << "Generated " << corpus.describe() << " in " << outputDir << "." << endl;
+    return 0;
+}
@@ -0,0 +1,273 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ExtractBenchmark.cpp
+//
+// Created By: Bryan J Muscedere
+// Date: 19/10/26.
+//
+// Times ClangEx end to end. Generates a synthetic corpus, then extracts it
+// in blob, partial and low memory mode, recording the wall time, peak
+// memory and output size of each run.
+//
+// Copyright (C) 2017, Bryan J. Muscedere
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <csignal>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include <boost/algorithm/string.hpp>
+#include "SyntheticCorpus.h"
+
+using namespace std;
+using namespace std::chrono;
+namespace bs = boost::filesystem;
+namespace po = boost::program_options;
+
+/** A Single Extraction */
+struct RunResult {
+    string mode;
+    int run = 0;
+    bool success = false;
+    double wallSeconds = 0;
+    size_t peakRSSBytes = 0;
+    size_t outputBytes = 0;
+};
+
+/** Output Names */
+const static string OUTPUT_NAME = "out";
+const static string LOG_NAME = "clangex.log";
+
+/**
+ * Gets the ClangEx commands that extract the corpus in a mode.
+ * @param mode The mode: blob, partial or low.
+ * @param database The corpus' compilation database.
+ * @param jobs The number of workers low memory mode runs.
+ * @return The commands, or an empty string if the mode is unknown.
+ */
+string getCommands(string mode, bs::path database, int jobs){
+    string generate;
+    if (mode == "blob") generate = "generate -b";
+    else if (mode == "partial") generate = "generate";
+    else if (mode == "low") generate = "generate -l -j " + to_string(jobs);
+    else return string();
+
+    return "add -c " + database.string() + "\n" + generate + "\noutput " + OUTPUT_NAME + " --stats\nquit!\n";
+}
+
+/**
+ * Runs ClangEx in its own directory, feeding it commands on standard input.
+ * Its output goes to a log beside the model.
+ * @param clangEx The ClangEx executable.
+ * @param runDir The directory ClangEx runs in.
+ * @param commands The commands to run.
+ * @param result Where the wall time, peak memory and output size are stored.
+ */
+void runClangEx(bs::path clangEx, bs::path runDir, string commands, RunResult& result){
+    int input[2];
+    if (pipe(input) != 0) return;
+
+    steady_clock::time_point start = steady_clock::now();
+    pid_t pid = fork();
+    if (pid < 0){
+        close(input[0]);
+        close(input[1]);
+        return;
+    }
+
+    //Starts ClangEx.
+    if (pid == 0){
+        int log = open((runDir / LOG_NAME).c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (chdir(runDir.c_str()) != 0 || log < 0) _exit(127);
+
+        dup2(input[0], STDIN_FILENO);
+        dup2(log, STDOUT_FILENO);
+        dup2(log, STDERR_FILENO);
+        close(input[0]);
+        close(input[1]);
+        close(log);
+        execl(clangEx.c_str(), clangEx.c_str(), (char*) nullptr);
+        _exit(127);
+    }
+
+    //Feeds it the commands and waits.
+    close(input[0]);
+    size_t written = 0;
+    while (written < commands.size()){
+        ssize_t cur = write(input[1], commands.data() + written, commands.size() - written);
+        if (cur <= 0) break;
+        written += cur;
+    }
+    close(input[1]);
+
+    int status;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) != pid) return;
+    result.wallSeconds = duration_cast<duration<double>>(steady_clock::now() - start).count();
+
+    //Linux reports kilobytes.
+    result.peakRSSBytes = (size_t) usage.ru_maxrss * 1024;
+
+    boost::system::error_code error;
+    bs::path model = runDir / (OUTPUT_NAME + ".ta");
+    result.outputBytes = bs::file_size(model, error);
+    result.success = WIFEXITED(status) && WEXITSTATUS(status) == 0 && !error;
+}
+
+/**
+ * Writes the results as JSON.
+ * @param fileName The file to write.
+ * @param corpus A description of the corpus.
+ * @param results The results of each run.
+ * @return Whether the file was written.
+ */
+bool writeResults(string fileName, string corpus, const vector<RunResult>& results){
+    ofstream output(fileName);
+    if (!output.is_open()) return false;
+
+    output << "{\n  \"corpus\": \"" << corpus << "\",\n  \"runs\": [\n";
+    for (int i = 0; i < results.size(); i++){
+        const RunResult& cur = results.at(i);
+        output << "    {\"mode\": \"" << cur.mode << "\", \"run\": " << cur.run << ", \"success\": "
+               << ((cur.success) ? "true" : "false") << ", \"wallSeconds\": " << cur.wallSeconds
+               << ", \"peakRSSBytes\": " << cur.peakRSSBytes << ", \"outputBytes\": " << cur.outputBytes << "}"
+               << ((i < results.size() - 1) ? "," : "") << "\n";
+    }
+    output << "  ]\n}\n";
+    output.close();
+
+    return !output.fail();
+}
+
+/**
+ * Main method that drives the benchmark.
+ * Usage: ExtractBenchmark [options]
+ * @param argc The number of arguments.
+ * @param argv The arguments.
+ * @return Return code.
+ */
+int main(int argc, const char** argv){
+    SyntheticCorpus::Settings settings;
+    string clangEx = "./ClangEx";
+    string workDir;
+    string modeList = "blob,partial,low";
+    int jobs = 1;
+    int repeat = 1;
+
+    po::options_description desc("Options");
+    desc.add_options()
+            ("help,h", "Print this help message.")
+            ("clangex", po::value<string>(&clangEx)->default_value(clangEx), "The ClangEx executable to time.")
+            ("work", po::value<string>(&workDir), "Directory for the corpus and runs. Defaults to a new temporary "
+                    "directory.")
+            ("modes", po::value<string>(&modeList)->default_value(modeList), "Modes to run, from blob, partial "
+                    "and low.")
+            ("jobs,j", po::value<int>(&jobs)->default_value(jobs), "Number of workers low memory mode runs.")
+            ("repeat,r", po::value<int>(&repeat)->default_value(repeat), "Number of times each mode is run.");
+    SyntheticCorpus::addOptions(desc, settings);
+
+    po::variables_map vm;
+    try {
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+        if (vm.count("help")){
+            cout << "Usage: ExtractBenchmark [options]" << endl << desc;
+            return 0;
+        }
+        if (jobs < 1 || repeat < 1) throw po::error("The --jobs and --repeat arguments must be at least 1.");
+    } catch (po::error& e){
+        cerr << "Error: " << e.what() << endl << desc;
+        return 1;
+    }
+
+    //ClangEx splits commands on spaces, so the paths it's given can't have any.
+    bs::path work = (workDir.empty()) ? bs::temp_directory_path() / bs::unique_path("clangex-bench-%%%%-%%%%")
+                                      : bs::path(workDir);
+    work = bs::absolute(work);
+    if (work.string().find(' ') != string::npos){
+        cerr << "Error: The work directory " << work << " can't contain spaces." << endl;
+        return 1;
+    }
+    bs::path clangExPath = bs::absolute(clangEx);
+    if (!bs::exists(clangExPath)){
+        cerr << "Error: ClangEx was not found at " << clangExPath << "." << endl;
+        return 1;
+    }
+
+    //Checks the modes.
+    vector<string> modes;
+    boost::split(modes, modeList, boost::is_any_of(","));
+    for (string mode : modes){
+        if (getCommands(mode, bs::path(), jobs).empty()){
+            cerr << "Error: " << mode << " is not a mode. Use blob, partial or low." << endl;
+            return 1;
+        }
+    }
+
+    //Generates the corpus.
+    SyntheticCorpus corpus(settings);
+    bs::path corpusDir = work / "corpus";
+    if (!corpus.generate(corpusDir)){
+        cerr << "Error writing the corpus to " << corpusDir << "!" << endl;
+        return 1;
+    }
+    cout << "Corpus: " << corpus.describe() << endl << "Work directory: " << work.string() << endl << endl;
+
+    //Runs each mode.
+    signal(SIGPIPE, SIG_IGN);
+    vector<RunResult> results;
+    bool allPassed = true;
+
+    cout << fixed << setprecision(2) << left << setw(10) << "Mode" << right << setw(6) << "Run" << setw(12)
+         << "Wall (s)" << setw(14) << "Peak RSS (MB)" << setw(14) << "Output (MB)" << endl;
+    for (string mode : modes){
+        string commands = getCommands(mode, corpusDir / "compile_commands.json", jobs);
+
+        for (int r = 0; r < repeat; r++){
+            RunResult result;
+            result.mode = mode;
+            result.run = r;
+
+            bs::path runDir = work / (mode + "-" + to_string(r));
+            bs::remove_all(runDir);
+            bs::create_directories(runDir);
+            runClangEx(clangExPath, runDir, commands, result);
+            results.push_back(result);
+
+            cout << left << setw(10) << mode << right << setw(6) << r << setw(12) << result.wallSeconds << setw(14)
+                 << result.peakRSSBytes / (1024.0 * 1024.0) << setw(14) << result.outputBytes / (1024.0 * 1024.0);
+            if (!result.success) cout << "  FAILED (see " << (runDir / LOG_NAME).string() << ")";
+            cout << endl;
+            allPassed = allPassed && result.success;
+        }
+    }
+
+    //Saves the results. Each run's phase timings are in its own directory.
+    string resultsFile = (work / "results.json").string();
+    if (!writeResults(resultsFile, corpus.describe(), results)){
+        cerr << "Error writing to " << resultsFile << "!" << endl;
+        return 1;
+    }
+    cout << endl << "Results written to " << resultsFile << "." << endl;
+
+    return (allPassed) ? 0 : 1;
+}
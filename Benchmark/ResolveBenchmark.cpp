@@ -0,0 +1,116 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ResolveBenchmark.cpp
+//
+// Created By: Bryan J Muscedere
+// Date: 19/10/26.
+//
+// Times reference resolution in low memory mode. Builds a graph where most
+// relations point to entities that do not exist, each carrying attributes
+// that must be removed along with it.
+//
+// Copyright (C) 2017, Bryan J. Muscedere
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <boost/filesystem.hpp>
+#include "../Graph/LowMemoryTAGraph.h"
+
+using namespace std;
+using namespace std::chrono;
+namespace bs = boost::filesystem;
+
+/** Default Sizes */
+const static int DEFAULT_REMOVED = 1000000;
+const static int NUM_ENTITIES = 100000;
+const static int NUM_RESOLVED = 200000;
+const static size_t DEFAULT_BUDGET = (size_t) 256 * 1024 * 1024;
+
+/**
+ * Gets the number of seconds between two time points.
+ * @param start The start time.
+ * @param end The end time.
+ * @return The elapsed seconds.
+ */
+double getSeconds(steady_clock::time_point start, steady_clock::time_point end){
+    return duration_cast<duration<double>>(end - start).count();
+}
+
+/**
+ * Main method that drives the benchmark.
+ * Usage: ResolveBenchmark [removedRelations] [memBudgetBytes]
+ * @param argc The number of arguments.
+ * @param argv The arguments.
+ * @return Return code.
+ */
+int main(int argc, const char** argv){
+    int numRemoved = (argc > 1) ? stoi(argv[1]) : DEFAULT_REMOVED;
+    size_t budget = (argc > 2) ? stoull(argv[2]) : DEFAULT_BUDGET;
+
+    //Creates a place for the log.
+    bs::path workDir = bs::temp_directory_path() / bs::unique_path("clangex-bench-%%%%-%%%%");
+    bs::create_directories(workDir);
+
+    steady_clock::time_point start = steady_clock::now();
+    LowMemoryTAGraph* graph = new LowMemoryTAGraph(workDir.string());
+    graph->setMemBudget(budget);
+
+    //Adds the entities.
+    for (int i = 0; i < NUM_ENTITIES; i++){
+        string ID = "entity" + to_string(i);
+        ClangNode* node = new ClangNode(ID, ID, ClangNode::FUNCTION);
+        node->addAttribute(TAGraph::FILE_ATTRIBUTE, "file" + to_string(i % 100) + ".cpp");
+        graph->addNode(node);
+    }
+
+    //Adds relations that resolve and relations that do not.
+    for (int i = 0; i < NUM_RESOLVED; i++){
+        string dst = "entity" + to_string((i + 1 + i / NUM_ENTITIES) % NUM_ENTITIES);
+        ClangEdge* edge = new ClangEdge("entity" + to_string(i % NUM_ENTITIES), dst, ClangEdge::REFERENCES);
+        edge->addAttribute(ClangEdge::ACCESS_ATTRIBUTE.attrName, ClangEdge::ACCESS_ATTRIBUTE.READ_FLAG);
+        graph->addEdge(edge);
+    }
+    for (int i = 0; i < numRemoved; i++){
+        ClangEdge* edge = new ClangEdge("entity" + to_string(i % NUM_ENTITIES), "external" + to_string(i),
+                                        ClangEdge::REFERENCES);
+        edge->addAttribute(ClangEdge::ACCESS_ATTRIBUTE.attrName, ClangEdge::ACCESS_ATTRIBUTE.WRITE_FLAG);
+        graph->addEdge(edge);
+    }
+    graph->purgeCurrentGraph();
+    steady_clock::time_point spilled = steady_clock::now();
+
+    //Resolves the references.
+    Printer* print = new Printer();
+    bool succ = graph->resolveExternalReferences(print, false);
+    steady_clock::time_point resolved = steady_clock::now();
+    if (!succ){
+        delete graph;
+        delete print;
+        bs::remove_all(workDir);
+        return 1;
+    }
+
+    cout << "Entities: " << NUM_ENTITIES << ", resolved relations: " << NUM_RESOLVED << ", removed relations: "
+         << numRemoved << endl;
+    cout << "Spill time: " << getSeconds(start, spilled) << "s" << endl;
+    cout << "Resolve time: " << getSeconds(spilled, resolved) << "s" << endl;
+
+    delete graph;
+    delete print;
+    bs::remove_all(workDir);
+    return 0;
+}
@@ -0,0 +1,339 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// SyntheticCorpus.cpp
+//
+// Created By: Bryan J Muscedere
+// Date: 19/10/26.
+//
+// Generates synthetic C/C++ projects to benchmark ClangEx on. The same
+// settings and seed always give the same project, so timings can be
+// compared between builds and machines.
+//
+// Copyright (C) 2017, Bryan J. Muscedere
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include "SyntheticCorpus.h"
+
+using namespace std;
+namespace bs = boost::filesystem;
+namespace po = boost::program_options;
+
+/**
+ * Constructor. Sets up a corpus. Negative settings are treated as zero.
+ * @param settings The shape of the corpus.
+ */
+SyntheticCorpus::SyntheticCorpus(Settings settings){
+    settings.numFiles = max(1, settings.numFiles);
+    settings.functionsPerFile = max(1, settings.functionsPerFile);
+    settings.fanOut = max(0, settings.fanOut);
+    settings.hierarchyDepth = max(0, settings.hierarchyDepth);
+    settings.sharedHeaders = max(0, settings.sharedHeaders);
+    settings.headersPerFile = min(max(0, settings.headersPerFile), settings.sharedHeaders);
+
+    this->settings = settings;
+    rng.seed(settings.seed);
+}
+
+/**
+ * Adds the options that shape a corpus.
+ * @param desc The options to add to.
+ * @param settings The settings the options are stored in.
+ */
+void SyntheticCorpus::addOptions(po::options_description& desc, SyntheticCorpus::Settings& settings){
+    desc.add_options()
+            ("files", po::value<int>(&settings.numFiles)->default_value(settings.numFiles),
+                    "Number of source files.")
+            ("functions", po::value<int>(&settings.functionsPerFile)->default_value(settings.functionsPerFile),
+                    "Functions per source file.")
+            ("fan-out", po::value<int>(&settings.fanOut)->default_value(settings.fanOut),
+                    "Calls made by each function and other files each file depends on.")
+            ("depth", po::value<int>(&settings.hierarchyDepth)->default_value(settings.hierarchyDepth),
+                    "Depth of each file's class hierarchy.")
+            ("shared-headers", po::value<int>(&settings.sharedHeaders)->default_value(settings.sharedHeaders),
+                    "Number of headers shared between files.")
+            ("headers-per-file", po::value<int>(&settings.headersPerFile)->default_value(settings.headersPerFile),
+                    "Shared headers each file includes.")
+            ("seed", po::value<unsigned int>(&settings.seed)->default_value(settings.seed),
+                    "Seed for the corpus. The same seed always gives the same corpus.");
+}
+
+/**
+ * Writes the corpus. Shared headers go in include/, each unit gets a header
+ * and a source file in src/ and a compile_commands.json is written at the root.
+ * @param root The directory to write to.
+ * @return Whether every file was written.
+ */
+bool SyntheticCorpus::generate(bs::path root){
+    rng.seed(settings.seed);
+
+    boost::system::error_code error;
+    bs::create_directories(root / "include", error);
+    bs::create_directories(root / "src", error);
+    if (error) return false;
+
+    bool succ = true;
+    for (int h = 0; h < settings.sharedHeaders; h++) succ = succ && writeSharedHeader(root, h);
+
+    //Units are picked in order so the same seed always gives the same corpus.
+    for (int u = 0; u < settings.numFiles && succ; u++){
+        vector<int> headers = pickDistinct(settings.headersPerFile, settings.sharedHeaders);
+        vector<int> dependencies = pickDistinct(min(settings.fanOut, settings.numFiles - 1), settings.numFiles, u);
+
+        succ = writeUnitHeader(root, u, headers) && writeUnitSource(root, u, headers, dependencies);
+    }
+
+    return succ && writeCompilationDatabase(root);
+}
+
+/**
+ * Describes the shape of the corpus.
+ * @return A description of the settings.
+ */
+string SyntheticCorpus::describe(){
+    stringstream desc;
+    desc << settings.numFiles << " files, " << settings.functionsPerFile << " functions per file, fan-out "
+         << settings.fanOut << ", hierarchy depth " << settings.hierarchyDepth << ", " << settings.sharedHeaders
+         << " shared headers (" << settings.headersPerFile << " per file), seed " << settings.seed;
+
+    return desc.str();
+}
+
+/**
+ * Writes a header shared between units. Each one declares a struct, an enum,
+ * a union, a base class and an inline helper.
+ * @param root The root of the corpus.
+ * @param header The number of the header.
+ * @return Whether the header was written.
+ */
+bool SyntheticCorpus::writeSharedHeader(bs::path root, int header){
+    string name = "shared" + to_string(header);
+    string guard = "SHARED" + to_string(header) + "_H";
+    ofstream file((root / "include" / (name + ".h")).string());
+    if (!file.is_open()) return false;
+
+    file << "#ifndef " << guard << "\n#define " << guard << "\n\n"
+         << "struct " << name << "_record {\n    int count;\n    double weight;\n};\n\n"
+         << "enum " << name << "_kind {";
+    for (int i = 0; i < NUM_ENUM_VALUES; i++){
+        file << ((i > 0) ? ", " : "") << "SHARED" << header << "_KIND_" << i;
+    }
+    file << "};\n\n"
+         << "union " << name << "_value {\n    int asInt;\n    float asFloat;\n};\n\n"
+         << "class Shared" << header << "Base {\npublic:\n"
+         << "    virtual ~Shared" << header << "Base() {}\n"
+         << "    virtual int apply(int value) const { return value + state; }\n\n"
+         << "protected:\n    int state = " << header << ";\n};\n\n"
+         << "inline int " << name << "_helper(int value) {\n    return value * " << header + 2 << " + 1;\n}\n\n"
+         << "#endif\n";
+    file.close();
+
+    return !file.fail();
+}
+
+/**
+ * Writes a unit's header. It declares the unit's functions and a chain of
+ * classes that builds on the base class of the unit's first shared header.
+ * @param root The root of the corpus.
+ * @param unit The number of the unit.
+ * @param headers The shared headers the unit includes.
+ * @return Whether the header was written.
+ */
+bool SyntheticCorpus::writeUnitHeader(bs::path root, int unit, const vector<int>& headers){
+    string guard = "UNIT" + to_string(unit) + "_H";
+    ofstream file((root / "src" / (getUnitName(unit) + ".h")).string());
+    if (!file.is_open()) return false;
+
+    file << "#ifndef " << guard << "\n#define " << guard << "\n\n";
+    for (int header : headers) file << "#include \"shared" << header << ".h\"\n";
+    file << "\nextern int unit" << unit << "_counter;\n\n";
+    for (int f = 0; f < settings.functionsPerFile; f++) file << "int " << getFunctionName(unit, f) << "(int value);\n";
+
+    //Builds the class hierarchy.
+    for (int level = 0; level < settings.hierarchyDepth; level++){
+        string base;
+        if (level > 0) base = getClassName(unit, level - 1);
+        else if (headers.size() > 0) base = "Shared" + to_string(headers.at(0)) + "Base";
+
+        file << "\nclass " << getClassName(unit, level) << ((base.empty()) ? "" : " : public " + base) << " {\n"
+             << "public:\n    " << ((base.empty()) ? "virtual " : "") << "int apply(int value) const"
+             << ((base.empty()) ? "" : " override") << ";\n\n"
+             << "protected:\n    int level" << level << " = " << level << ";\n};\n";
+    }
+    file << "\n#endif\n";
+    file.close();
+
+    return !file.fail();
+}
+
+/**
+ * Writes a unit's source. Each function touches the unit's shared types and
+ * calls functions in its own unit and the units it depends on.
+ * @param root The root of the corpus.
+ * @param unit The number of the unit.
+ * @param headers The shared headers the unit includes.
+ * @param dependencies The units whose functions this unit calls.
+ * @return Whether the source was written.
+ */
+bool SyntheticCorpus::writeUnitSource(bs::path root, int unit, const vector<int>& headers,
+                                      const vector<int>& dependencies){
+    ofstream file((root / "src" / (getUnitName(unit) + ".cpp")).string());
+    if (!file.is_open()) return false;
+
+    file << "#include \"" << getUnitName(unit) << ".h\"\n";
+    for (int dep : dependencies) file << "#include \"" << getUnitName(dep) << ".h\"\n";
+    file << "\nint unit" << unit << "_counter = 0;\n";
+
+    string shared = (headers.size() > 0) ? "shared" + to_string(headers.at(0)) : "";
+    if (!shared.empty()) file << "static " << shared << "_record unit" << unit << "_record = {1, 0.5};\n";
+
+    //Defines the class methods.
+    for (int level = 0; level < settings.hierarchyDepth; level++){
+        string base;
+        if (level > 0) base = getClassName(unit, level - 1);
+        else if (!shared.empty()) base = "Shared" + to_string(headers.at(0)) + "Base";
+
+        file << "\nint " << getClassName(unit, level) << "::apply(int value) const {\n    return "
+             << ((base.empty()) ? "value" : base + "::apply(value)") << " + level" << level << ";\n}\n";
+    }
+
+    //Defines the functions.
+    vector<int> callees(dependencies);
+    callees.push_back(unit);
+    for (int f = 0; f < settings.functionsPerFile; f++){
+        file << "\nint " << getFunctionName(unit, f) << "(int value) {\n"
+             << "    int total = value + unit" << unit << "_counter;\n";
+
+        if (!shared.empty()){
+            int kind = pick(NUM_ENUM_VALUES);
+            file << "    " << shared << "_value cell;\n    cell.asInt = total;\n"
+                 << "    " << shared << "_kind kind = SHARED" << headers.at(0) << "_KIND_" << kind << ";\n"
+                 << "    unit" << unit << "_record.count += cell.asInt;\n"
+                 << "    if (kind == SHARED" << headers.at(0) << "_KIND_0) total += " << shared << "_helper(total);\n";
+        }
+        for (int c = 0; c < settings.fanOut; c++){
+            int callee = callees.at(pick((int) callees.size()));
+            file << "    total += " << getFunctionName(callee, pick(settings.functionsPerFile)) << "(total);\n";
+        }
+        if (settings.hierarchyDepth > 0 && f % 4 == 0){
+            file << "    " << getClassName(unit, settings.hierarchyDepth - 1) << " object;\n"
+                 << "    total += object.apply(total);\n";
+        }
+
+        file << "    unit" << unit << "_counter++;\n    return total;\n}\n";
+    }
+    file.close();
+
+    return !file.fail();
+}
+
+/**
+ * Writes a compilation database for every unit.
+ * @param root The root of the corpus.
+ * @return Whether the database was written.
+ */
+bool SyntheticCorpus::writeCompilationDatabase(bs::path root){
+    string dir = escapeJSON(bs::absolute(root).string());
+    ofstream file((root / "compile_commands.json").string());
+    if (!file.is_open()) return false;
+
+    file << "[\n";
+    for (int u = 0; u < settings.numFiles; u++){
+        string source = "src/" + getUnitName(u) + ".cpp";
+        file << "  {\n    \"directory\": \"" << dir << "\",\n"
+             << "    \"command\": \"c++ -std=c++11 -Iinclude -Isrc -c " << source << "\",\n"
+             << "    \"file\": \"" << dir << "/" << source << "\"\n  }" << ((u < settings.numFiles - 1) ? "," : "")
+             << "\n";
+    }
+    file << "]\n";
+    file.close();
+
+    return !file.fail();
+}
+
+/**
+ * Picks a number. The generator's raw output is used so every standard
+ * library picks the same numbers.
+ * @param bound The number of choices.
+ * @return A number from 0 to bound - 1.
+ */
+int SyntheticCorpus::pick(int bound){
+    return (int) (rng() % (unsigned int) bound);
+}
+
+/**
+ * Picks distinct numbers.
+ * @param count How many to pick. Capped by the number of choices.
+ * @param bound The number of choices.
+ * @param exclude A number that can't be picked, or -1.
+ * @return The numbers in the order they were picked.
+ */
+vector<int> SyntheticCorpus::pickDistinct(int count, int bound, int exclude){
+    vector<int> choices;
+    for (int i = 0; i < bound; i++) if (i != exclude) choices.push_back(i);
+
+    //Partial shuffle.
+    count = min(count, (int) choices.size());
+    for (int i = 0; i < count; i++) swap(choices.at(i), choices.at(i + pick((int) choices.size() - i)));
+    choices.resize(count);
+
+    return choices;
+}
+
+/**
+ * Gets the file name of a unit.
+ * @param unit The number of the unit.
+ * @return The name, without an extension.
+ */
+string SyntheticCorpus::getUnitName(int unit){
+    return "unit" + to_string(unit);
+}
+
+/**
+ * Gets the name of a function.
+ * @param unit The unit the function is in.
+ * @param function The number of the function.
+ * @return The name of the function.
+ */
+string SyntheticCorpus::getFunctionName(int unit, int function){
+    return "unit" + to_string(unit) + "_fn" + to_string(function);
+}
+
+/**
+ * Gets the name of a class in a unit's hierarchy.
+ * @param unit The unit the class is in.
+ * @param level How deep the class is in the hierarchy.
+ * @return The name of the class.
+ */
+string SyntheticCorpus::getClassName(int unit, int level){
+    return "Unit" + to_string(unit) + "Level" + to_string(level);
+}
+
+/**
+ * Escapes a string for JSON.
+ * @param value The string.
+ * @return The escaped string.
+ */
+string SyntheticCorpus::escapeJSON(const string& value){
+    string escaped;
+    for (char cur : value){
+        if (cur == '"' || cur == '\\') escaped += '\\';
+        escaped += cur;
+    }
+
+    return escaped;
+}
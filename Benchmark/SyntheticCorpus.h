@@ -0,0 +1,84 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// SyntheticCorpus.h
+//
+// Created By: Bryan J Muscedere
+// Date: 19/10/26.
+//
+// Generates synthetic C/C++ projects to benchmark ClangEx on. The same
+// settings and seed always give the same project, so timings can be
+// compared between builds and machines.
+//
+// Copyright (C) 2017, Bryan J. Muscedere
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CLANGEX_SYNTHETICCORPUS_H
+#define CLANGEX_SYNTHETICCORPUS_H
+
+#include <string>
+#include <vector>
+#include <random>
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+class SyntheticCorpus {
+public:
+    /** Corpus Settings */
+    struct Settings {
+        int numFiles = 100;
+        int functionsPerFile = 20;
+        int fanOut = 4;
+        int hierarchyDepth = 3;
+        int sharedHeaders = 8;
+        int headersPerFile = 3;
+        unsigned int seed = 1;
+    };
+
+    /** Constructor */
+    SyntheticCorpus(Settings settings);
+
+    /** Command Line Options */
+    static void addOptions(boost::program_options::options_description& desc, Settings& settings);
+
+    /** Generation */
+    bool generate(boost::filesystem::path root);
+    std::string describe();
+
+private:
+    /** Private Constants */
+    const int NUM_ENUM_VALUES = 4;
+
+    /** Private Variables */
+    Settings settings;
+    std::mt19937 rng;
+
+    /** File Writers */
+    bool writeSharedHeader(boost::filesystem::path root, int header);
+    bool writeUnitHeader(boost::filesystem::path root, int unit, const std::vector<int>& headers);
+    bool writeUnitSource(boost::filesystem::path root, int unit, const std::vector<int>& headers,
+                         const std::vector<int>& dependencies);
+    bool writeCompilationDatabase(boost::filesystem::path root);
+
+    /** Helper Methods */
+    int pick(int bound);
+    std::vector<int> pickDistinct(int count, int bound, int exclude = -1);
+    static std::string getUnitName(int unit);
+    static std::string getFunctionName(int unit, int function);
+    static std::string getClassName(int unit, int level);
+    static std::string escapeJSON(const std::string& value);
+};
+
+
+#endif //CLANGEX_SYNTHETICCORPUS_H
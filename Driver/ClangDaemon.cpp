@@ -0,0 +1,365 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ClangDaemon.cpp
+//
+// Created By: Bryan J Muscedere
+// Date: 19/10/26.
+//
+// Runs ClangEx as a long-lived daemon on a Unix socket. Clients send
+// commands in the same form as the interactive prompt, one per line, and
+// get back whatever the commands print. The daemon keeps its driver between
+// clients so repeated runs skip start up costs.
+//
+// Copyright (C) 2017, Bryan J. Muscedere
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <sstream>
+#include <cstring>
+#include <csignal>
+#include <cerrno>
+#include <climits>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <boost/algorithm/string/predicate.hpp>
+#include "ClangDaemon.h"
+
+using namespace std;
+
+/**
+ * Constructor. Sets up a daemon on a socket.
+ * @param socketPath The path of the Unix socket.
+ */
+ClangDaemon::ClangDaemon(string socketPath){
+    //The daemon moves into each client's directory, so the socket can't be relative.
+    this->socketPath = getAbsolutePath(socketPath);
+}
+
+/**
+ * Destructor. Stops the daemon if it's still listening.
+ */
+ClangDaemon::~ClangDaemon(){
+    stop();
+}
+
+/**
+ * Starts listening on the socket. A stale socket from a daemon that died is
+ * replaced, but a live one is left alone.
+ * @return Whether the daemon is listening.
+ */
+bool ClangDaemon::start(){
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(addr.sun_path)){
+        cerr << "Error: The socket path " << socketPath << " is too long." << endl;
+        return false;
+    }
+    strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+
+    //Checks whether another daemon already owns the socket.
+    int probe = connectTo(socketPath);
+    if (probe >= 0){
+        close(probe);
+        cerr << "Error: A ClangEx daemon is already listening on " << socketPath << "." << endl;
+        return false;
+    }
+    unlink(socketPath.c_str());
+
+    //Only the current user can connect.
+    serverFD = socket(AF_UNIX, SOCK_STREAM, 0);
+    mode_t oldMask = umask(0077);
+    bool bound = serverFD >= 0 && ::bind(serverFD, (struct sockaddr*) &addr, sizeof(addr)) == 0;
+    umask(oldMask);
+    if (!bound || listen(serverFD, SOMAXCONN) != 0){
+        cerr << "Error: Could not listen on " << socketPath << ": " << strerror(errno) << endl;
+        if (serverFD >= 0) close(serverFD);
+        serverFD = -1;
+        return false;
+    }
+
+    //Clients that hang up shouldn't take the daemon down with them.
+    signal(SIGPIPE, SIG_IGN);
+    return true;
+}
+
+/**
+ * Serves clients one at a time until a command asks to quit.
+ * @param handler Runs a command. Returns false when the daemon should quit.
+ */
+void ClangDaemon::serve(function<bool(string)> handler){
+    bool running = true;
+    while (running && serverFD >= 0){
+        int client = accept(serverFD, nullptr, nullptr);
+        if (client < 0){
+            if (errno == EINTR) continue;
+            cerr << "Error: The daemon could not accept a client: " << strerror(errno) << endl;
+            break;
+        }
+
+        running = handleClient(client, handler);
+        close(client);
+    }
+
+    stop();
+}
+
+/**
+ * Resolves a path against the current working directory.
+ * @param path The path.
+ * @return The absolute path.
+ */
+string ClangDaemon::getAbsolutePath(string path){
+    if (path.size() > 0 && path[0] == '/') return path;
+
+    char workingDir[PATH_MAX];
+    if (!getcwd(workingDir, sizeof(workingDir))) return path;
+    return string(workingDir) + "/" + path;
+}
+
+/**
+ * Stops listening and removes the socket.
+ */
+void ClangDaemon::stop(){
+    if (serverFD < 0) return;
+
+    close(serverFD);
+    unlink(socketPath.c_str());
+    serverFD = -1;
+}
+
+/**
+ * Sends commands to a running daemon and prints what it sends back.
+ * @param socketPath The path of the Unix socket.
+ * @param commands The commands to run.
+ * @return The exit code. Non-zero if the daemon couldn't be reached or reported an error.
+ */
+int ClangDaemon::sendCommands(string socketPath, vector<string> commands){
+    socketPath = getAbsolutePath(socketPath);
+    int fd = connectTo(socketPath);
+    if (fd < 0){
+        cerr << "Error: No ClangEx daemon is listening on " << socketPath << "." << endl;
+        return 1;
+    }
+
+    //Sends the working directory, then the commands, and signals that there are no more.
+    char workingDir[PATH_MAX];
+    string request = (getcwd(workingDir, sizeof(workingDir))) ? string(workingDir) + "\n" : "\n";
+    for (string command : commands) request += command + "\n";
+    if (!writeAll(fd, request.data(), request.size())){
+        cerr << "Error: The commands could not be sent to the daemon." << endl;
+        close(fd);
+        return 1;
+    }
+    shutdown(fd, SHUT_WR);
+
+    //Relays the output to the right stream.
+    bool sawError = false;
+    char header[HEADER_SIZE];
+    string data;
+    while (readAll(fd, header, HEADER_SIZE)){
+        uint32_t size = 0;
+        for (int i = 1; i < HEADER_SIZE; i++) size = (size << 8) | (unsigned char) header[i];
+
+        data.resize(size);
+        if (size > 0 && !readAll(fd, &data[0], size)) break;
+        if (header[0] == ERR_CHANNEL){
+            cerr << data << flush;
+            sawError = true;
+        } else {
+            cout << data << flush;
+        }
+    }
+
+    close(fd);
+    return (sawError) ? 1 : 0;
+}
+
+/**
+ * Reads a client's commands and runs them. The first line of the request is
+ * the client's working directory. Anything printed while the commands run is
+ * sent back to the client as it's printed.
+ * @param client The client socket.
+ * @param handler Runs a command.
+ * @return Whether the daemon should keep running.
+ */
+bool ClangDaemon::handleClient(int client, function<bool(string)>& handler){
+    //The client closes its end once every command is sent.
+    string request;
+    char chunk[4096];
+    while (true){
+        ssize_t num = read(client, chunk, sizeof(chunk));
+        if (num < 0 && errno == EINTR) continue;
+        if (num <= 0) break;
+        request.append(chunk, (size_t) num);
+    }
+
+    //Redirects the output. Both channels share the socket, so they share its lock.
+    //Prompts can't be answered, so they read an empty input.
+    ClientConnection connection;
+    connection.fd = client;
+    SocketBuffer outBuffer(connection, OUT_CHANNEL);
+    SocketBuffer errBuffer(connection, ERR_CHANNEL);
+    istringstream noInput;
+    streambuf* oldOut = cout.rdbuf(&outBuffer);
+    streambuf* oldErr = cerr.rdbuf(&errBuffer);
+    streambuf* oldIn = cin.rdbuf(noInput.rdbuf());
+
+    //Paths in the commands are relative to the client. The daemon moves back once they're done.
+    char daemonDir[PATH_MAX];
+    bool haveDaemonDir = getcwd(daemonDir, sizeof(daemonDir)) != nullptr;
+    bool running = true;
+    istringstream lines(request);
+    string line;
+    getline(lines, line);
+    if (line.size() > 0 && chdir(line.c_str()) != 0){
+        cerr << "Error: The daemon could not change to " << line << ": " << strerror(errno) << endl;
+        lines.setstate(ios::eofbit);
+    }
+
+    //Runs each command.
+    while (running && getline(lines, line)){
+        if (line.size() > 0 && line.back() == '\r') line.pop_back();
+        if (line == "" || boost::starts_with(line, "//")) continue;
+
+        running = handler(line);
+    }
+
+    cout.flush();
+    cerr.flush();
+    cout.rdbuf(oldOut);
+    cerr.rdbuf(oldErr);
+    cin.rdbuf(oldIn);
+
+    if (haveDaemonDir && chdir(daemonDir) != 0){
+        cerr << "Error: The daemon could not change back to " << daemonDir << ": " << strerror(errno) << endl;
+    }
+    return running;
+}
+
+/**
+ * Connects to a Unix socket.
+ * @param socketPath The path of the socket.
+ * @return The connected socket or -1 if nothing is listening.
+ */
+int ClangDaemon::connectTo(string socketPath){
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(addr.sun_path)) return -1;
+    strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, (struct sockaddr*) &addr, sizeof(addr)) != 0){
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+/**
+ * Writes a block of data to a socket.
+ * @param fd The socket.
+ * @param data The data to write.
+ * @param size The number of bytes.
+ * @return Whether everything was written.
+ */
+bool ClangDaemon::writeAll(int fd, const char* data, size_t size){
+    while (size > 0){
+        ssize_t num = write(fd, data, size);
+        if (num < 0 && errno == EINTR) continue;
+        if (num <= 0) return false;
+
+        data += num;
+        size -= (size_t) num;
+    }
+
+    return true;
+}
+
+/**
+ * Reads a block of data from a socket.
+ * @param fd The socket.
+ * @param data Where to put the data.
+ * @param size The number of bytes.
+ * @return Whether everything was read.
+ */
+bool ClangDaemon::readAll(int fd, char* data, size_t size){
+    while (size > 0){
+        ssize_t num = read(fd, data, size);
+        if (num < 0 && errno == EINTR) continue;
+        if (num <= 0) return false;
+
+        data += num;
+        size -= (size_t) num;
+    }
+
+    return true;
+}
+
+/**
+ * Constructor. Sets up a buffer that sends output to a client. Nothing is
+ * held back, so workers printing from several threads can share it.
+ * @param client The client connection. Its lock is shared with the other channel.
+ * @param channel The channel the output is tagged with.
+ */
+ClangDaemon::SocketBuffer::SocketBuffer(ClientConnection& client, char channel) : client(client) {
+    this->channel = channel;
+}
+
+/**
+ * Sends a single character.
+ * @param c The character.
+ * @return The character, or EOF on failure.
+ */
+int ClangDaemon::SocketBuffer::overflow(int c){
+    if (c == traits_type::eof()) return traits_type::not_eof(c);
+
+    char value = (char) c;
+    sendFrame(&value, 1);
+    return c;
+}
+
+/**
+ * Sends a block of characters.
+ * @param data The characters.
+ * @param size The number of characters.
+ * @return The number of characters sent.
+ */
+streamsize ClangDaemon::SocketBuffer::xsputn(const char* data, streamsize size){
+    if (size > 0) sendFrame(data, (size_t) size);
+    return size;
+}
+
+/**
+ * Sends output as a single frame. If the client has gone away, the output is
+ * dropped so the command can still finish.
+ * @param data The output.
+ * @param size The number of bytes.
+ */
+void ClangDaemon::SocketBuffer::sendFrame(const char* data, size_t size){
+    lock_guard<mutex> lock(client.sendMutex);
+    if (client.failed) return;
+
+    //Each frame is the channel, a 4 byte length and the output.
+    char header[HEADER_SIZE];
+    header[0] = channel;
+    for (int i = 1; i < HEADER_SIZE; i++) header[i] = (char) ((size >> (8 * (HEADER_SIZE - 1 - i))) & 0xFF);
+    if (!writeAll(client.fd, header, HEADER_SIZE) || !writeAll(client.fd, data, size)) client.failed = true;
+}
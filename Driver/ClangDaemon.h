@@ -0,0 +1,93 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ClangDaemon.h
+//
+// Created By: Bryan J Muscedere
+// Date: 19/10/26.
+//
+// Runs ClangEx as a long-lived daemon on a Unix socket. Clients send
+// commands in the same form as the interactive prompt, one per line, and
+// get back whatever the commands print. The daemon keeps its driver between
+// clients so repeated runs skip start up costs.
+//
+// Copyright (C) 2017, Bryan J. Muscedere
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CLANGEX_CLANGDAEMON_H
+#define CLANGEX_CLANGDAEMON_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <streambuf>
+#include <mutex>
+
+class ClangDaemon {
+public:
+    /** Constructor/Destructor */
+    ClangDaemon(std::string socketPath);
+    ~ClangDaemon();
+
+    /** Server Operations */
+    bool start();
+    void serve(std::function<bool(std::string)> handler);
+    void stop();
+
+    /** Client Operations */
+    static int sendCommands(std::string socketPath, std::vector<std::string> commands);
+
+private:
+    /** Output Channels */
+    static const char OUT_CHANNEL = 'o';
+    static const char ERR_CHANNEL = 'e';
+    static const int HEADER_SIZE = 5;
+
+    /** Client Connection Shared By Its Output Channels */
+    struct ClientConnection {
+        int fd;
+        bool failed = false;
+        std::mutex sendMutex;
+    };
+
+    /** Stream Buffer For Client Output */
+    class SocketBuffer : public std::streambuf {
+    public:
+        SocketBuffer(ClientConnection& client, char channel);
+
+    protected:
+        int overflow(int c) override;
+        std::streamsize xsputn(const char* data, std::streamsize size) override;
+
+    private:
+        ClientConnection& client;
+        char channel;
+
+        void sendFrame(const char* data, size_t size);
+    };
+
+    /** Private Variables */
+    std::string socketPath;
+    int serverFD = -1;
+
+    /** Helper Methods */
+    bool handleClient(int client, std::function<bool(std::string)>& handler);
+    static int connectTo(std::string socketPath);
+    static std::string getAbsolutePath(std::string path);
+    static bool writeAll(int fd, const char* data, size_t size);
+    static bool readAll(int fd, char* data, size_t size);
+};
+
+
+#endif //CLANGEX_CLANGDAEMON_H
@@ -28,29 +28,42 @@
 #include <unordered_map>
 #include <boost/foreach.hpp>
 #include <fstream>
+#include <thread>
+#include <chrono>
+#include <set>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <cstring>
+#include <unistd.h>
 #include <llvm/Support/CommandLine.h>
 #include "clang/Tooling/Tooling.h"
+#include "clang/Tooling/JSONCompilationDatabase.h"
+#include "clang/Tooling/ArgumentsAdjusters.h"
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/split.hpp>
 #include <boost/algorithm/string.hpp>
 #include "clang/Frontend/FrontendAction.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/Basic/SourceManager.h"
 #include "../Graph/LowMemoryTAGraph.h"
 #include "../TupleAttribute/TAProcessor.h"
+#include "../TupleAttribute/TAMerger.h"
+#include "../TupleAttribute/TAFilter.h"
 #include "../Walker/ASTWalker.h"
 #include "../Walker/BlobWalker.h"
 #include "../Walker/PartialWalker.h"
 
 using namespace std;
 using namespace clang::tooling;
+using namespace std::chrono;
 
 /**
  * Constructor. Simply configures C/C++ extensions.
  */
 ClangDriver::ClangDriver() {
     //Sets the C, C++ extensions.
-    ext.push_back(C_FILE_EXT);
-    ext.push_back(CPLUS_FILE_EXT);
-    ext.push_back(CPLUSPLUS_FILE_EXT);
+    ext = SOURCE_EXT;
 }
 
 /**
@@ -67,6 +80,8 @@ void ClangDriver::cleanup(){
     for (TAGraph* graph : graphs) {
         delete graph;
     }
+    graphs.clear();
+    graphStats.clear();
 }
 
 /**
@@ -211,82 +226,118 @@ bool ClangDriver::disableFeature(string feature){
 bool ClangDriver::processAllFiles(bool blobMode, string mergeFile, bool lowMemory, int startNum){
     bool success = true;
 
-    int argc = 0;
-    char **argv = prepareArgs(&argc, 0, getNumFiles());
-    llvm::cl::OptionCategory* ClangExCategory = new llvm::cl::OptionCategory("ClangEx");
-    CommonOptionsParser* OptionsParser = new CommonOptionsParser(argc, (const char **) argv, *ClangExCategory);
+    //Tracks where the run spends its time.
+    unique_ptr<RunStats> stats(new RunStats());
+    runStats = stats.get();
+
+    CompilationDatabase* compilations = getCompilations();
 
     //Sets up the printer.
     Printer* clangPrint = new Printer();
 
-    //Gets whether whether we're dealing with a merge.
+    //Gets whether whether we're dealing with a merge. The initial model is held in memory.
+    bool merge = (mergeFile.compare("") != 0);
+    if (merge && lowMemory){
+        clangPrint->printErrorInitialLowMemory(mergeFile);
+        lowMemory = false;
+    }
+
+    //Creates the graph to extract into.
     TAGraph *mergeGraph = nullptr;
-    bool merge = false;
-    if (mergeFile.compare("") != 0) {
-        //We're dealing with a merge.
-        merge = true;
+    if (lowMemory){
+        LowMemoryTAGraph* lowGraph;
+        if (recoveryMode) lowGraph = new LowMemoryTAGraph(lowMemoryPath.string(), recoveryNum);
+        else if (lowMemoryPath.empty()) lowGraph = new LowMemoryTAGraph();
+        else lowGraph = new LowMemoryTAGraph(lowMemoryPath.string());
+        lowGraph->setMemBudget(memBudget);
+        mergeGraph = lowGraph;
+    } else {
+        mergeGraph = new TAGraph();
+    }
+
+    if (merge) {
         clangPrint->printMerge(mergeFile);
 
-        //Loads the file.
+        //Streams the file straight into the graph.
         TAProcessor processor = TAProcessor(INSTANCE_FLAG, clangPrint);
-        bool succ = processor.readTAFile(mergeFile);
+        bool succ = processor.readTAFile(mergeFile, mergeGraph);
 
         if (!succ) {
+            delete mergeGraph;
             delete clangPrint;
-            delete OptionsParser;
-            for (int i = 0; i < argc; i++) delete[] argv[i];
-            delete[] argv;
-            delete ClangExCategory;
-            return false;
-        }
-
-        //Gets the graph.
-        TAGraph *graph = processor.writeTAGraph();
-        if (graph == nullptr) {
-            delete clangPrint;
-            delete OptionsParser;
-            for (int i = 0; i < argc; i++) delete[] argv[i];
-            delete[] argv;
-            delete ClangExCategory;
+            runStats = nullptr;
             return false;
         }
-    } else if (lowMemory){
-        if (lowMemoryPath.empty()) mergeGraph = new LowMemoryTAGraph();
-        else mergeGraph = new LowMemoryTAGraph(lowMemoryPath.string());
-    } else {
-        mergeGraph = new TAGraph();
     }
 
     //Get the exclusions.
     TAGraph::ClangExclude exclude = toggle;
 
-    //Dump settings.
-    if (lowMemory) dynamic_cast<LowMemoryTAGraph*>(mergeGraph)->dumpSettings(files, exclude, blobMode);
+    //Dump settings. Recovered workers stay in the run they came from.
+    if (lowMemory) {
+        dynamic_cast<LowMemoryTAGraph*>(mergeGraph)->dumpSettings(files, exclude, blobMode,
+                                                                   (recoveryMode) ? recoveryGroup : -1);
+    }
+
+    //Low memory mode walks files one at a time, so it can time them for later runs.
+    UnitHistory history(((lowMemoryPath.empty()) ? path(".") : lowMemoryPath).string() + "/" + HISTORY_FILE);
+    if (lowMemory) history.load();
 
     //Creates the command line arguments.
     int fileSplit = (lowMemory) ? FILE_SPLIT : getNumFiles();
     clangPrint->printProcessStatus(Printer::COMPILING);
-    for (int i = startNum; i < getNumFiles(); i += fileSplit) {
-        runAnalysis(blobMode, lowMemory, mergeGraph, i, clangPrint, exclude, OptionsParser);
-        if (lowMemory) dynamic_cast<LowMemoryTAGraph*>(mergeGraph)->purgeCurrentGraph();
+    if (lowMemory && numWorkers > 1 && !recoveryMode) {
+        runParallelAnalysis(blobMode, dynamic_cast<LowMemoryTAGraph*>(mergeGraph), exclude, compilations, &history);
+    } else {
+        if (lowMemory) history.startSampling(1);
+        for (int i = startNum; i < getNumFiles(); i += fileSplit) {
+            if (lowMemory) history.beginUnit(0);
+            runAnalysis(blobMode, lowMemory, mergeGraph, i, files.at(i), clangPrint, exclude, compilations);
+            if (lowMemory) history.endUnit(0, files.at(i));
+        }
+        history.stopSampling();
     }
+    if (lowMemory) history.save();
+
+    //Every file has been walked, so later segments cover the whole run.
+    if (lowMemory) dynamic_cast<LowMemoryTAGraph*>(mergeGraph)->dumpCurrentFile(getNumFiles(), "");
+
+    //Shifts the graphs. Recovered graphs are resolved once every graph from their run is back.
+    if (success && recoveryMode) {
+        recoveredGraph = mergeGraph;
+    } else if (success) {
+        {
+            RunStats::ScopedTimer timer(runStats, RunStats::RESOLVE_REF);
+            TraceRecorder::Span span("resolveReferences");
+            success = mergeGraph->resolveExternalReferences(clangPrint, false);
+        }
+
+        //A graph that couldn't be resolved isn't kept.
+        if (success) {
+            {
+                RunStats::ScopedTimer timer(runStats, RunStats::RESOLVE_FILE);
+                TraceRecorder::Span span("resolveFiles");
+                mergeGraph->resolveFiles(exclude);
+            }
+            graphs.push_back(mergeGraph);
 
-    //Shifts the graphs.
-    if (success) {
-        mergeGraph->resolveExternalReferences(clangPrint, false);
-        mergeGraph->resolveFiles(exclude);
-        graphs.push_back(mergeGraph);
+            stats->finish();
+            clangPrint->printRunStats(*stats);
+            if (profileMatchers) clangPrint->printMatcherProfile(*stats);
+            graphStats[mergeGraph] = move(stats);
+        } else {
+            delete mergeGraph;
+        }
     }
 
     //Clears the graph.
+    runStats = nullptr;
     files.clear();
+    watchRoots.clear();
+    queuedDatabase = path();
 
     //Returns the success code.
     delete clangPrint;
-    delete OptionsParser;
-    for (int i = 0; i < argc; i++) delete[] argv[i];
-    delete[] argv;
-    delete ClangExCategory;
     return success;
 }
 
@@ -295,26 +346,48 @@ bool ClangDriver::processAllFiles(bool blobMode, string mergeFile, bool lowMemor
  * @param blobMode Blob mode toggle.
  * @param lowMemory Low memory mode toggle.
  * @param mergeGraph Graph to merge in.
- * @param i The starting file.
+ * @param fileNum The number of the file in the graph's file list.
+ * @param file The file to process in low memory mode.
+ * @param clangPrint System to print messages.
+ * @param exclude Items to exclude.
+ * @param compilations The compile commands for the files.
+ * @return Whether the analysis was successful.
+ */
+bool ClangDriver::runAnalysis(bool blobMode, bool lowMemory, TAGraph* mergeGraph, int fileNum, path file,
+                              Printer* clangPrint, TAGraph::ClangExclude exclude,
+                              CompilationDatabase* compilations) {
+    //The database may be from an earlier run, so the files come from the queue.
+    vector<string> curList;
+    if (lowMemory) curList.push_back(file.string());
+    else for (path cur : files) curList.push_back(cur.string());
+
+    if (lowMemory) dynamic_cast<LowMemoryTAGraph*>(mergeGraph)->dumpCurrentFile(fileNum, file.string());
+
+    return runTool(blobMode, lowMemory, mergeGraph, curList, clangPrint, exclude, compilations);
+}
+
+/**
+ * Runs Clang on a list of files and walks them into a graph.
+ * @param blobMode Blob mode toggle.
+ * @param lowMemory Low memory mode toggle.
+ * @param mergeGraph Graph to merge in.
+ * @param sources The files to process.
  * @param clangPrint System to print messages.
  * @param exclude Items to exclude.
- * @param OptionsParser ClangEx options.
+ * @param compilations The compile commands for the files.
  * @return Whether the analysis was successful.
  */
-bool ClangDriver::runAnalysis(bool blobMode, bool lowMemory, TAGraph* mergeGraph, int i, Printer* clangPrint,
-                              TAGraph::ClangExclude exclude, CommonOptionsParser* OptionsParser) {
+bool ClangDriver::runTool(bool blobMode, bool lowMemory, TAGraph* mergeGraph, vector<string> sources,
+                          Printer* clangPrint, TAGraph::ClangExclude exclude,
+                          CompilationDatabase* compilations) {
     ASTWalker *walker;
     unique_ptr<FrontendActionFactory> act;
     bool success = true;
-
-    vector<string> curList;
-    curList.push_back(files.at(i).string());
-
-    if (lowMemory) dynamic_cast<LowMemoryTAGraph*>(mergeGraph)->dumpCurrentFile(i, files.at(i).string());
+    TraceRecorder::Span span("walk", (sources.size() == 1) ? sources.at(0) : to_string(sources.size()) + " files");
 
     //Sets up the processor.
-    ClangTool* Tool = new ClangTool(OptionsParser->getCompilations(),
-                                    (lowMemory) ? curList : OptionsParser->getSourcePathList());
+    ClangTool* Tool = new ClangTool(*compilations, sources);
+    Tool->appendArgumentsAdjuster(getInsertArgumentAdjuster(INCLUDE_DIR_ARG.c_str(), ArgumentInsertPosition::END));
 
     if (blobMode) {
         walker = new BlobWalker(clangPrint, lowMemory, exclude, mergeGraph);
@@ -322,18 +395,39 @@ bool ClangDriver::runAnalysis(bool blobMode, bool lowMemory, TAGraph* mergeGraph
         walker = new PartialWalker(clangPrint, lowMemory, exclude, mergeGraph);
     }
 
-    //Generates a matcher system.
-    MatchFinder finder;
+    //Generates a matcher system. When profiling, Clang times each matcher as well.
+    MatchFinder::MatchFinderOptions options;
+    llvm::StringMap<llvm::TimeRecord> matchRecords;
+    bool profile = profileMatchers && runStats;
+    if (profile) options.CheckProfiling.emplace(matchRecords);
+    MatchFinder finder(options);
 
     //Next, processes the matching conditions.
+    if (profile) walker->enableProfiling();
     walker->generateASTMatches(&finder);
 
-    //Runs the Clang tool.
-    act = newFrontendActionFactory(&finder);
-    int code = Tool->run(act.get());
+    //Runs the Clang tool. Matching is timed on its own, so the rest is parsing.
+    RunStats::Timing toolTiming, matchTiming;
+    MatchConsumerFactory consumerFactory(&finder, &matchTiming, (profile) ? runStats : nullptr, &matchRecords);
+    act = newFrontendActionFactory(&consumerFactory);
+    int code;
+    {
+        RunStats::ScopedTimer timer(toolTiming);
+        code = Tool->run(act.get());
+    }
     act.reset();
     clangPrint->printFileNameDone();
 
+    //Records where the time went.
+    if (runStats) {
+        RunStats::Timing insertTiming = walker->getInsertTiming();
+        runStats->addTiming(RunStats::PARSE, toolTiming - matchTiming);
+        runStats->addTiming(RunStats::MATCH, matchTiming - insertTiming);
+        runStats->addTiming(RunStats::INSERT, insertTiming);
+        runStats->addUnits((int) sources.size(), walker->getNumNodes(), walker->getNumEdges());
+        if (profile) walker->recordProfile(runStats);
+    }
+
     //Gets the code and checks for warnings.
     if (code != 0) {
         cerr << "Error: Compilation errors were detected." << endl;
@@ -346,6 +440,76 @@ bool ClangDriver::runAnalysis(bool blobMode, bool lowMemory, TAGraph* mergeGraph
     return success;
 }
 
+/**
+ * Runs low memory analysis on several workers. Each worker walks its own share
+ * of the files into its own graph, with its own spill log and settings so it
+ * can be recovered on its own. The shares are planned from earlier runs so the
+ * longest files start first and memory-heavy files never run together.
+ * Afterwards, the logs are merged into the main graph so references between
+ * workers are resolved together.
+ * @param blobMode Blob mode toggle.
+ * @param mergeGraph The main graph. It also acts as the first worker.
+ * @param exclude Items to exclude.
+ * @param compilations The compile commands for the files.
+ * @param history The costs of files from earlier runs. Updated as files are walked.
+ */
+void ClangDriver::runParallelAnalysis(bool blobMode, LowMemoryTAGraph* mergeGraph, TAGraph::ClangExclude exclude,
+                                      CompilationDatabase* compilations, UnitHistory* history){
+    int workers = min(numWorkers, getNumFiles());
+
+    //Splits up the files and creates a graph for each worker.
+    vector<vector<path>> workerFiles = history->schedule(files, workers, memBudget / workers);
+    vector<LowMemoryTAGraph*> workerGraphs;
+    for (int w = 0; w < workers; w++){
+        LowMemoryTAGraph* graph = mergeGraph;
+        if (w > 0){
+            if (lowMemoryPath.empty()) graph = new LowMemoryTAGraph();
+            else graph = new LowMemoryTAGraph(lowMemoryPath.string());
+        }
+
+        graph->setMemBudget(memBudget / workers);
+        graph->dumpSettings(workerFiles.at(w), exclude, blobMode, mergeGraph->getGraphNumber());
+        workerGraphs.push_back(graph);
+    }
+
+    //Runs the workers. Only one memory-heavy file is walked at a time.
+    mutex heavyMutex;
+    vector<thread> threads;
+    history->startSampling(workers);
+    for (int w = 0; w < workers; w++){
+        threads.push_back(thread([this, w, blobMode, exclude, compilations, history, &workerFiles, &workerGraphs,
+                                         &heavyMutex](){
+            Printer workerPrint;
+            TraceRecorder::nameThread("worker " + to_string(w));
+            vector<path>& curFiles = workerFiles.at(w);
+            for (int i = 0; i < curFiles.size(); i++){
+                unique_lock<mutex> heavyLock(heavyMutex, defer_lock);
+                if (history->isHeavy(curFiles.at(i))) heavyLock.lock();
+
+                history->beginUnit(w);
+                runAnalysis(blobMode, true, workerGraphs.at(w), i, curFiles.at(i), &workerPrint, exclude,
+                            compilations);
+                history->endUnit(w, curFiles.at(i));
+            }
+            workerGraphs.at(w)->dumpCurrentFile((int) curFiles.size(), "");
+        }));
+    }
+    for (thread& cur : threads) cur.join();
+    history->stopSampling();
+
+    //Merges the workers into the main graph.
+    mergeGraph->setMemBudget(memBudget);
+    for (int w = 1; w < workers; w++){
+        mergeGraph->absorb(workerGraphs.at(w));
+        delete workerGraphs.at(w);
+    }
+
+    //The main graph now holds every file.
+    mergeGraph->dumpCurrentFile(getNumFiles(), "");
+    mergeGraph->purgeCurrentGraph();
+    mergeGraph->dumpSettings(files, exclude, blobMode);
+}
+
 /**
  * Recovers a low memory run. Only resolves.
  * @param startDir The starting directory.
@@ -367,15 +531,42 @@ bool ClangDriver::recoverCompact(string startDir){
 
     Printer* clangPrint = new Printer();
 
-    //Now, we iterate and compact each graph.
+    //Now, we iterate and merge the graphs from each run.
+    map<int, LowMemoryTAGraph*> runs;
     for (int gNum : graphNums){
-        TAGraph* cur = new LowMemoryTAGraph(startDir, gNum);
-        cur->resolveExternalReferences(clangPrint, false);
-        cur->resolveFiles(toggle);
-        graphs.push_back(cur);
+        vector<string> ldFiles;
+        bool blobMode = false;
+        TAGraph::ClangExclude ldExclude;
+        int group = gNum;
+        readSettings(startDir + "/" + to_string(gNum) + "-" + LowMemoryTAGraph::CUR_SETTING_LOC, &ldFiles,
+                     &blobMode, &ldExclude, &group);
+
+        LowMemoryTAGraph::rollback(startDir, gNum);
+        LowMemoryTAGraph* cur = new LowMemoryTAGraph(startDir, gNum);
+        cur->setMemBudget(memBudget);
+        if (runs.count(group) > 0){
+            runs[group]->absorb(cur);
+            delete cur;
+        } else {
+            runs[group] = cur;
+        }
     }
 
-    return true;
+    //Compacts each run. Runs that can't be resolved are dropped.
+    bool success = true;
+    for (auto it = runs.begin(); it != runs.end(); it++){
+        if (!it->second->resolveExternalReferences(clangPrint, false)){
+            cerr << "Recovery Error: Run " << it->first << " could not be resolved." << endl;
+            delete it->second;
+            success = false;
+            continue;
+        }
+        it->second->resolveFiles(toggle);
+        graphs.push_back(it->second);
+    }
+
+    delete clangPrint;
+    return success;
 }
 
 /**
@@ -400,22 +591,28 @@ bool ClangDriver::recoverFull(string startDir){
     vector<string> ldFiles;
     bool blobMode;
     TAGraph::ClangExclude ldExclude;
+    map<int, LowMemoryTAGraph*> runs;
+    map<int, TAGraph::ClangExclude> runExcludes;
 
     for (int gNum : graphNums){
+        int group = gNum;
         bool succ = readSettings(startDir + "/" + to_string(gNum) + "-" + LowMemoryTAGraph::CUR_SETTING_LOC, &ldFiles,
-                                 &blobMode, &ldExclude);
+                                 &blobMode, &ldExclude, &group);
         if (!succ) {
             cerr << "Recovery Error: Settings could not be read for this file." << endl;
             return false;
         }
 
-        int startNum = readStartNum(startDir + "/" + to_string(gNum) + "-" + LowMemoryTAGraph::CUR_FILE_LOC);
+        //Drops any purge that didn't finish and resumes at the first file not fully on disk.
+        int startNum = LowMemoryTAGraph::rollback(startDir, gNum);
 
         vector<path> oldFiles = files;
         TAGraph::ClangExclude oldExclude = toggle;
 
         //Sets up the file system.
         recoveryMode = true;
+        recoveryNum = gNum;
+        recoveryGroup = group;
         auto tempLowMem = lowMemoryPath;
         lowMemoryPath = startDir;
         files.clear();
@@ -426,37 +623,259 @@ bool ClangDriver::recoverFull(string startDir){
 
         //Restores the system.
         recoveryMode = false;
+        recoveryGroup = -1;
         lowMemoryPath = tempLowMem;
         files = oldFiles;
         toggle = oldExclude;
 
         if (!code) {
             cerr << "Recovery Error: System could not process the current graph." << endl;
+            continue;
+        }
+
+        //Workers from the same run are merged before resolving.
+        LowMemoryTAGraph* cur = dynamic_cast<LowMemoryTAGraph*>(recoveredGraph);
+        recoveredGraph = nullptr;
+        if (runs.count(group) > 0){
+            runs[group]->absorb(cur);
+            delete cur;
+        } else {
+            runs[group] = cur;
+            runExcludes[group] = ldExclude;
         }
     }
 
-    return true;
+    //Resolves each run. Runs that can't be resolved are dropped.
+    Printer* clangPrint = new Printer();
+    bool success = true;
+    for (auto it = runs.begin(); it != runs.end(); it++){
+        if (!it->second->resolveExternalReferences(clangPrint, false)){
+            cerr << "Recovery Error: Run " << it->first << " could not be resolved." << endl;
+            delete it->second;
+            success = false;
+            continue;
+        }
+        it->second->resolveFiles(runExcludes[it->first]);
+        graphs.push_back(it->second);
+    }
+
+    delete clangPrint;
+    return success;
+}
+
+/**
+ * Keeps a TA model up to date with the files in the queue. Each file is
+ * extracted once, then the directories they came from are watched. When
+ * files change, only the translation units that pulled entities from them
+ * are extracted again and the TA file is rewritten in place.
+ * @param blobMode Blob mode toggle.
+ * @param outputFile The TA file to keep up to date.
+ * @param debounceMS How long changes must settle before they're applied.
+ * @param timeoutSec Stops after this many seconds without a change, or -1 to keep watching.
+ * @return Whether the model was kept up to date.
+ */
+bool ClangDriver::watchFiles(bool blobMode, string outputFile, int debounceMS, int timeoutSec){
+    FileWatcher watcher;
+    if (!watcher.isOpen()){
+        cerr << "Error: Files could not be watched: " << strerror(errno) << endl;
+        return false;
+    }
+
+    Printer* clangPrint = new Printer();
+    CompilationDatabase* compilations = getCompilations();
+    TAGraph::ClangExclude exclude = toggle;
+
+    //Extracts each file on its own to learn which files it pulls entities from.
+    TAGraph* graph = new TAGraph();
+    graph->setPathTracking(true);
+    map<string, unordered_set<string>> unitDeps;
+    clangPrint->printProcessStatus(Printer::COMPILING);
+    for (path file : files){
+        boost::system::error_code error;
+        string unit = canonical(file, error).string();
+        if (error) unit = absolute(file).string();
+
+        runTool(blobMode, false, graph, vector<string>(1, unit), clangPrint, exclude, compilations);
+        unitDeps[unit] = graph->takeTrackedPaths();
+    }
+    graph->resolveExternalReferences(clangPrint, false);
+    graph->resolveFiles(exclude);
+    bool success = writeWatchOutput(graph, outputFile);
+    clangPrint->printGenTADone(outputFile, success);
+
+    //Watches where the files were added from and where their entities came from.
+    int numDirs = 0;
+    for (path root : watchRoots) numDirs += watcher.addDirectory(root, true);
+    numDirs += watchDependencies(watcher, unitDeps);
+    bool stopOnInput = isatty(STDIN_FILENO) != 0;
+    if (success) clangPrint->printWatchStart(numDirs, stopOnInput);
+
+    int timeoutMS = (timeoutSec < 0) ? -1 : timeoutSec * 1000;
+    while (success){
+        set<string> changed;
+        FileWatcher::WaitResult result = watcher.waitForChanges(changed, debounceMS, timeoutMS,
+                                                                (stopOnInput) ? STDIN_FILENO : -1);
+        if (result == FileWatcher::STOPPED){
+            string discard;
+            getline(cin, discard);
+        }
+        if (result != FileWatcher::CHANGED) break;
+        steady_clock::time_point start = steady_clock::now();
+
+        //Works out which files are stale and which units have to be extracted again.
+        unordered_set<string> stale;
+        set<string> units;
+        bool extractAll = false;
+        for (string file : changed){
+            boost::system::error_code error;
+            bool present = is_regular_file(file, error);
+
+            //Translation units, including new ones.
+            if (unitDeps.find(file) != unitDeps.end() || (isSourceFile(file) && isUnderRoot(file))){
+                stale.insert(file);
+                if (present) units.insert(file);
+                else unitDeps.erase(file);
+                continue;
+            }
+
+            //Headers and any other file that units pulled entities from.
+            vector<string> dependents;
+            for (auto it = unitDeps.begin(); it != unitDeps.end(); it++){
+                if (it->second.find(file) != it->second.end()) dependents.push_back(it->first);
+            }
+            if (dependents.size() == 0 && !isHeaderFile(file)) continue;
+
+            //A header no unit pulled entities from may still hold macros, so everything is redone.
+            stale.insert(file);
+            units.insert(dependents.begin(), dependents.end());
+            if (dependents.size() == 0) extractAll = true;
+        }
+        if (stale.size() == 0) continue;
+        if (extractAll) for (auto it = unitDeps.begin(); it != unitDeps.end(); it++) units.insert(it->first);
+
+        //Removes what came from the stale files and extracts the units again.
+        stale.insert(units.begin(), units.end());
+        graph->removeFileEntities(stale);
+        graph->clearFiles();
+        for (string unit : units){
+            runTool(blobMode, false, graph, vector<string>(1, unit), clangPrint, exclude, compilations);
+            unitDeps[unit] = graph->takeTrackedPaths();
+        }
+        graph->resolveExternalReferences(clangPrint, true);
+        graph->resolveFiles(exclude);
+
+        //Rewrites the model.
+        success = writeWatchOutput(graph, outputFile);
+        watchDependencies(watcher, unitDeps);
+        if (success) {
+            double seconds = duration_cast<duration<double>>(steady_clock::now() - start).count();
+            clangPrint->printWatchUpdate((int) changed.size(), (int) units.size(), seconds, outputFile);
+        } else {
+            clangPrint->printGenTADone(outputFile, false);
+        }
+    }
+
+    //The model is kept like any other generated graph.
+    graph->setPathTracking(false);
+    graphs.push_back(graph);
+    files.clear();
+    watchRoots.clear();
+    queuedDatabase = path();
+
+    delete clangPrint;
+    return success;
+}
+
+/**
+ * Merges a set of TA models on disk into a single TA model.
+ * @param models The TA files to merge.
+ * @param outputFile The file to write the merged model to.
+ * @param memBudget The number of bytes the merge can hold in memory.
+ * @param tempDir The directory for temporary files.
+ * @return Whether the merge was successful.
+ */
+bool ClangDriver::mergeModels(vector<string> models, string outputFile, size_t memBudget, string tempDir){
+    Printer* clangPrint = new Printer();
+
+    //Runs the merge.
+    TAMerger merger = TAMerger(INSTANCE_FLAG, clangPrint, memBudget, tempDir);
+    bool success = merger.mergeModels(models, outputFile);
+
+    delete clangPrint;
+    return success;
+}
+
+/**
+ * Filters a TA model on disk down to certain relations and entities.
+ * @param inputFile The TA file to filter.
+ * @param outputFile The file to write the filtered model to.
+ * @param relations The relation types to keep. Keeps all if empty.
+ * @param entityTypes The entity types to keep. Keeps all if empty.
+ * @param idFile A file with the IDs to keep. Keeps all if empty.
+ * @return Whether the filter was successful.
+ */
+bool ClangDriver::filterModel(string inputFile, string outputFile, vector<string> relations,
+                              vector<string> entityTypes, string idFile){
+    Printer* clangPrint = new Printer();
+
+    //Sets up the filter.
+    TAFilter filter = TAFilter(INSTANCE_FLAG, clangPrint);
+    for (string relation : relations) filter.addRelation(relation);
+    for (string type : entityTypes){
+        if (!filter.addEntityType(type)){
+            cerr << "Error: " << type << " is not a valid entity type." << endl;
+            delete clangPrint;
+            return false;
+        }
+    }
+    if (idFile.compare("") != 0 && !filter.loadIDList(idFile)){
+        delete clangPrint;
+        return false;
+    }
+
+    //Runs the filter.
+    bool success = filter.filterModel(inputFile, outputFile);
+
+    delete clangPrint;
+    return success;
 }
 
 /**
  * Outputs an individual TA model to TA format.
  * @param modelNum The number of the model to output.
  * @param fileName The filename to output as.
+ * @param writeStats Whether the run's statistics are written beside the model.
  * @return Boolean indicating success.
  */
-bool ClangDriver::outputIndividualModel(int modelNum, string fileName){
+bool ClangDriver::outputIndividualModel(int modelNum, string fileName, bool writeStats){
     if (fileName.compare(string()) == 0) fileName = DEFAULT_FILENAME;
 
     //First, check if the number if valid.
     if (modelNum < 0 || modelNum > getNumGraphs() - 1) return false;
 
-    int succ = outputTAString(modelNum, fileName + DEFAULT_EXT);
+    //Graphs from recovered runs have no statistics.
+    auto stats = graphStats.find(graphs.at(modelNum));
+    RunStats* curStats = (stats == graphStats.end()) ? nullptr : stats->second.get();
+
+    int succ;
+    {
+        RunStats::ScopedTimer timer(curStats, RunStats::OUTPUT);
+        TraceRecorder::Span span("output", fileName + DEFAULT_EXT);
+        succ = outputTAString(modelNum, fileName + DEFAULT_EXT);
+    }
     if (succ == 0) {
         cerr << "Error writing to " << fileName << "!" << endl
              << "Check the file and retry!" << endl;
         return false;
     }
 
+    //Writes the statistics.
+    if (writeStats && !curStats) {
+        cerr << "Warning: There are no statistics for graph #" << modelNum << "." << endl;
+    } else if (writeStats && !curStats->writeJSON(fileName + STATS_EXT)) {
+        cerr << "Error writing to " << fileName + STATS_EXT << "!" << endl;
+    }
+
     deleteTAGraph(modelNum);
     return true;
 }
@@ -464,15 +883,16 @@ bool ClangDriver::outputIndividualModel(int modelNum, string fileName){
 /**
  * Outputs all models generated based on a file name.
  * @param baseFileName The base file name to output on.
+ * @param writeStats Whether each run's statistics are written beside its model.
  * @return A boolean indicating success.
  */
-bool ClangDriver::outputAllModels(string baseFileName){
+bool ClangDriver::outputAllModels(string baseFileName, bool writeStats){
     bool succ = true;
 
     //Simply goes through and outputs.
     int curNum = 0;
     while(0 < getNumGraphs()){
-        bool temp = outputIndividualModel(0, baseFileName + to_string(curNum));
+        bool temp = outputIndividualModel(0, baseFileName + to_string(curNum), writeStats);
         if (!temp) succ = false;
         curNum++;
     }
@@ -491,6 +911,7 @@ int ClangDriver::addByPath(path curPath){
     //Determines what the path is.
     if (is_directory(curPath)){
         num = addDirectory(curPath);
+        watchRoots.push_back(curPath);
     } else {
         num = addFile(curPath);
     }
@@ -498,6 +919,21 @@ int ClangDriver::addByPath(path curPath){
     return num;
 }
 
+/**
+ * Adds every file in a compilation database to the queue. The database's
+ * compile commands are used for the files when they're extracted.
+ * @param database The compilation database.
+ * @return The number of files added or -1 if the database couldn't be read.
+ */
+int ClangDriver::addCompilationDatabase(path database){
+    database = absolute(database);
+    CompilationDatabase* compilations = loadCompilationDatabase(database);
+    if (!compilations) return -1;
+
+    queuedDatabase = database;
+    return addFromDatabase(compilations);
+}
+
 /**
  * Removes a file/directory from the queue.
  * @param curPath The path to remove.
@@ -509,6 +945,11 @@ int ClangDriver::removeByPath(path curPath){
     //Determines what the path is.
     if (is_directory(curPath)){
         num = removeDirectory(curPath);
+        for (auto it = watchRoots.begin(); it != watchRoots.end();){
+            boost::system::error_code error;
+            if (equivalent(*it, curPath, error)) it = watchRoots.erase(it);
+            else it++;
+        }
     } else {
         num = removeFile(curPath);
     }
@@ -562,9 +1003,7 @@ bool ClangDriver::changeLowMemoryLoc(path curLoc){
             string dstRoot = curLoc.string() + "/" + to_string(cur) + "-";
             rename(srcRoot + LowMemoryTAGraph::CUR_SETTING_LOC, dstRoot + LowMemoryTAGraph::CUR_SETTING_LOC);
             rename(srcRoot + LowMemoryTAGraph::CUR_FILE_LOC, dstRoot + LowMemoryTAGraph::CUR_FILE_LOC);
-            rename(srcRoot + LowMemoryTAGraph::BASE_INSTANCE_FN, dstRoot + LowMemoryTAGraph::BASE_INSTANCE_FN);
-            rename(srcRoot + LowMemoryTAGraph::BASE_RELATION_FN, dstRoot + LowMemoryTAGraph::BASE_RELATION_FN);
-            rename(srcRoot + LowMemoryTAGraph::BASE_ATTRIBUTE_FN, dstRoot + LowMemoryTAGraph::BASE_ATTRIBUTE_FN);
+            rename(srcRoot + LowMemoryTAGraph::BASE_LOG_FN, dstRoot + LowMemoryTAGraph::BASE_LOG_FN);
 
             dynamic_cast<LowMemoryTAGraph*>(graphs.at(cur))->changeRoot(curLoc.string());
         }
@@ -574,6 +1013,97 @@ bool ClangDriver::changeLowMemoryLoc(path curLoc){
     return true;
 }
 
+/**
+ * Sets how much memory low memory mode can use before spilling to disk and when resolving a graph.
+ * @param budget The budget in bytes.
+ */
+void ClangDriver::setMemBudget(size_t budget){
+    memBudget = budget;
+}
+
+/**
+ * Sets how many workers low memory mode runs. The memory budget is split between them.
+ * @param workers The number of workers.
+ */
+void ClangDriver::setNumWorkers(int workers){
+    numWorkers = max(1, workers);
+}
+
+/**
+ * Sets whether each matcher is timed on its own.
+ * @param profile Whether matchers are profiled.
+ */
+void ClangDriver::setProfileMatchers(bool profile){
+    profileMatchers = profile;
+}
+
+/**
+ * Constructor. Sets up a consumer that matches each parsed unit.
+ * @param finder The matchers to run.
+ * @param timing Where the time spent matching is added.
+ * @param stats Where each matcher's time is added, or nullptr if matchers aren't profiled.
+ * @param records The profiling records the finder fills in.
+ */
+ClangDriver::MatchConsumer::MatchConsumer(MatchFinder* finder, RunStats::Timing* timing, RunStats* stats,
+                                          llvm::StringMap<llvm::TimeRecord>* records){
+    this->finder = finder;
+    this->timing = timing;
+    this->stats = stats;
+    this->records = records;
+
+    //Consumers are created as a unit starts, so parsing is traced from here.
+    parseSpan.reset(new TraceRecorder::Span("parse"));
+}
+
+/**
+ * Runs the matchers once a unit has been parsed.
+ * @param context The parsed unit.
+ */
+void ClangDriver::MatchConsumer::HandleTranslationUnit(clang::ASTContext& context){
+    string unit;
+    if (TraceRecorder::isEnabled()){
+        clang::SourceManager& manager = context.getSourceManager();
+        const clang::FileEntry* entry = manager.getFileEntryForID(manager.getMainFileID());
+        if (entry) unit = entry->getName().str();
+    }
+    parseSpan->setDetail(unit);
+    parseSpan.reset();
+
+    {
+        RunStats::ScopedTimer timer(*timing);
+        TraceRecorder::Span span("match", unit);
+        finder->matchAST(context);
+    }
+
+    //Clang replaces the records for every unit, so they're collected now.
+    if (!stats || !records) return;
+    for (auto& record : *records) stats->addMatcherTime(record.getKey().str(), record.getValue().getWallTime());
+    records->clear();
+}
+
+/**
+ * Constructor. Sets up a factory that gives each unit a timed consumer.
+ * @param finder The matchers to run.
+ * @param timing Where the time spent matching is added.
+ * @param stats Where each matcher's time is added, or nullptr if matchers aren't profiled.
+ * @param records The profiling records the finder fills in.
+ */
+ClangDriver::MatchConsumerFactory::MatchConsumerFactory(MatchFinder* finder, RunStats::Timing* timing,
+                                                        RunStats* stats, llvm::StringMap<llvm::TimeRecord>* records){
+    this->finder = finder;
+    this->timing = timing;
+    this->stats = stats;
+    this->records = records;
+}
+
+/**
+ * Creates the consumer for a unit.
+ * @return The consumer.
+ */
+unique_ptr<clang::ASTConsumer> ClangDriver::MatchConsumerFactory::newASTConsumer(){
+    return unique_ptr<clang::ASTConsumer>(new MatchConsumer(finder, timing, stats, records));
+}
+
 /**
  * Adds a file to the queue.
  * @param file The file to add.
@@ -586,38 +1116,44 @@ int ClangDriver::addFile(path file){
 }
 
 /**
- * Recursively adds a directory to the queue.
+ * Recursively adds a directory to the queue. If the directory is covered by a
+ * compilation database, its files are taken from there instead of searching.
  * @param directory The directory to add.
  * @return The number of files added.
  */
 int ClangDriver::addDirectory(path directory){
+    path database = findCompilationDatabase(directory / COMPILE_DB);
+    if (!database.empty()){
+        CompilationDatabase* compilations = loadCompilationDatabase(database);
+        int numAdded = (compilations) ? addFromDatabase(compilations, directory) : 0;
+        if (numAdded > 0) return numAdded;
+    }
+
+    //Otherwise, searches the directory for source files.
     int numAdded = 0;
-    vector<path> interiorDir = vector<path>();
-    directory_iterator endIter;
-
-    //Start by iterating through and inspecting each file.
-    for (directory_iterator iter(directory); iter != endIter; iter++){
-        //Check what the current file is.
-        if (is_regular_file(iter->path())){
-            //Check the extension.
-            string extFile = extension(iter->path());
-
-            //Iterates through the extension vector.
-            for (int i = 0; i < ext.size(); i++){
-                //Checks the file.
-                if (extFile.compare(ext.at(i)) == 0){
-                    numAdded += addFile(iter->path());
-                }
-            }
-        } else if (is_directory(iter->path())){
-            //Add the directory to the search system.
-            interiorDir.push_back(iter->path());
-        }
+    for (path file : walkDirectory(directory)) numAdded += addFile(file);
+
+    return numAdded;
+}
+
+/**
+ * Adds the files from a compilation database to the queue.
+ * @param database The compilation database.
+ * @param directory Only files under this directory are added, or all of them if it's empty.
+ * @return The number of files added.
+ */
+int ClangDriver::addFromDatabase(CompilationDatabase* database, path directory){
+    string root;
+    if (!directory.empty()){
+        boost::system::error_code error;
+        root = canonical(directory, error).string() + "/";
+        if (error) return 0;
     }
 
-    //Next, goes to all the internal directories.
-    for (path cur : interiorDir){
-        numAdded += addDirectory(cur);
+    int numAdded = 0;
+    for (string file : database->getAllFiles()){
+        if (root.size() > 0 && !boost::starts_with(file, root)) continue;
+        numAdded += addFile(file);
     }
 
     return numAdded;
@@ -647,41 +1183,80 @@ int ClangDriver::removeFile(path file){
 }
 
 /**
- * Removes a directory from the queue.
+ * Removes every queued file under a directory.
  * @param directory The directory to remove.
  * @return The number removed.
  */
 int ClangDriver::removeDirectory(path directory){
-    int numRemoved = 0;
-    vector<path> interiorDir = vector<path>();
-    directory_iterator endIter;
-
-    //Start by iterating through and inspecting each file.
-    for (directory_iterator iter(directory); iter != endIter; iter++){
-        //Check what the current file is.
-        if (is_regular_file(iter->path())){
-            //Check the extension.
-            string extFile = extension(iter->path());
-
-            //Iterates through the extension vector.
-            for (int i = 0; i < ext.size(); i++){
-                //Checks the file.
-                if (extFile.compare(ext.at(i)) == 0){
-                    numRemoved += removeFile(iter->path());
+    boost::system::error_code error;
+    string root = canonical(directory, error).string() + "/";
+    if (error) return 0;
+
+    //Checks every queued file at once instead of searching the directory.
+    size_t numFiles = files.size();
+    files.erase(remove_if(files.begin(), files.end(), [&root](const path& file){
+        boost::system::error_code fileError;
+        string fullPath = canonical(file, fileError).string();
+        return !fileError && boost::starts_with(fullPath, root);
+    }), files.end());
+
+    return (int) (numFiles - files.size());
+}
+
+/**
+ * Searches a directory tree for source files. Directories are handed out to
+ * several threads so large trees on slow disks don't take as long.
+ * @param directory The directory to search.
+ * @return The source files, sorted by path.
+ */
+vector<path> ClangDriver::walkDirectory(path directory){
+    deque<path> pending(1, directory);
+    vector<path> found;
+    int numBusy = 0;
+    mutex walkMutex;
+    condition_variable walkReady;
+
+    //Each thread takes a directory, lists it and queues its subdirectories.
+    auto walker = [this, &pending, &found, &numBusy, &walkMutex, &walkReady](){
+        vector<path> curFound;
+        unique_lock<mutex> lock(walkMutex);
+        while (true){
+            walkReady.wait(lock, [&pending, &numBusy](){ return !pending.empty() || numBusy == 0; });
+            if (pending.empty()) break;
+
+            path cur = pending.front();
+            pending.pop_front();
+            numBusy++;
+            lock.unlock();
+
+            vector<path> interiorDir;
+            boost::system::error_code error;
+            for (directory_iterator iter(cur, error), end; !error && iter != end; iter.increment(error)){
+                if (is_regular_file(iter->path(), error)){
+                    if (isSourceFile(iter->path())) curFound.push_back(iter->path());
+                } else if (is_directory(iter->path(), error)){
+                    interiorDir.push_back(iter->path());
                 }
             }
-        } else if (is_directory(iter->path())){
-            //Add the directory to the search system.
-            interiorDir.push_back(iter->path());
+
+            lock.lock();
+            numBusy--;
+            pending.insert(pending.end(), interiorDir.begin(), interiorDir.end());
+            walkReady.notify_all();
         }
-    }
 
-    //Next, goes to all the internal directories.
-    for (path cur : interiorDir){
-        numRemoved += removeDirectory(cur);
-    }
+        found.insert(found.end(), curFound.begin(), curFound.end());
+    };
 
-    return numRemoved;
+    //Runs the threads, including this one.
+    int numThreads = max(1, (int) thread::hardware_concurrency());
+    vector<thread> threads;
+    for (int i = 1; i < numThreads; i++) threads.push_back(thread(walker));
+    walker();
+    for (thread& cur : threads) cur.join();
+
+    sort(found.begin(), found.end());
+    return found;
 }
 
 /**
@@ -759,22 +1334,8 @@ vector<string> ClangDriver::getDisabled(){
  * @return Success or failure of the output.
  */
 bool ClangDriver::outputTAString(int modelNum, string fileName){
-    //First, runs the graph builder process.
-    string tupleAttribute = graphs.at(modelNum)->generateTAFormat();
-
-    //Next, writes to disk.
-    std::ofstream taFile;
-    taFile.open(fileName.c_str());
-
-    //Check if the file is opened.
-    if (!taFile.is_open()){
-        return false;
-    }
-
-    taFile << tupleAttribute;
-    taFile.close();
-
-    return true;
+    //Graphs write themselves so low memory graphs can stream from disk.
+    return graphs.at(modelNum)->writeTAFormat(fileName);
 }
 
 /**
@@ -788,6 +1349,7 @@ void ClangDriver::deleteTAGraph(int modelNum){
     //Next, removes the item and deletes.
     TAGraph* curGraph = graphs.at(modelNum);
     graphs.erase(graphs.begin() + modelNum);
+    graphStats.erase(curGraph);
 
     delete curGraph;
 }
@@ -799,7 +1361,7 @@ void ClangDriver::deleteTAGraph(int modelNum){
  */
 vector<int> ClangDriver::getLMGraphs(string startDir){
     vector<int> results;
-    std::regex fReg("[0-9]+-(instances|relations|attributes).ta");
+    std::regex fReg("[0-9]+-" + LowMemoryTAGraph::BASE_LOG_FN);
 
     //Gets the current directory.
     path curDir = startDir;
@@ -810,7 +1372,7 @@ vector<int> ClangDriver::getLMGraphs(string startDir){
 
         //Get the extension.
         string extension = boost::filesystem::extension(cur);
-        if (extension != ".ta" || !regex_match(cur.filename().string(), fReg)) continue;
+        if (extension != ".log" || !regex_match(cur.filename().string(), fReg)) continue;
 
         int num = extractIntegerWords(cur.filename().string());
         if (num == -1) continue;
@@ -823,7 +1385,7 @@ vector<int> ClangDriver::getLMGraphs(string startDir){
 
     //Populate with values.
     for (auto it = vals.begin(); it != vals.end(); it++){
-        if (it->second == 3){
+        if (it->second == 1){
             results.push_back(it->first);
         }
     }
@@ -838,10 +1400,11 @@ vector<int> ClangDriver::getLMGraphs(string startDir){
  * @param files The files in the setting.
  * @param blobMode The blob mode toggle in the settings.
  * @param exclude The exclusions in the settings.
+ * @param group The graph this one is merged into. Left alone if the settings don't say.
  * @return Whether the read was successful.
  */
 bool ClangDriver::readSettings(string loc, vector<string>* files, bool* blobMode,
-                               TAGraph::ClangExclude* exclude){
+                               TAGraph::ClangExclude* exclude, int* group){
     std::ifstream settingFile(loc);
     if (!settingFile.is_open()) return false;
 
@@ -855,6 +1418,10 @@ bool ClangDriver::readSettings(string loc, vector<string>* files, bool* blobMode
     //Get the booleans.
     string booleans;
     getline(settingFile, booleans);
+
+    //Gets the graph this one is merged into.
+    string groupLine;
+    if (getline(settingFile, groupLine) && groupLine.size() > 0) *group = stoi(groupLine);
     settingFile.close();
 
     stringstream sstream = stringstream(booleans);
@@ -874,22 +1441,6 @@ bool ClangDriver::readSettings(string loc, vector<string>* files, bool* blobMode
     return true;
 }
 
-/**
- * Gets the initial file to start reading again.
- * @param file The file to read.
- * @return The start number.
- */
-int ClangDriver::readStartNum(std::string file){
-    std::ifstream curFile(file);
-    if (!curFile.is_open()) return 0;
-
-    int fileNum;
-    curFile >> fileNum;
-
-    curFile.close();
-    return fileNum;
-}
-
 /**
  * Gets integers from a string.
  * @param str The string to extract.
@@ -913,34 +1464,141 @@ int ClangDriver::extractIntegerWords(string str) {
 }
 
 /**
- * Generates an argv array based on the files in the queue and Clang's input format.
- * @param argc The number of tokens.
- * @return The new argv command.
+ * Writes the watched model. The file is written beside the old one and then
+ * moved over it, so readers never see a half written model.
+ * @param graph The graph to write.
+ * @param outputFile The TA file to write.
+ * @return Whether the model was written.
  */
-char** ClangDriver::prepareArgs(int *argc, int startVal, int finalVal){
-    int size = BASE_LEN + (finalVal - startVal);
+bool ClangDriver::writeWatchOutput(TAGraph* graph, string outputFile){
+    string tempFile = outputFile + TEMP_EXT;
+    if (!graph->writeTAFormat(tempFile)) return false;
 
-    //Sets argc.
-    *argc = size;
+    boost::system::error_code error;
+    rename(tempFile, outputFile, error);
+    return !error;
+}
 
-    //Next, argv.
-    char** argv = new char*[size];
+/**
+ * Watches the directories of every unit and every file they pulled entities from.
+ * @param watcher The watcher to add the directories to.
+ * @param unitDeps The files each unit pulled entities from.
+ * @return The number of new directories watched.
+ */
+int ClangDriver::watchDependencies(FileWatcher& watcher, map<string, unordered_set<string>>& unitDeps){
+    set<string> dirs;
+    for (auto it = unitDeps.begin(); it != unitDeps.end(); it++){
+        dirs.insert(path(it->first).parent_path().string());
+        for (const string& dep : it->second) dirs.insert(path(dep).parent_path().string());
+    }
 
-    //Copies the base start.
-    argv[0] = new char[DEFAULT_START.size() + 1];
-    argv[1] = new char[INCLUDE_DIR_LOC.size() + 1];
+    int numAdded = 0;
+    for (string dir : dirs) numAdded += watcher.addDirectory(dir, false);
+    return numAdded;
+}
 
-    //Next, moves them over.
-    strcpy(argv[0], DEFAULT_START.c_str());
-    strcpy(argv[1], INCLUDE_DIR_LOC.c_str());
+/**
+ * Checks whether a file has one of the source extensions.
+ * @param file The file to check.
+ * @return Whether it is a source file.
+ */
+bool ClangDriver::isSourceFile(path file){
+    string extFile = extension(file);
+    return find(ext.begin(), ext.end(), extFile) != ext.end();
+}
 
-    //Next, loops through the files and copies.
-    for (int i = 0, filePos = startVal; filePos < finalVal; i++, filePos++){
-        argv[i + BASE_LEN] = new char[files.at(filePos).string().size() + 1];
-        strcpy(argv[i + BASE_LEN], files.at(filePos).c_str());
+/**
+ * Checks whether a file has one of the header extensions.
+ * @param file The file to check.
+ * @return Whether it is a header file.
+ */
+bool ClangDriver::isHeaderFile(path file){
+    string extFile = extension(file);
+    return find(HEADER_EXT.begin(), HEADER_EXT.end(), extFile) != HEADER_EXT.end();
+}
+
+/**
+ * Checks whether a file is inside one of the directories that were added.
+ * @param file The full path of the file.
+ * @return Whether the file is under an added directory.
+ */
+bool ClangDriver::isUnderRoot(path file){
+    for (path root : watchRoots){
+        boost::system::error_code error;
+        string rootDir = canonical(root, error).string();
+        if (!error && boost::starts_with(file.string(), rootDir + "/")) return true;
+    }
+
+    return false;
+}
+
+/**
+ * Gets the compile commands for the files in the queue. A database given with
+ * add --compdb is used first. Otherwise, the database beside the first file is
+ * used, or the files are compiled without flags if there isn't one.
+ * @return The compilation database.
+ */
+CompilationDatabase* ClangDriver::getCompilations(){
+    path database = queuedDatabase;
+    if (database.empty() && !files.empty()) database = findCompilationDatabase(files.at(0));
+
+    CompilationDatabase* compilations = loadCompilationDatabase(database);
+    if (!compilations) compilations = loadCompilationDatabase(path());
+
+    return compilations;
+}
+
+/**
+ * Loads a compilation database. Large databases are slow to parse, so the last
+ * one is kept between runs and only read again when it changes on disk.
+ * @param database The database file, or an empty path for one without flags.
+ * @return The compilation database or nullptr if it couldn't be read.
+ */
+CompilationDatabase* ClangDriver::loadCompilationDatabase(path database){
+    boost::system::error_code error;
+    time_t modified = (database.empty()) ? 0 : last_write_time(database, error);
+
+    //Reuses the database if it's still current.
+    if (cachedCompilations && !error && database == cachedDatabase && modified == cachedDatabaseTime) {
+        return cachedCompilations.get();
+    }
+
+    //Without a database, files are compiled without flags like Clang does.
+    cachedCompilations.reset();
+    cachedDatabase = path();
+    if (database.empty()){
+        cachedCompilations.reset(new FixedCompilationDatabase(".", vector<string>()));
+    } else {
+        string message = error.message();
+        if (!error) {
+            cachedCompilations = JSONCompilationDatabase::loadFromFile(database.string(), message,
+                                                                       JSONCommandLineSyntax::AutoDetect);
+        }
+        if (!cachedCompilations){
+            cerr << "Error: The compilation database " << database << " could not be read: " << message << endl;
+            return nullptr;
+        }
+    }
+
+    cachedDatabase = database;
+    cachedDatabaseTime = modified;
+    return cachedCompilations.get();
+}
+
+/**
+ * Finds the compilation database that applies to a file. Like Clang, the
+ * file's directory and each of its parents are searched.
+ * @param file The file to search from.
+ * @return The path of the database or an empty path if there isn't one.
+ */
+path ClangDriver::findCompilationDatabase(path file){
+    boost::system::error_code error;
+    for (path dir = absolute(file).parent_path(); !dir.empty(); dir = dir.parent_path()){
+        path database = dir / COMPILE_DB;
+        if (exists(database, error)) return database;
     }
 
-    return argv;
+    return path();
 }
 
 /**
@@ -29,9 +29,21 @@
 
 #include <vector>
 #include <string>
+#include <map>
+#include <memory>
+#include <ctime>
 #include <boost/filesystem.hpp>
-#include "clang/Tooling/CommonOptionsParser.h"
+#include "clang/Tooling/CompilationDatabase.h"
+#include "clang/AST/ASTConsumer.h"
+#include "clang/ASTMatchers/ASTMatchFinder.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Timer.h"
 #include "../Graph/TAGraph.h"
+#include "../Graph/LowMemoryTAGraph.h"
+#include "../File/FileWatcher.h"
+#include "UnitHistory.h"
+#include "RunStats.h"
+#include "TraceRecorder.h"
 
 using namespace boost::filesystem;
 
@@ -60,54 +72,126 @@ public:
     bool processAllFiles(bool blobMode, std::string mergeFile, bool lowMemory, int startNum = 0);
     bool recoverCompact(std::string startDir);
     bool recoverFull(std::string startDir);
+    bool watchFiles(bool blobMode, std::string outputFile, int debounceMS, int timeoutSec = -1);
+
+    /** TA Model Merging/Filtering */
+    bool mergeModels(std::vector<std::string> models, std::string outputFile, size_t memBudget,
+                     std::string tempDir = std::string());
+    bool filterModel(std::string inputFile, std::string outputFile, std::vector<std::string> relations,
+                     std::vector<std::string> entityTypes, std::string idFile = std::string());
 
     /** Output Helpers */
-    bool outputIndividualModel(int modelNum, std::string fileName = std::string());
-    bool outputAllModels(std::string baseFileName);
+    bool outputIndividualModel(int modelNum, std::string fileName = std::string(), bool writeStats = false);
+    bool outputAllModels(std::string baseFileName, bool writeStats = false);
 
     /** Add/Remove By Path */
     int addByPath(path curPath);
+    int addCompilationDatabase(path database);
     int removeByPath(path curPath);
     int removeByRegex(std::string regex);
 
     /** Low Memory System */
     bool changeLowMemoryLoc(path curLoc);
+    void setMemBudget(size_t budget);
+    void setNumWorkers(int workers);
+
+    /** Profiling */
+    void setProfileMatchers(bool profile);
 
 private:
     /** Default Arguments */
     const std::string INSTANCE_FLAG = "$INSTANCE";
     const std::string DEFAULT_EXT = ".ta";
     const std::string DEFAULT_FILENAME = "out";
-    const std::string DEFAULT_START = "./ClangEx";
     const std::string INCLUDE_DIR = "./include";
-    const std::string INCLUDE_DIR_LOC = "--extra-arg=-I" + INCLUDE_DIR;
-    const int BASE_LEN = 2;
+    const std::string INCLUDE_DIR_ARG = "-I" + INCLUDE_DIR;
     const int FILE_SPLIT = 1;
+    const size_t DEFAULT_MEM_BUDGET = (size_t) 1024 * 1024 * 1024;
+    const std::string COMPILE_DB = "compile_commands.json";
+    const std::string TEMP_EXT = ".tmp";
+    const std::string HISTORY_FILE = "ClangExHistory.txt";
+    const std::string STATS_EXT = ".stats.json";
 
     /** Private Variables */
     std::vector<TAGraph*> graphs;
     std::vector<path> files;
+    std::vector<path> watchRoots;
+    path queuedDatabase;
     std::vector<std::string> ext;
     path lowMemoryPath = "";
+    size_t memBudget = DEFAULT_MEM_BUDGET;
+    int numWorkers = 1;
     bool recoveryMode = false;
+    int recoveryNum = 0;
+    int recoveryGroup = -1;
+    TAGraph* recoveredGraph = nullptr;
+    RunStats* runStats = nullptr;
+    bool profileMatchers = false;
+    std::map<TAGraph*, std::unique_ptr<RunStats>> graphStats;
+
+    /** Compilation Database Cache */
+    std::unique_ptr<clang::tooling::CompilationDatabase> cachedCompilations;
+    path cachedDatabase;
+    std::time_t cachedDatabaseTime = 0;
 
     /** Toggle System */
     std::string langString = "\tcSubSystem\n\tcFile\n\tcClass\n\tcFunction\n\tcVariable\n\tcEnum\n\tcStruct\n\tcUnion\n";
     TAGraph::ClangExclude toggle;
 
     /** C/C++ Extensions */
-    const std::string C_FILE_EXT = ".c";
-    const std::string CPLUS_FILE_EXT = ".cc";
-    const std::string CPLUSPLUS_FILE_EXT = ".cpp";
+    const std::vector<std::string> SOURCE_EXT = {".c", ".cc", ".cpp", ".cxx", ".c++", ".C"};
+    const std::vector<std::string> HEADER_EXT = {".h", ".hh", ".hpp", ".hxx"};
+
+    /** Times Matching Apart From Parsing */
+    class MatchConsumer : public clang::ASTConsumer {
+    public:
+        MatchConsumer(clang::ast_matchers::MatchFinder* finder, RunStats::Timing* timing,
+                      RunStats* stats = nullptr, llvm::StringMap<llvm::TimeRecord>* records = nullptr);
+        void HandleTranslationUnit(clang::ASTContext& context) override;
+
+    private:
+        clang::ast_matchers::MatchFinder* finder;
+        RunStats::Timing* timing;
+        RunStats* stats;
+        llvm::StringMap<llvm::TimeRecord>* records;
+        std::unique_ptr<TraceRecorder::Span> parseSpan;
+    };
+    class MatchConsumerFactory {
+    public:
+        MatchConsumerFactory(clang::ast_matchers::MatchFinder* finder, RunStats::Timing* timing,
+                             RunStats* stats = nullptr, llvm::StringMap<llvm::TimeRecord>* records = nullptr);
+        std::unique_ptr<clang::ASTConsumer> newASTConsumer();
+
+    private:
+        clang::ast_matchers::MatchFinder* finder;
+        RunStats::Timing* timing;
+        RunStats* stats;
+        llvm::StringMap<llvm::TimeRecord>* records;
+    };
 
     /** Add/Remove Helper Methods */
     int addFile(path file);
     int addDirectory(path directory);
+    int addFromDatabase(clang::tooling::CompilationDatabase* database, path directory = path());
     int removeFile(path file);
     int removeDirectory(path directory);
-
-    bool runAnalysis(bool blobMode, bool lowMemory, TAGraph* mergeGraph, int i, Printer* clangPrint,
-                     TAGraph::ClangExclude exclude, clang::tooling::CommonOptionsParser* OptionsParser);
+    std::vector<path> walkDirectory(path directory);
+
+    bool runAnalysis(bool blobMode, bool lowMemory, TAGraph* mergeGraph, int fileNum, path file,
+                     Printer* clangPrint, TAGraph::ClangExclude exclude,
+                     clang::tooling::CompilationDatabase* compilations);
+    void runParallelAnalysis(bool blobMode, LowMemoryTAGraph* mergeGraph, TAGraph::ClangExclude exclude,
+                             clang::tooling::CompilationDatabase* compilations, UnitHistory* history);
+    bool runTool(bool blobMode, bool lowMemory, TAGraph* mergeGraph, std::vector<std::string> sources,
+                 Printer* clangPrint, TAGraph::ClangExclude exclude,
+                 clang::tooling::CompilationDatabase* compilations);
+
+    /** Watch Helpers */
+    bool writeWatchOutput(TAGraph* graph, std::string outputFile);
+    int watchDependencies(FileWatcher& watcher, std::map<std::string, std::unordered_set<std::string>>& unitDeps);
+    bool isSourceFile(path file);
+    bool isHeaderFile(path file);
+    bool isUnderRoot(path file);
 
     /** Enabled Strings */
     std::vector<std::string> getEnabled();
@@ -120,12 +204,13 @@ private:
     /** Recovery Helper */
     std::vector<int> getLMGraphs(std::string startDir);
     bool readSettings(std::string file, std::vector<std::string>* files, bool* blobMode,
-                      TAGraph::ClangExclude* exclude);
-    int readStartNum(std::string file);
+                      TAGraph::ClangExclude* exclude, int* group);
 
     /** Argument Helpers */
+    clang::tooling::CompilationDatabase* getCompilations();
+    clang::tooling::CompilationDatabase* loadCompilationDatabase(path database);
+    path findCompilationDatabase(path file);
     int extractIntegerWords(std::string str);
-    char** prepareArgs(int *argc, int start, int final);
 
     /** Low Memory System */
     std::vector<std::string> splitList(std::string list);
@@ -0,0 +1,339 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// RunStats.cpp
+//
+// Created By: Bryan J Muscedere
+// Date: 19/10/26.
+//
+// Keeps track of where an extraction run spends its time. Each phase of a
+// run gets its wall clock and CPU time, along with how many translation
+// units, entities and relations were processed and the peak memory used.
+//
+// Copyright (C) 2017, Bryan J. Muscedere
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <ctime>
+#include <sys/resource.h>
+#include "RunStats.h"
+
+using namespace std;
+using namespace std::chrono;
+
+const string RunStats::PHASE_NAMES[RunStats::NUM_PHASES] = {"parse", "match", "insert", "resolveReferences",
+                                                             "resolveFiles", "output"};
+
+/**
+ * Adds another timing to this one.
+ * @param other The timing to add.
+ * @return This timing.
+ */
+RunStats::Timing& RunStats::Timing::operator+=(const Timing& other){
+    wallSeconds += other.wallSeconds;
+    cpuSeconds += other.cpuSeconds;
+    return *this;
+}
+
+/**
+ * Takes another timing away from this one. Never drops below zero.
+ * @param other The timing to take away.
+ * @return The difference.
+ */
+RunStats::Timing RunStats::Timing::operator-(const Timing& other) const {
+    Timing result;
+    result.wallSeconds = max(0.0, wallSeconds - other.wallSeconds);
+    result.cpuSeconds = max(0.0, cpuSeconds - other.cpuSeconds);
+    return result;
+}
+
+/**
+ * Constructor. Starts timing a block run by the current thread.
+ * @param timing Where the time spent is added once the block ends.
+ */
+RunStats::ScopedTimer::ScopedTimer(Timing& timing){
+    this->timing = &timing;
+    wallStart = steady_clock::now();
+    cpuStart = threadCPUSeconds();
+}
+
+/**
+ * Constructor. Starts timing a phase that has the whole process to itself,
+ * so CPU time spent by any helper threads is counted too.
+ * @param stats The stats the phase is added to. Nothing is timed if this is nullptr.
+ * @param phase The phase.
+ */
+RunStats::ScopedTimer::ScopedTimer(RunStats* stats, Phase phase){
+    this->stats = stats;
+    this->phase = phase;
+    processCPU = true;
+    wallStart = steady_clock::now();
+    cpuStart = processCPUSeconds();
+}
+
+/**
+ * Destructor. Adds the time spent in the block.
+ */
+RunStats::ScopedTimer::~ScopedTimer(){
+    Timing spent;
+    spent.wallSeconds = duration_cast<duration<double>>(steady_clock::now() - wallStart).count();
+    spent.cpuSeconds = ((processCPU) ? processCPUSeconds() : threadCPUSeconds()) - cpuStart;
+
+    if (timing) *timing += spent;
+    if (stats) stats->addTiming(phase, spent);
+}
+
+/**
+ * Constructor. Starts the run.
+ */
+RunStats::RunStats(){
+    start();
+}
+
+/**
+ * Starts timing the whole run.
+ */
+void RunStats::start(){
+    lock_guard<mutex> lock(statsMutex);
+    wallStart = steady_clock::now();
+    cpuStart = processCPUSeconds();
+}
+
+/**
+ * Stops timing the whole run and records the peak memory.
+ */
+void RunStats::finish(){
+    lock_guard<mutex> lock(statsMutex);
+    total.wallSeconds += duration_cast<duration<double>>(steady_clock::now() - wallStart).count();
+    total.cpuSeconds += processCPUSeconds() - cpuStart;
+    peakBytes = max(peakBytes, peakRSS());
+}
+
+/**
+ * Adds time to a phase. Phases run by several workers add up their time.
+ * @param phase The phase.
+ * @param timing The time spent.
+ */
+void RunStats::addTiming(Phase phase, Timing timing){
+    lock_guard<mutex> lock(statsMutex);
+    phases[phase] += timing;
+}
+
+/**
+ * Counts processed translation units and what they added.
+ * @param numUnits The number of translation units.
+ * @param numNodes The number of entities added.
+ * @param numEdges The number of relations added.
+ */
+void RunStats::addUnits(int numUnits, unsigned long long numNodes, unsigned long long numEdges){
+    lock_guard<mutex> lock(statsMutex);
+    this->numUnits += numUnits;
+    this->numNodes += numNodes;
+    this->numEdges += numEdges;
+}
+
+/**
+ * Adds time Clang spent running a matcher, including its callbacks.
+ * @param name The name of the matcher.
+ * @param matchSeconds The time spent.
+ */
+void RunStats::addMatcherTime(string name, double matchSeconds){
+    lock_guard<mutex> lock(statsMutex);
+    MatcherTiming& matcher = matchers[name];
+    matcher.name = name;
+    matcher.matchSeconds += matchSeconds;
+}
+
+/**
+ * Adds time spent handling a matcher's matches.
+ * @param name The name of the matcher.
+ * @param callbackSeconds The time spent in the callbacks.
+ * @param numMatches The number of matches.
+ */
+void RunStats::addMatcherCallbacks(string name, double callbackSeconds, unsigned long long numMatches){
+    lock_guard<mutex> lock(statsMutex);
+    MatcherTiming& matcher = matchers[name];
+    matcher.name = name;
+    matcher.callbackSeconds += callbackSeconds;
+    matcher.numMatches += numMatches;
+}
+
+/**
+ * Gets the time spent in a phase.
+ * @param phase The phase.
+ * @return The time spent.
+ */
+RunStats::Timing RunStats::getTiming(Phase phase){
+    lock_guard<mutex> lock(statsMutex);
+    return phases[phase];
+}
+
+/**
+ * Gets the time spent on the whole run.
+ * @return The time spent.
+ */
+RunStats::Timing RunStats::getTotal(){
+    lock_guard<mutex> lock(statsMutex);
+    return total;
+}
+
+/**
+ * Gets the number of translation units processed.
+ * @return The number of units.
+ */
+int RunStats::getNumUnits(){
+    lock_guard<mutex> lock(statsMutex);
+    return numUnits;
+}
+
+/**
+ * Gets the number of entities added.
+ * @return The number of entities.
+ */
+unsigned long long RunStats::getNumNodes(){
+    lock_guard<mutex> lock(statsMutex);
+    return numNodes;
+}
+
+/**
+ * Gets the number of relations added.
+ * @return The number of relations.
+ */
+unsigned long long RunStats::getNumEdges(){
+    lock_guard<mutex> lock(statsMutex);
+    return numEdges;
+}
+
+/**
+ * Gets the peak memory of the process when the run finished.
+ * @return The peak resident set size in bytes.
+ */
+size_t RunStats::getPeakRSS(){
+    lock_guard<mutex> lock(statsMutex);
+    return peakBytes;
+}
+
+/**
+ * Gets the time spent in each profiled matcher, most expensive first.
+ * @return The matcher timings.
+ */
+vector<RunStats::MatcherTiming> RunStats::getMatcherTimings(){
+    lock_guard<mutex> lock(statsMutex);
+    vector<MatcherTiming> timings;
+    for (auto it = matchers.begin(); it != matchers.end(); it++) timings.push_back(it->second);
+
+    stable_sort(timings.begin(), timings.end(), [](const MatcherTiming& a, const MatcherTiming& b){
+        return a.matchSeconds > b.matchSeconds;
+    });
+    return timings;
+}
+
+/**
+ * Converts the stats to JSON.
+ * @return The JSON document.
+ */
+string RunStats::toJSON(){
+    lock_guard<mutex> lock(statsMutex);
+    stringstream json;
+
+    json << "{\n  \"phases\": {\n";
+    for (int i = 0; i < NUM_PHASES; i++){
+        json << "    \"" << PHASE_NAMES[i] << "\": {\"wallSeconds\": " << phases[i].wallSeconds
+             << ", \"cpuSeconds\": " << phases[i].cpuSeconds << "}" << ((i < NUM_PHASES - 1) ? "," : "") << "\n";
+    }
+    json << "  },\n"
+         << "  \"wallSeconds\": " << total.wallSeconds << ",\n"
+         << "  \"cpuSeconds\": " << total.cpuSeconds << ",\n"
+         << "  \"units\": " << numUnits << ",\n"
+         << "  \"entities\": " << numNodes << ",\n"
+         << "  \"relations\": " << numEdges << ",\n"
+         << "  \"unitsPerSecond\": " << perSecond(numUnits, total.wallSeconds) << ",\n"
+         << "  \"entitiesPerSecond\": " << perSecond(numNodes, total.wallSeconds) << ",\n"
+         << "  \"relationsPerSecond\": " << perSecond(numEdges, total.wallSeconds) << ",\n"
+         << "  \"peakRSSBytes\": " << peakBytes;
+
+    //Matchers are only there when they were profiled.
+    if (matchers.size() > 0){
+        json << ",\n  \"matchers\": {\n";
+        for (auto it = matchers.begin(); it != matchers.end(); it++){
+            json << "    \"" << it->first << "\": {\"matchSeconds\": " << it->second.matchSeconds
+                 << ", \"callbackSeconds\": " << it->second.callbackSeconds << ", \"matches\": "
+                 << it->second.numMatches << "}" << ((next(it) != matchers.end()) ? "," : "") << "\n";
+        }
+        json << "  }";
+    }
+    json << "\n}\n";
+
+    return json.str();
+}
+
+/**
+ * Writes the stats to a JSON file.
+ * @param fileName The file to write.
+ * @return Whether the file was written.
+ */
+bool RunStats::writeJSON(string fileName){
+    ofstream output(fileName);
+    if (!output.is_open()) return false;
+
+    output << toJSON();
+    output.close();
+    return !output.fail();
+}
+
+/**
+ * Gets the CPU time used by the current thread.
+ * @return The CPU time in seconds.
+ */
+double RunStats::threadCPUSeconds(){
+    struct timespec time;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) != 0) return 0;
+
+    return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+/**
+ * Gets the CPU time used by the whole process.
+ * @return The CPU time in seconds.
+ */
+double RunStats::processCPUSeconds(){
+    struct timespec time;
+    if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time) != 0) return 0;
+
+    return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+/**
+ * Gets the most memory the process has held.
+ * @return The peak resident set size in bytes.
+ */
+size_t RunStats::peakRSS(){
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+
+    //Linux reports kilobytes.
+    return (size_t) usage.ru_maxrss * 1024;
+}
+
+/**
+ * Gets a rate, guarding against runs that took no time.
+ * @param count The number of items.
+ * @param seconds The time taken.
+ * @return The items per second.
+ */
+double RunStats::perSecond(double count, double seconds){
+    return (seconds > 0) ? count / seconds : 0;
+}
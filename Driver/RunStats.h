@@ -0,0 +1,125 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// RunStats.h
+//
+// Created By: Bryan J Muscedere
+// Date: 19/10/26.
+//
+// Keeps track of where an extraction run spends its time. Each phase of a
+// run gets its wall clock and CPU time, along with how many translation
+// units, entities and relations were processed and the peak memory used.
+//
+// Copyright (C) 2017, Bryan J. Muscedere
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CLANGEX_RUNSTATS_H
+#define CLANGEX_RUNSTATS_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <mutex>
+
+class RunStats {
+public:
+    /** Run Phases */
+    enum Phase {PARSE, MATCH, INSERT, RESOLVE_REF, RESOLVE_FILE, OUTPUT};
+    static const int NUM_PHASES = 6;
+    static const std::string PHASE_NAMES[NUM_PHASES];
+
+    /** Time Spent */
+    struct Timing {
+        double wallSeconds = 0;
+        double cpuSeconds = 0;
+
+        Timing& operator+=(const Timing& other);
+        Timing operator-(const Timing& other) const;
+    };
+
+    /** Time Spent In A Single Matcher */
+    struct MatcherTiming {
+        std::string name;
+        double matchSeconds = 0;
+        double callbackSeconds = 0;
+        unsigned long long numMatches = 0;
+    };
+
+    /** Times A Block Of Code */
+    class ScopedTimer {
+    public:
+        ScopedTimer(Timing& timing);
+        ScopedTimer(RunStats* stats, Phase phase);
+        ~ScopedTimer();
+
+    private:
+        Timing* timing = nullptr;
+        RunStats* stats = nullptr;
+        Phase phase = PARSE;
+        bool processCPU = false;
+        std::chrono::steady_clock::time_point wallStart;
+        double cpuStart;
+    };
+
+    /** Constructor */
+    RunStats();
+
+    /** Run Operations */
+    void start();
+    void finish();
+
+    /** Recorders */
+    void addTiming(Phase phase, Timing timing);
+    void addUnits(int numUnits, unsigned long long numNodes, unsigned long long numEdges);
+    void addMatcherTime(std::string name, double matchSeconds);
+    void addMatcherCallbacks(std::string name, double callbackSeconds, unsigned long long numMatches);
+
+    /** Getters */
+    Timing getTiming(Phase phase);
+    Timing getTotal();
+    int getNumUnits();
+    unsigned long long getNumNodes();
+    unsigned long long getNumEdges();
+    size_t getPeakRSS();
+    std::vector<MatcherTiming> getMatcherTimings();
+
+    /** Output */
+    std::string toJSON();
+    bool writeJSON(std::string fileName);
+
+    /** Clocks */
+    static double threadCPUSeconds();
+    static double processCPUSeconds();
+    static size_t peakRSS();
+
+private:
+    /** Private Variables */
+    Timing phases[NUM_PHASES];
+    Timing total;
+    std::chrono::steady_clock::time_point wallStart;
+    double cpuStart = 0;
+    int numUnits = 0;
+    unsigned long long numNodes = 0;
+    unsigned long long numEdges = 0;
+    size_t peakBytes = 0;
+    std::map<std::string, MatcherTiming> matchers;
+    std::mutex statsMutex;
+
+    /** Helper Methods */
+    static double perSecond(double count, double seconds);
+};
+
+
+#endif //CLANGEX_RUNSTATS_H
@@ -0,0 +1,199 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// TraceRecorder.cpp
+//
+// Created By: Bryan J Muscedere
+// Date: 19/10/26.
+//
+// Records what each thread was doing during a run as a timeline of spans.
+// Each thread appends to its own buffer so recording stays cheap, and the
+// timeline is written in the Chrome trace-event format so it can be opened
+// in Perfetto or chrome://tracing.
+//
+// Copyright (C) 2017, Bryan J. Muscedere
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <fstream>
+#include <cstdio>
+#include <unistd.h>
+#include "TraceRecorder.h"
+
+using namespace std;
+using namespace std::chrono;
+
+atomic<bool> TraceRecorder::enabled(false);
+atomic<int> TraceRecorder::generation(0);
+steady_clock::time_point TraceRecorder::origin;
+vector<shared_ptr<TraceRecorder::Buffer>> TraceRecorder::buffers;
+mutex TraceRecorder::buffersMutex;
+
+/**
+ * Constructor. Starts a span if a trace is being recorded.
+ * @param name The name of the span. Must outlive the trace.
+ * @param detail What the span worked on, such as a file.
+ */
+TraceRecorder::Span::Span(const char* name, string detail){
+    this->name = name;
+    active = enabled.load(memory_order_acquire);
+    if (!active) return;
+
+    this->detail = detail;
+    start = steady_clock::now();
+}
+
+/**
+ * Destructor. Adds the span to its thread's buffer.
+ */
+TraceRecorder::Span::~Span(){
+    if (!active || !enabled.load(memory_order_acquire)) return;
+
+    Event event;
+    event.name = name;
+    event.detail = move(detail);
+    event.start = start;
+    event.end = steady_clock::now();
+
+    Buffer* buffer = getBuffer();
+    lock_guard<mutex> lock(buffer->bufferMutex);
+    buffer->events.push_back(move(event));
+}
+
+/**
+ * Sets what the span worked on once it's known.
+ * @param detail What the span worked on.
+ */
+void TraceRecorder::Span::setDetail(string detail){
+    if (active) this->detail = detail;
+}
+
+/**
+ * Starts recording a new trace. Spans from an earlier trace are dropped.
+ */
+void TraceRecorder::start(){
+    lock_guard<mutex> lock(buffersMutex);
+    buffers.clear();
+    generation++;
+    origin = steady_clock::now();
+    enabled.store(true, memory_order_release);
+}
+
+/**
+ * Stops recording and writes the trace in the Chrome trace-event format.
+ * @param fileName The file to write.
+ * @return Whether the file was written.
+ */
+bool TraceRecorder::stop(string fileName){
+    enabled.store(false, memory_order_release);
+
+    ofstream output(fileName);
+    if (!output.is_open()) return false;
+
+    lock_guard<mutex> lock(buffersMutex);
+    int pid = (int) getpid();
+    bool first = true;
+    char times[64];
+
+    output << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    for (shared_ptr<Buffer>& buffer : buffers){
+        lock_guard<mutex> bufferLock(buffer->bufferMutex);
+
+        //Names the thread so the timeline has readable rows.
+        string threadName = (buffer->name.size() > 0) ? buffer->name : "thread " + to_string(buffer->tid);
+        output << ((first) ? "" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": " << pid
+               << ", \"tid\": " << buffer->tid << ", \"args\": {\"name\": \"" << escape(threadName) << "\"}}";
+        first = false;
+
+        //Times are in microseconds from the start of the trace.
+        for (Event& event : buffer->events){
+            double ts = duration_cast<duration<double, micro>>(event.start - origin).count();
+            double dur = duration_cast<duration<double, micro>>(event.end - event.start).count();
+            snprintf(times, sizeof(times), "\"ts\": %.3f, \"dur\": %.3f", ts, dur);
+
+            output << ",\n{\"name\": \"" << escape(event.name) << "\", \"cat\": \"clangex\", \"ph\": \"X\", " << times
+                   << ", \"pid\": " << pid << ", \"tid\": " << buffer->tid;
+            if (event.detail.size() > 0) output << ", \"args\": {\"detail\": \"" << escape(event.detail) << "\"}";
+            output << "}";
+        }
+    }
+    output << "\n]}\n";
+    buffers.clear();
+
+    output.close();
+    return !output.fail();
+}
+
+/**
+ * Checks whether a trace is being recorded.
+ * @return Whether spans are recorded.
+ */
+bool TraceRecorder::isEnabled(){
+    return enabled.load(memory_order_acquire);
+}
+
+/**
+ * Names the current thread in the trace.
+ * @param name The name of the thread.
+ */
+void TraceRecorder::nameThread(string name){
+    if (!isEnabled()) return;
+
+    Buffer* buffer = getBuffer();
+    lock_guard<mutex> lock(buffer->bufferMutex);
+    buffer->name = name;
+}
+
+/**
+ * Gets the current thread's buffer. Threads only take the shared lock the
+ * first time they record something in a trace.
+ * @return The buffer.
+ */
+TraceRecorder::Buffer* TraceRecorder::getBuffer(){
+    static thread_local shared_ptr<Buffer> local;
+    static thread_local int localGeneration = -1;
+
+    int curGeneration = generation.load();
+    if (!local || localGeneration != curGeneration){
+        lock_guard<mutex> lock(buffersMutex);
+        local = make_shared<Buffer>();
+        buffers.push_back(local);
+        local->tid = (int) buffers.size();
+        localGeneration = generation.load();
+    }
+
+    return local.get();
+}
+
+/**
+ * Escapes a string for JSON.
+ * @param value The string.
+ * @return The escaped string.
+ */
+string TraceRecorder::escape(const string& value){
+    string escaped;
+    char hex[8];
+    for (char cur : value){
+        if (cur == '"' || cur == '\\'){
+            escaped += '\\';
+            escaped += cur;
+        } else if ((unsigned char) cur < 0x20){
+            snprintf(hex, sizeof(hex), "\\u%04x", cur);
+            escaped += hex;
+        } else {
+            escaped += cur;
+        }
+    }
+
+    return escaped;
+}
@@ -0,0 +1,90 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// TraceRecorder.h
+//
+// Created By: Bryan J Muscedere
+// Date: 19/10/26.
+//
+// Records what each thread was doing during a run as a timeline of spans.
+// Each thread appends to its own buffer so recording stays cheap, and the
+// timeline is written in the Chrome trace-event format so it can be opened
+// in Perfetto or chrome://tracing.
+//
+// Copyright (C) 2017, Bryan J. Muscedere
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CLANGEX_TRACERECORDER_H
+#define CLANGEX_TRACERECORDER_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+class TraceRecorder {
+public:
+    /** Records A Block Of Code As A Span */
+    class Span {
+    public:
+        Span(const char* name, std::string detail = std::string());
+        ~Span();
+        void setDetail(std::string detail);
+
+    private:
+        const char* name;
+        std::string detail;
+        bool active;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    /** Recording */
+    static void start();
+    static bool stop(std::string fileName);
+    static bool isEnabled();
+    static void nameThread(std::string name);
+
+private:
+    /** A Finished Span */
+    struct Event {
+        const char* name;
+        std::string detail;
+        std::chrono::steady_clock::time_point start;
+        std::chrono::steady_clock::time_point end;
+    };
+
+    /** Spans Recorded By A Single Thread */
+    struct Buffer {
+        int tid = 0;
+        std::string name;
+        std::vector<Event> events;
+        std::mutex bufferMutex;
+    };
+
+    /** Private Variables */
+    static std::atomic<bool> enabled;
+    static std::atomic<int> generation;
+    static std::chrono::steady_clock::time_point origin;
+    static std::vector<std::shared_ptr<Buffer>> buffers;
+    static std::mutex buffersMutex;
+
+    /** Helper Methods */
+    static Buffer* getBuffer();
+    static std::string escape(const std::string& value);
+};
+
+
+#endif //CLANGEX_TRACERECORDER_H
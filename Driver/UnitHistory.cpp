@@ -0,0 +1,286 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// UnitHistory.cpp
+//
+// Created By: Bryan J Muscedere
+// Date: 19/10/26.
+//
+// Remembers how long each translation unit took to extract and how much
+// memory it needed. The history is used to plan parallel runs so the
+// longest units start first and memory-heavy units never run together.
+//
+// Copyright (C) 2017, Bryan J. Muscedere
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <deque>
+#include <unistd.h>
+#include "UnitHistory.h"
+
+using namespace std;
+using namespace std::chrono;
+namespace bs = boost::filesystem;
+
+/**
+ * Constructor. Sets up an empty history.
+ * @param historyFile The file the history is kept in.
+ */
+UnitHistory::UnitHistory(string historyFile){
+    this->historyFile = historyFile;
+}
+
+/**
+ * Destructor. Stops the sampler if it's still running.
+ */
+UnitHistory::~UnitHistory(){
+    stopSampling();
+}
+
+/**
+ * Loads the history from disk. Each line holds the seconds a unit took, its
+ * peak memory in bytes and its path.
+ * @return Whether a history was found.
+ */
+bool UnitHistory::load(){
+    ifstream input(historyFile);
+    if (!input.is_open()) return false;
+
+    lock_guard<mutex> lock(historyMutex);
+    string line;
+    while (getline(input, line)){
+        istringstream fields(line);
+        Cost cost;
+        string unit;
+        if (!(fields >> cost.seconds >> cost.peakBytes)) continue;
+
+        fields.get();
+        getline(fields, unit);
+        if (unit.size() > 0) costs[unit] = cost;
+    }
+
+    return true;
+}
+
+/**
+ * Saves the history to disk. The file is replaced atomically so a crash
+ * leaves either the old or the new history.
+ * @return Whether the history was saved.
+ */
+bool UnitHistory::save(){
+    string tempFile = historyFile + ".tmp";
+    ofstream output(tempFile);
+    if (!output.is_open()) return false;
+
+    lock_guard<mutex> lock(historyMutex);
+    for (auto it = costs.begin(); it != costs.end(); it++){
+        output << it->second.seconds << " " << it->second.peakBytes << " " << it->first << "\n";
+    }
+    output.close();
+    if (output.fail()) return false;
+
+    boost::system::error_code error;
+    bs::rename(tempFile, historyFile, error);
+    return !error;
+}
+
+/**
+ * Plans which worker walks which units, and in what order. Units are handed
+ * out longest first to whichever worker frees up first. A memory-heavy unit
+ * is only handed out once the last one is predicted to be done; until then
+ * the worker takes the longest light unit instead. Units with no history are
+ * costed by their size.
+ * @param files The units to walk.
+ * @param workers The number of workers.
+ * @param shareBytes Each worker's share of the memory budget.
+ * @return The units for each worker, in the order they should be walked.
+ */
+vector<vector<bs::path>> UnitHistory::schedule(const vector<bs::path>& files, int workers, size_t shareBytes){
+    lock_guard<mutex> lock(historyMutex);
+
+    //Works out how fast units are walked per byte and what a typical unit needs.
+    double knownSeconds = 0, knownBytes = 0;
+    vector<size_t> peaks;
+    vector<double> predicted(files.size());
+    vector<size_t> sizes(files.size());
+    for (int i = 0; i < files.size(); i++){
+        boost::system::error_code error;
+        sizes.at(i) = bs::file_size(files.at(i), error);
+        if (error) sizes.at(i) = 0;
+
+        auto cost = costs.find(getKey(files.at(i)));
+        if (cost == costs.end()) continue;
+        knownSeconds += cost->second.seconds;
+        knownBytes += sizes.at(i);
+        peaks.push_back(cost->second.peakBytes);
+    }
+    double secondsPerByte = (knownBytes > 0) ? knownSeconds / knownBytes : DEFAULT_SECONDS_PER_BYTE;
+    size_t medianPeak = 0;
+    if (peaks.size() > 0){
+        nth_element(peaks.begin(), peaks.begin() + peaks.size() / 2, peaks.end());
+        medianPeak = peaks.at(peaks.size() / 2);
+    }
+
+    //Heavy units need more than their share and stand out from the rest.
+    heavyUnits.clear();
+    deque<int> lightQueue, heavyQueue;
+    vector<int> order(files.size());
+    for (int i = 0; i < files.size(); i++){
+        order.at(i) = i;
+
+        auto cost = costs.find(getKey(files.at(i)));
+        predicted.at(i) = (cost == costs.end()) ? sizes.at(i) * secondsPerByte : cost->second.seconds;
+        if (cost != costs.end() && cost->second.peakBytes > shareBytes &&
+                cost->second.peakBytes > medianPeak * HEAVY_FACTOR) {
+            heavyUnits.insert(cost->first);
+        }
+    }
+    stable_sort(order.begin(), order.end(), [&predicted](int a, int b){ return predicted.at(a) > predicted.at(b); });
+    for (int i : order){
+        if (heavyUnits.count(getKey(files.at(i))) > 0) heavyQueue.push_back(i);
+        else lightQueue.push_back(i);
+    }
+
+    //Simulates the run, handing each worker the next unit as it frees up.
+    vector<vector<bs::path>> plan(workers);
+    vector<double> freeAt(workers, 0);
+    double heavyDoneAt = 0;
+    while (lightQueue.size() > 0 || heavyQueue.size() > 0){
+        int w = (int) (min_element(freeAt.begin(), freeAt.end()) - freeAt.begin());
+        double now = freeAt.at(w);
+
+        //Takes the longer of the next light unit and the next heavy unit that can start.
+        bool heavyReady = heavyQueue.size() > 0 && heavyDoneAt <= now;
+        bool takeHeavy = heavyReady && (lightQueue.size() == 0 ||
+                                        predicted.at(heavyQueue.front()) >= predicted.at(lightQueue.front()));
+        if (lightQueue.size() == 0 && !heavyReady) {
+            now = heavyDoneAt;
+            takeHeavy = true;
+        }
+
+        deque<int>& queue = (takeHeavy) ? heavyQueue : lightQueue;
+        int unit = queue.front();
+        queue.pop_front();
+
+        plan.at(w).push_back(files.at(unit));
+        freeAt.at(w) = now + predicted.at(unit);
+        if (takeHeavy) heavyDoneAt = freeAt.at(w);
+    }
+
+    return plan;
+}
+
+/**
+ * Checks whether the last schedule marked a unit as memory-heavy.
+ * @param unit The unit to check.
+ * @return Whether the unit is memory-heavy.
+ */
+bool UnitHistory::isHeavy(const bs::path& unit){
+    lock_guard<mutex> lock(historyMutex);
+    return heavyUnits.count(getKey(unit)) > 0;
+}
+
+/**
+ * Starts sampling memory use for units as they're walked.
+ * @param numSlots The number of units that can be walked at once.
+ */
+void UnitHistory::startSampling(int numSlots){
+    stopSampling();
+
+    unique_lock<mutex> lock(historyMutex);
+    slots = vector<Slot>(numSlots);
+    sampling = true;
+    sampler = thread([this](){
+        unique_lock<mutex> lock(historyMutex);
+        while (sampling){
+            lock.unlock();
+            size_t rss = currentRSS();
+            lock.lock();
+
+            for (Slot& slot : slots) if (slot.active) slot.peakBytes = max(slot.peakBytes, rss);
+            samplerWake.wait_for(lock, milliseconds(SAMPLE_MS));
+        }
+    });
+}
+
+/**
+ * Stops sampling memory use.
+ */
+void UnitHistory::stopSampling(){
+    {
+        lock_guard<mutex> lock(historyMutex);
+        if (!sampling) return;
+        sampling = false;
+    }
+
+    samplerWake.notify_all();
+    sampler.join();
+}
+
+/**
+ * Marks the start of a unit.
+ * @param slot The slot the unit is walked in.
+ */
+void UnitHistory::beginUnit(int slot){
+    size_t rss = currentRSS();
+
+    lock_guard<mutex> lock(historyMutex);
+    Slot& cur = slots.at(slot);
+    cur.active = true;
+    cur.start = steady_clock::now();
+    cur.baseBytes = rss;
+    cur.peakBytes = rss;
+}
+
+/**
+ * Marks the end of a unit and records its cost. Memory is sampled for the
+ * whole process, so units walked together share the blame for growth.
+ * @param slot The slot the unit was walked in.
+ * @param unit The unit that was walked.
+ */
+void UnitHistory::endUnit(int slot, const bs::path& unit){
+    size_t rss = currentRSS();
+
+    lock_guard<mutex> lock(historyMutex);
+    Slot& cur = slots.at(slot);
+    cur.active = false;
+
+    Cost cost;
+    cost.seconds = duration_cast<duration<double>>(steady_clock::now() - cur.start).count();
+    cost.peakBytes = max(cur.peakBytes, rss) - cur.baseBytes;
+    costs[getKey(unit)] = cost;
+}
+
+/**
+ * Gets the key a unit is stored under.
+ * @param unit The unit.
+ * @return Its absolute path.
+ */
+string UnitHistory::getKey(const bs::path& unit){
+    return bs::absolute(unit).string();
+}
+
+/**
+ * Gets how much memory the process currently holds.
+ * @return The resident set size in bytes.
+ */
+size_t UnitHistory::currentRSS(){
+    ifstream statm("/proc/self/statm");
+    size_t pages = 0, resident = 0;
+    if (!(statm >> pages >> resident)) return 0;
+
+    return resident * (size_t) sysconf(_SC_PAGESIZE);
+}
@@ -0,0 +1,99 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// UnitHistory.h
+//
+// Created By: Bryan J Muscedere
+// Date: 19/10/26.
+//
+// Remembers how long each translation unit took to extract and how much
+// memory it needed. The history is used to plan parallel runs so the
+// longest units start first and memory-heavy units never run together.
+//
+// Copyright (C) 2017, Bryan J. Muscedere
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CLANGEX_UNITHISTORY_H
+#define CLANGEX_UNITHISTORY_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <boost/filesystem.hpp>
+
+class UnitHistory {
+public:
+    /** Unit Costs */
+    struct Cost {
+        double seconds = 0;
+        size_t peakBytes = 0;
+    };
+
+    /** Constructor/Destructor */
+    UnitHistory(std::string historyFile);
+    ~UnitHistory();
+
+    /** History File */
+    bool load();
+    bool save();
+
+    /** Scheduling */
+    std::vector<std::vector<boost::filesystem::path>> schedule(const std::vector<boost::filesystem::path>& files,
+                                                              int workers, size_t shareBytes);
+    bool isHeavy(const boost::filesystem::path& unit);
+
+    /** Measurement */
+    void startSampling(int slots);
+    void stopSampling();
+    void beginUnit(int slot);
+    void endUnit(int slot, const boost::filesystem::path& unit);
+
+private:
+    /** Private Constants */
+    const int SAMPLE_MS = 20;
+    const size_t HEAVY_FACTOR = 4;
+    const double DEFAULT_SECONDS_PER_BYTE = 1e-6;
+
+    /** A Unit Being Measured */
+    struct Slot {
+        bool active = false;
+        std::chrono::steady_clock::time_point start;
+        size_t baseBytes = 0;
+        size_t peakBytes = 0;
+    };
+
+    /** Private Variables */
+    std::string historyFile;
+    std::unordered_map<std::string, Cost> costs;
+    std::unordered_set<std::string> heavyUnits;
+    std::mutex historyMutex;
+
+    /** Sampler */
+    std::vector<Slot> slots;
+    std::thread sampler;
+    bool sampling = false;
+    std::condition_variable samplerWake;
+
+    /** Helper Methods */
+    std::string getKey(const boost::filesystem::path& unit);
+    static size_t currentRSS();
+};
+
+
+#endif //CLANGEX_UNITHISTORY_H
@@ -37,6 +37,8 @@
 #include <boost/make_shared.hpp>
 #include <boost/algorithm/string.hpp>
 #include "ClangDriver.h"
+#include "ClangDaemon.h"
+#include "TraceRecorder.h"
 
 using namespace std;
 using namespace boost::filesystem;
@@ -59,6 +61,9 @@ const static string DISABLE_ARG = "disable";
 const static string SCRIPT_ARG = "script";
 const static string RECOVER_ARG = "recover";
 const static string OLOC_ARG = "outLoc";
+const static string MERGE_ARG = "merge";
+const static string FILTER_ARG = "filter";
+const static string WATCH_ARG = "watch";
 
 /** Const Strings */
 const string HELP_STRING = "Commands that can be used:\n"
@@ -71,7 +76,10 @@ const string HELP_STRING = "Commands that can be used:\n"
         "enable         : Enables a collection of language features.\n"
         "disable        : Disables a collection of language features.\n"
         "generate       : Runs ClangEx on loaded files.\n"
+        "watch          : Keeps a TA model up to date as loaded files change.\n"
         "output         : Outputs generated TA graphs to disk.\n"
+        "merge          : Merges TA models on disk into one model.\n"
+        "filter         : Filters a TA model on disk by relation or entity.\n"
         "recover        : Recovers a previous low-memory run.\n"
         "script         : Runs a script that handles program commands.\n"
         "outLoc         : Changes the output location for low memory mode.\n\n"
@@ -105,6 +113,19 @@ private:
 static map<string, ClangExHandler> helpInfo;
 static map<string, string> helpString;
 
+/** Default Watch Settings */
+const static int DEFAULT_DEBOUNCE_MS = 500;
+
+/** Daemon Arguments */
+const static string DAEMON_FLAG = "--daemon";
+const static string SEND_FLAG = "--send";
+const static string SOCKET_ENV = "CLANGEX_SOCKET";
+const static string DEFAULT_SOCKET = "ClangEx.sock";
+const static string RUNTIME_DIR_ENV = "XDG_RUNTIME_DIR";
+
+/** Default Sizes */
+const static size_t DEFAULT_MEM_BUDGET = (size_t) 1024 * 1024 * 1024;
+
 /** Program Files */
 bool changed = false;
 ClangDriver driver;
@@ -120,7 +141,7 @@ bool promptForAction(string promptText){
     bool loop = true;
     while (loop) {
         cout << promptText;
-        getline(cin, result);
+        if (!getline(cin, result)) return false;
 
         //Checks the value.
         if (result.compare("Y") == 0 || result.compare("y") == 0){
@@ -149,6 +170,59 @@ vector<string> tokenizeBySpace(string line){
     return result;
 }
 
+/**
+ * Parses a byte size such as 512M or 4G. Plain numbers are treated as bytes.
+ * @param size The size string to parse.
+ * @param bytes Set to the number of bytes.
+ * @return Whether the size was valid.
+ */
+bool parseByteSize(string size, size_t* bytes){
+    if (size.size() == 0) return false;
+
+    //Gets the multiplier.
+    size_t multiplier = 1;
+    char suffix = (char) toupper(size.back());
+    if (suffix == 'K') multiplier = 1024;
+    else if (suffix == 'M') multiplier = 1024 * 1024;
+    else if (suffix == 'G') multiplier = (size_t) 1024 * 1024 * 1024;
+    if (multiplier != 1 || suffix == 'B') size.pop_back();
+
+    //Parses the number.
+    if (size.size() == 0 || size.find_first_not_of("0123456789") != string::npos) return false;
+    try {
+        *bytes = (size_t) stoull(size) * multiplier;
+    } catch (exception& e) {
+        return false;
+    }
+
+    return *bytes > 0;
+}
+
+/**
+ * Starts recording a trace if the user asked for one.
+ * @param traceFile The trace file, or empty if there's no trace.
+ */
+void startTrace(string traceFile){
+    if (traceFile.compare(string()) == 0) return;
+
+    TraceRecorder::start();
+    TraceRecorder::nameThread("main");
+}
+
+/**
+ * Stops recording a trace and writes it.
+ * @param traceFile The trace file, or empty if there's no trace.
+ */
+void stopTrace(string traceFile){
+    if (traceFile.compare(string()) == 0) return;
+
+    if (!TraceRecorder::stop(traceFile)){
+        cerr << "Error writing to " << traceFile << "!" << endl;
+    } else {
+        cout << "Trace written to " << traceFile << "." << endl;
+    }
+}
+
 /**
  * Creates an argv array for use with command processing.
  * @param tokens The tokens to create.
@@ -186,12 +260,15 @@ void generateCommandSystem(map<string, ClangExHandler>* helpMap, map<string, str
     (*helpMap)[ADD_ARG] = ClangExHandler(ADD_ARG, po::options_description("Options"));
     helpMap->at(ADD_ARG).desc->add_options()
             ("help,h", "Print help message for add.")
-            ("source,s", po::value<std::vector<std::string>>(), "A file or directory to add to the current graph.");
+            ("source,s", po::value<std::vector<std::string>>(), "A file or directory to add to the current graph.")
+            ("compdb,c", po::value<std::string>(), "A compilation database to take the files and their flags from.");
     ss.str(string());
     ss << *helpMap->at(ADD_ARG).desc;
-    (*helpString)[ADD_ARG] = string("Add Help\nUsage: " + ADD_ARG + " source\nAdds files or directories to process."
-            "By adding directories, Rex will recursively\nsearch for source files starting from the root. For"
-            " files\nyou can specify any file you want and Rex will add it to the project.\n\n" + ss.str());
+    (*helpString)[ADD_ARG] = string("Add Help\nUsage: " + ADD_ARG + " source | --compdb database\nAdds files or "
+            "directories to process. By adding directories, Rex will recursively\nsearch for source files starting "
+            "from the root. If a compile_commands.json covers the\ndirectory, its files are added instead. For"
+            " files\nyou can specify any file you want and Rex will add it to the project. With --compdb, every\n"
+            "file in the database is added and compiled with its flags.\n\n" + ss.str());
 
     //Generate the help for remove.
     (*helpMap)[REMOVE_ARG] = ClangExHandler(REMOVE_ARG, po::options_description("Options"));
@@ -246,6 +323,13 @@ void generateCommandSystem(map<string, ClangExHandler>* helpMap, map<string, str
             ("help,h", "Print help message for generate.")
             ("blob,b", "Runs ClangEx in blob mode.")
             ("low,l", "Enables low-memory mode.")
+            ("mem-budget,m", po::value<std::string>(), "Memory low-memory mode can use before spilling to disk "
+                    "(e.g. 512M, 8G). Defaults to 1G.")
+            ("jobs,j", po::value<int>(), "Number of workers low-memory mode runs in parallel. The memory budget is "
+                    "split between them. Defaults to 1.")
+            ("profile-matchers", "Times each AST matcher and prints them from most to least expensive.")
+            ("trace", po::value<std::string>(), "Records what each thread does to a Chrome trace-event file "
+                    "that can be opened in Perfetto or chrome://tracing.")
             ("initial,i", po::value<std::string>(), "An initial TA file to load in to merge.");
     ss.str(string());
     ss << *helpMap->at(GEN_ARG).desc;
@@ -253,6 +337,22 @@ void generateCommandSystem(map<string, ClangExHandler>* helpMap, map<string, str
             " C/C++ source files.\nYou must have at least 1 source file in the queue for the graph to be generated.\n"
             "Additionally, in the root directory, there must a \"compile_commands.json\" file.\n\n" + ss.str());
 
+    //Generate the help for watch.
+    (*helpMap)[WATCH_ARG] = ClangExHandler(WATCH_ARG, po::options_description("Options"));
+    helpMap->at(WATCH_ARG).desc->add_options()
+            ("help,h", "Print help message for watch.")
+            ("blob,b", "Runs ClangEx in blob mode.")
+            ("output,o", po::value<std::string>(), "The TA file to keep up to date.")
+            ("debounce,d", po::value<int>(), "Milliseconds changes must settle for before they are applied. "
+                    "Defaults to 500.")
+            ("timeout,t", po::value<int>(), "Stops watching after this many seconds without a change.");
+    ss.str(string());
+    ss << *helpMap->at(WATCH_ARG).desc;
+    (*helpString)[WATCH_ARG] = string("Watch Help\nUsage: " + WATCH_ARG + " [options] -o outputFile\nExtracts the"
+            " files in the queue and then watches the directories they were\nadded from. When files change, only"
+            " the translation units that use them\nare extracted again and the TA file is rewritten in place."
+            " Press enter to\nstop. The model is then kept as a graph like one from generate.\n\n" + ss.str());
+
     //Generate the help for recover.
     (*helpMap)[RECOVER_ARG] = ClangExHandler(RECOVER_ARG, po::options_description("Options"));
     helpMap->at(RECOVER_ARG).desc->add_options()
@@ -270,6 +370,9 @@ void generateCommandSystem(map<string, ClangExHandler>* helpMap, map<string, str
     helpMap->at(OUT_ARG).desc->add_options()
             ("help,h", "Print help message for output.")
             ("select,s", po::value<std::string>(), "Only outputs select graphs based on their number.")
+            ("stats", "Also writes where each run spent its time to a .stats.json file beside its model.")
+            ("trace", po::value<std::string>(), "Records what each thread does to a Chrome trace-event file "
+                    "that can be opened in Perfetto or chrome://tracing.")
             ("outputFile", po::value<std::vector<std::string>>(), "The base file name to save.");
     ss.str(string());
     ss << *helpMap->at(OUT_ARG).desc;
@@ -277,6 +380,37 @@ void generateCommandSystem(map<string, ClangExHandler>* helpMap, map<string, str
             " graphs to a tuple-attribute (TA) file based on the\nClangEx schema. These models can then be used"
             " by other programs.\n\n" + ss.str());
 
+    //Generate the help for merge.
+    (*helpMap)[MERGE_ARG] = ClangExHandler(MERGE_ARG, po::options_description("Options"));
+    helpMap->at(MERGE_ARG).desc->add_options()
+            ("help,h", "Print help message for merge.")
+            ("output,o", po::value<std::string>(), "The TA file to write the merged model to.")
+            ("mem-budget,m", po::value<std::string>(), "Memory the merge can use (e.g. 512M, 4G). Defaults to 1G.")
+            ("temp,t", po::value<std::string>(), "Directory for temporary sort files.")
+            ("models", po::value<std::vector<std::string>>(), "The TA models to merge.");
+    ss.str(string());
+    ss << *helpMap->at(MERGE_ARG).desc;
+    (*helpString)[MERGE_ARG] = string("Merge Help\nUsage: " + MERGE_ARG + " [options] -o outputFile models...\n"
+            "Merges TA models on disk into a single TA model. Instances are deduplicated,\nrelations are combined"
+            " and relations that point to unknown instances are dropped.\nAttributes for the same item are combined."
+            " The merge sorts on disk so it\nstays within the memory budget.\n\n" + ss.str());
+
+    //Generate the help for filter.
+    (*helpMap)[FILTER_ARG] = ClangExHandler(FILTER_ARG, po::options_description("Options"));
+    helpMap->at(FILTER_ARG).desc->add_options()
+            ("help,h", "Print help message for filter.")
+            ("output,o", po::value<std::string>(), "The TA file to write the filtered model to.")
+            ("relation,r", po::value<std::vector<std::string>>(), "A relation type to keep (e.g. call).")
+            ("entity,e", po::value<std::vector<std::string>>(), "An entity type to keep (e.g. cFunction).")
+            ("ids,i", po::value<std::string>(), "A file with the entity IDs to keep, one per line.")
+            ("model", po::value<std::vector<std::string>>(), "The TA model to filter.");
+    ss.str(string());
+    ss << *helpMap->at(FILTER_ARG).desc;
+    (*helpString)[FILTER_ARG] = string("Filter Help\nUsage: " + FILTER_ARG + " [options] -o outputFile model\n"
+            "Filters a TA model on disk without loading it into a graph. Only the chosen\nrelation types are kept."
+            " When entity types or IDs are given, only those\nentities are kept along with the relations between"
+            " them.\n\n" + ss.str());
+
     //Generate the help for outLoc.
     (*helpMap)[OLOC_ARG] = ClangExHandler(OLOC_ARG, po::options_description("Options"));
     helpMap->at(OLOC_ARG).desc->add_options()
@@ -345,7 +479,7 @@ bool processQuit(string line){
 
     //Ask the user if they want to act.
     bool result = promptForAction("There are still items to be processed. Are you sure you want to quit (Y/N): ");
-    if (!result) driver.cleanup();
+    if (result) driver.cleanup();
 
     return !result;
 }
@@ -364,6 +498,22 @@ void processAdd(string line){
         return;
     }
 
+    //Adds the files from a compilation database.
+    if (tokens.at(1) == "--compdb" || tokens.at(1) == "-c"){
+        if (tokens.size() != 3) {
+            cerr << "Error: You must include a single compilation database to add." << endl;
+            return;
+        }
+
+        int numAdded = driver.addCompilationDatabase(tokens.at(2));
+        if (numAdded < 0) return;
+
+        changed = true;
+        cout << numAdded << " source files were added from the compilation database "
+             << path(tokens.at(2)).filename() << "!" << endl;
+        return;
+    }
+
     //Next, we loop through to add these files.
     for (int i = 1; i < tokens.size(); i++){
         path curPath = tokens.at((unsigned int) i);
@@ -584,6 +734,10 @@ void processGenerate(string line, po::options_description desc){
     bool blobMode = false;
     string mergeFile = "";
     bool lowMemory = false;
+    size_t memBudget = DEFAULT_MEM_BUDGET;
+    int numWorkers = 1;
+    bool profileMatchers = false;
+    string traceFile = "";
     po::variables_map vm;
     try {
         po::store(po::parse_command_line(argc, (const char *const *) argv, desc), vm);
@@ -605,6 +759,24 @@ void processGenerate(string line, po::options_description desc){
         if (vm.count("low")){
             lowMemory = true;
         }
+        if (vm.count("mem-budget") && !parseByteSize(vm["mem-budget"].as<std::string>(), &memBudget)){
+            throw po::error("The --mem-budget argument must be a size like 512M or 8G.");
+        }
+        if (vm.count("jobs")){
+            numWorkers = vm["jobs"].as<int>();
+            if (numWorkers < 1) throw po::error("The --jobs argument must be at least 1.");
+        }
+        if (vm.count("profile-matchers")){
+            profileMatchers = true;
+        }
+        if (vm.count("trace")){
+            traceFile = vm["trace"].as<std::string>();
+        }
+
+        //The initial model is held in memory, so it can't be merged in low memory mode.
+        if (lowMemory && mergeFile.compare("") != 0){
+            throw po::error("The --low and --initial arguments can't be used together.");
+        }
     } catch(po::error& e) {
         cerr << "Error: " << e.what() << endl;
         cerr << desc;
@@ -622,7 +794,12 @@ void processGenerate(string line, po::options_description desc){
 
     //Next, tells ClangEx to generate them.
     cout << "Processing " << numFiles << " file(s)..." << endl << "This may take some time!" << endl << endl;
+    driver.setMemBudget(memBudget);
+    driver.setNumWorkers(numWorkers);
+    driver.setProfileMatchers(profileMatchers);
+    startTrace(traceFile);
     bool success = driver.processAllFiles(blobMode, mergeFile, lowMemory);
+    stopTrace(traceFile);
 
     //Checks the success of the operation.
     if (success) {
@@ -635,6 +812,76 @@ void processGenerate(string line, po::options_description desc){
     delete[] argv;
 }
 
+/**
+ * Processes the watch option. Keeps a TA file up to date as files change.
+ * @param line The line entered.
+ * @param desc The options configured.
+ */
+void processWatch(string line, po::options_description desc){
+    //Generates the arguments.
+    vector<string> tokens = tokenizeBySpace(line);
+    char** argv = createArgv(tokens);
+    int argc = (int) tokens.size();
+
+    bool blobMode = false;
+    string outputFile = "";
+    int debounceMS = DEFAULT_DEBOUNCE_MS;
+    int timeoutSec = -1;
+    po::variables_map vm;
+    try {
+        po::store(po::parse_command_line(argc, (const char *const *) argv, desc), vm);
+
+        //Checks if help was enabled.
+        if (vm.count("help")) {
+            cout << "Usage: watch [options] -o outputFile" << endl << desc;
+            for (int i = 0; i < argc; i++) delete[] argv[i];
+            delete[] argv;
+            return;
+        }
+
+        //Sets up the watch.
+        if (vm.count("blob")){
+            blobMode = true;
+        }
+        if (!vm.count("output")) throw po::error("No output file was supplied!");
+        outputFile = vm["output"].as<std::string>();
+        if (vm.count("debounce")){
+            debounceMS = vm["debounce"].as<int>();
+            if (debounceMS < 0) throw po::error("The --debounce argument can't be negative.");
+        }
+        if (vm.count("timeout")){
+            timeoutSec = vm["timeout"].as<int>();
+            if (timeoutSec < 1) throw po::error("The --timeout argument must be at least 1.");
+        }
+    } catch(po::error& e) {
+        cerr << "Error: " << e.what() << endl;
+        cerr << desc;
+        for (int i = 0; i < argc; i++) delete[] argv[i];
+        delete[] argv;
+        return;
+    }
+
+    //Checks whether we can watch.
+    int numFiles = driver.getNumFiles();
+    if (numFiles == 0) {
+        cerr << "No files are in the queue to be processed. Add some before you continue." << endl;
+        for (int i = 0; i < argc; i++) delete[] argv[i];
+        delete[] argv;
+        return;
+    }
+
+    //Next, tells ClangEx to watch them.
+    cout << "Processing " << numFiles << " file(s)..." << endl << "This may take some time!" << endl << endl;
+    bool success = driver.watchFiles(blobMode, outputFile, debounceMS, timeoutSec);
+    if (success) {
+        cout << "Stopped watching. The model is graph #" << driver.getNumGraphs() - 1 << "." << endl;
+        changed = true;
+    }
+
+    for (int i = 0; i < argc; i++) delete[] argv[i];
+    delete[] argv;
+}
+
 /**
  * Processes the output option.
  * @param line The line entered.
@@ -708,15 +955,18 @@ void processOutput(string line, po::options_description desc){
 
     vector<string> outputVec = vm["outputFile"].as<std::vector<std::string>>();
     string output = outputVec.at(0);
+    bool writeStats = vm.count("stats") > 0;
+    string traceFile = (vm.count("trace")) ? vm["trace"].as<std::string>() : string();
     bool success = false;
+    startTrace(traceFile);
 
     //Now, outputs the graphs.
     if (outputValues.compare(string()) == 0){
         //We output all the graphs.
         if (driver.getNumGraphs() == 1){
-            success = driver.outputIndividualModel(0, output);
+            success = driver.outputIndividualModel(0, output, writeStats);
         } else {
-            success = driver.outputAllModels(output);
+            success = driver.outputAllModels(output, writeStats);
         }
     } else {
         //We selectively output the graphs.
@@ -724,14 +974,16 @@ void processOutput(string line, po::options_description desc){
             if (indexNum < 0 || indexNum >= driver.getNumGraphs()){
                 cerr << "Error: There are only " << driver.getNumGraphs()
                      << " graphs! " << indexNum << " is out of bounds." << endl;
+                stopTrace(traceFile);
                 for (int i = 0; i < argc; i++) delete[] argv[i];
                 delete[] argv;
                 return;
             }
 
-            success = driver.outputIndividualModel(indexNum, output);
+            success = driver.outputIndividualModel(indexNum, output, writeStats);
         }
     }
+    stopTrace(traceFile);
 
     if (!success) {
         cerr << "There was an error outputting all graphs to TA models." << endl;
@@ -744,6 +996,136 @@ void processOutput(string line, po::options_description desc){
     delete[] argv;
 }
 
+/**
+ * Processes the merge option. Merges TA models on disk.
+ * @param line The line entered.
+ * @param desc The options configured.
+ */
+void processMerge(string line, po::options_description desc){
+    //Generates the arguments.
+    vector<string> tokens = tokenizeBySpace(line);
+    char** argv = createArgv(tokens);
+    int argc = (int) tokens.size();
+
+    //Processes the command line args.
+    po::positional_options_description positionalOptions;
+    positionalOptions.add("models", -1);
+
+    po::variables_map vm;
+    vector<string> models;
+    string output;
+    string tempDir;
+    size_t memBudget = DEFAULT_MEM_BUDGET;
+    try {
+        po::store(po::command_line_parser(argc, (const char* const*) argv).options(desc)
+                          .positional(positionalOptions).run(), vm);
+        po::notify(vm);
+
+        if (vm.count("help")) {
+            cout << "Usage: merge [options] -o outputFile models..." << endl << desc;
+            for (int i = 0; i < argc; i++) delete[] argv[i];
+            delete[] argv;
+            return;
+        }
+
+        //Gets the models and output.
+        if (!vm.count("models")) throw po::error("You must specify at least one TA model to merge!");
+        if (!vm.count("output")) throw po::error("You must specify an output file with --output!");
+        models = vm["models"].as<std::vector<std::string>>();
+        output = vm["output"].as<std::string>();
+
+        //Gets the optional settings.
+        if (vm.count("mem-budget") && !parseByteSize(vm["mem-budget"].as<std::string>(), &memBudget)){
+            throw po::error("The --mem-budget argument must be a size like 512M or 4G.");
+        }
+        if (vm.count("temp")) tempDir = vm["temp"].as<std::string>();
+    } catch(po::error& e) {
+        cerr << "Error: " << e.what() << endl;
+        cerr << desc;
+        for (int i = 0; i < argc; i++) delete[] argv[i];
+        delete[] argv;
+        return;
+    }
+
+    //Runs the merge.
+    cout << "Merging " << models.size() << " TA model(s)..." << endl << "This may take some time!" << endl << endl;
+    bool success = driver.mergeModels(models, output, memBudget, tempDir);
+    if (!success) {
+        cerr << "There was an error merging the TA models." << endl;
+    } else {
+        cout << "Merged TA model written to " << output << "!" << endl;
+    }
+
+    for (int i = 0; i < argc; i++) delete[] argv[i];
+    delete[] argv;
+}
+
+/**
+ * Processes the filter option. Filters a TA model on disk.
+ * @param line The line entered.
+ * @param desc The options configured.
+ */
+void processFilter(string line, po::options_description desc){
+    //Generates the arguments.
+    vector<string> tokens = tokenizeBySpace(line);
+    char** argv = createArgv(tokens);
+    int argc = (int) tokens.size();
+
+    //Processes the command line args.
+    po::positional_options_description positionalOptions;
+    positionalOptions.add("model", 1);
+
+    po::variables_map vm;
+    string model;
+    string output;
+    string idFile;
+    vector<string> relations;
+    vector<string> entityTypes;
+    try {
+        po::store(po::command_line_parser(argc, (const char* const*) argv).options(desc)
+                          .positional(positionalOptions).run(), vm);
+        po::notify(vm);
+
+        if (vm.count("help")) {
+            cout << "Usage: filter [options] -o outputFile model" << endl << desc;
+            for (int i = 0; i < argc; i++) delete[] argv[i];
+            delete[] argv;
+            return;
+        }
+
+        //Gets the model and output.
+        if (!vm.count("model")) throw po::error("You must specify a TA model to filter!");
+        if (!vm.count("output")) throw po::error("You must specify an output file with --output!");
+        model = vm["model"].as<std::vector<std::string>>().at(0);
+        output = vm["output"].as<std::string>();
+
+        //Gets what to keep.
+        if (vm.count("relation")) relations = vm["relation"].as<std::vector<std::string>>();
+        if (vm.count("entity")) entityTypes = vm["entity"].as<std::vector<std::string>>();
+        if (vm.count("ids")) idFile = vm["ids"].as<std::string>();
+        if (relations.size() == 0 && entityTypes.size() == 0 && idFile.compare("") == 0){
+            throw po::error("You must specify at least one of --relation, --entity or --ids!");
+        }
+    } catch(po::error& e) {
+        cerr << "Error: " << e.what() << endl;
+        cerr << desc;
+        for (int i = 0; i < argc; i++) delete[] argv[i];
+        delete[] argv;
+        return;
+    }
+
+    //Runs the filter.
+    bool success = driver.filterModel(model, output, relations, entityTypes, idFile);
+    if (!success) {
+        cerr << "There was an error filtering the TA model." << endl;
+    } else {
+        cout << "Filtered TA model written to " << output << "!" << endl;
+    }
+
+    for (int i = 0; i < argc; i++) delete[] argv[i];
+    delete[] argv;
+}
+
 /**
  * Processes the script option. Runs a script on the program.
  * @param line The line entered.
@@ -925,9 +1307,18 @@ bool processCommand(string line) {
     } else if (!line.compare(0, GEN_ARG.size(), GEN_ARG) &&
                (line[GEN_ARG.size()] == ' ' || line.size() == GEN_ARG.size())) {
         processGenerate(line, *(helpInfo.at(GEN_ARG).desc.get()));
+    } else if (!line.compare(0, WATCH_ARG.size(), WATCH_ARG) &&
+               (line[WATCH_ARG.size()] == ' ' || line.size() == WATCH_ARG.size())) {
+        processWatch(line, *(helpInfo.at(WATCH_ARG).desc.get()));
     } else if (!line.compare(0, OUT_ARG.size(), OUT_ARG) &&
                (line[OUT_ARG.size()] == ' ' || line.size() == OUT_ARG.size())) {
         processOutput(line, *(helpInfo.at(OUT_ARG).desc.get()));
+    } else if (!line.compare(0, MERGE_ARG.size(), MERGE_ARG) &&
+               (line[MERGE_ARG.size()] == ' ' || line.size() == MERGE_ARG.size())) {
+        processMerge(line, *(helpInfo.at(MERGE_ARG).desc.get()));
+    } else if (!line.compare(0, FILTER_ARG.size(), FILTER_ARG) &&
+               (line[FILTER_ARG.size()] == ' ' || line.size() == FILTER_ARG.size())) {
+        processFilter(line, *(helpInfo.at(FILTER_ARG).desc.get()));
     } else if (!line.compare(0, SCRIPT_ARG.size(), SCRIPT_ARG) &&
                (line[SCRIPT_ARG.size()] == ' ' || line.size() == SCRIPT_ARG.size())) {
         processScript(line, *(helpInfo.at(SCRIPT_ARG).desc.get()));
@@ -944,6 +1335,18 @@ bool processCommand(string line) {
     return true;
 }
 
+/**
+ * Gets where the daemon listens by default. The socket is per user and doesn't
+ * depend on the working directory, so clients anywhere can find it.
+ * @return The absolute path of the socket.
+ */
+string getDefaultSocket(){
+    const char* runtimeDir = getenv(RUNTIME_DIR_ENV.c_str());
+    if (runtimeDir && runtimeDir[0] == '/') return string(runtimeDir) + "/" + DEFAULT_SOCKET;
+
+    return "/tmp/" + to_string(getuid()) + "-" + DEFAULT_SOCKET;
+}
+
 /**
  * The main method. Drives the entire program.
  * @param argc The number of arguments.
@@ -951,12 +1354,21 @@ bool processCommand(string line) {
  * @return Status code.
  */
 int main(int argc, const char **argv){
+    //Checks for a daemon to talk to.
+    string socketPath = (getenv(SOCKET_ENV.c_str())) ? getenv(SOCKET_ENV.c_str()) : getDefaultSocket();
+    if (argc > 1 && SEND_FLAG.compare(argv[1]) == 0){
+        return ClangDaemon::sendCommands(socketPath, vector<string>(argv + 2, argv + argc));
+    }
+
     //Starts by printing the header.
     printHeader();
 
     //Checks if we have arguments.
-    if (argc > 1){
-        cerr << "Run " << argv[0] << " with no arguments!" << endl;
+    bool daemonMode = argc > 1 && DAEMON_FLAG.compare(argv[1]) == 0;
+    if (daemonMode && argc > 2) socketPath = argv[2];
+    if ((argc > 1 && !daemonMode) || argc > 3){
+        cerr << "Run " << argv[0] << " with no arguments, " << DAEMON_FLAG << " [socket] or " << SEND_FLAG
+             << " commands..." << endl;
         return 1;
     }
 
@@ -974,6 +1386,16 @@ int main(int argc, const char **argv){
     //Initializes the help system.
     generateCommandSystem(&helpInfo, &helpString);
 
+    //Serves commands from clients instead of the prompt.
+    if (daemonMode){
+        ClangDaemon daemon(socketPath);
+        if (!daemon.start()) return 1;
+
+        cout << "ClangEx daemon listening on " << socketPath << "." << endl;
+        daemon.serve(processCommand);
+        return 0;
+    }
+
     //Initiates main loop.
     string line;
     bool contLoop = true;
@@ -33,7 +33,16 @@ using namespace std;
 /**
  * Constructor. Creates a default file parse object.
  */
-FileParse::FileParse() {}
+FileParse::FileParse() {
+    //The root of the trie sits above the first path component.
+    PathNode root;
+    root.parent = -1;
+    root.label = -1;
+    root.depth = -1;
+    root.isFile = false;
+    root.isPath = false;
+    trie.push_back(root);
+}
 
 /**
  * Destructor. Destroys the file parse object.
@@ -41,117 +50,126 @@ FileParse::FileParse() {}
 FileParse::~FileParse() {}
 
 /**
- * Adds a singular file to the list.
+ * Adds a singular file to the list. Each path component becomes a node in
+ * the trie, so shared directories are only stored once.
  * @param path The path to add.
  */
 void FileParse::addPath(string path) {
-    //Check if path already exists.
-    for (int i = 0; i < paths.size(); i++) {
-        if (paths.at(i).compare(path) == 0) return;
+    //Walks down the trie, adding components as needed.
+    int node = 0;
+    boost::filesystem::path filePath = boost::filesystem::path(path);
+    for (auto it = filePath.begin(); it != filePath.end();){
+        string label = it->string();
+        it++;
+        node = getChild(node, label, it == filePath.end());
     }
 
-    //Add it to the vector if it doesn't.
-    paths.push_back(path);
+    //Remembers the path if it's new.
+    if (node == 0 || trie.at(node).isPath) return;
+    trie.at(node).isPath = true;
+    pathEnds.push_back(node);
 }
 
 /**
  * Creates nodes and edges for every single path that was added to the list.
+ * Nodes are stored in the order they were created and each one has a single
+ * parent, so everything is created in one pass.
  * @param nodes The created nodes. (Should be empty on invocation).
  * @param edges The created edges. (Should be empty on invocation).
+ * @param files The created file nodes, keyed by their full path.
  */
-void FileParse::processPaths(vector<ClangNode*>& nodes, vector<ClangEdge*>& edges) {
-    //Iterate through all the paths.
-    for (int i = 0; i < paths.size(); i++){
-        processPath(paths.at(i), nodes, edges);
+void FileParse::processPaths(vector<ClangNode*>& nodes, vector<ClangEdge*>& edges,
+                             unordered_map<string, ClangNode*>& files) {
+    vector<string> fullPaths(trie.size());
+    vector<ClangNode*> created(trie.size(), nullptr);
+
+    for (int i = 1; i < trie.size(); i++){
+        const PathNode& cur = trie.at(i);
+        fullPaths.at(i) = getFullPath(fullPaths.at(cur.parent), i);
+
+        //Creates the node.
+        ClangNode::NodeType type = (cur.isFile) ? ClangNode::FILE : ClangNode::SUBSYSTEM;
+        created.at(i) = new ClangNode(ASTWalker::generateMD5(fullPaths.at(i)), labels.at(cur.label), type);
+        nodes.push_back(created.at(i));
+        if (cur.isFile) files[fullPaths.at(i)] = created.at(i);
+
+        //Links it to its parent.
+        if (cur.parent != 0) edges.push_back(new ClangEdge(created.at(cur.parent), created.at(i), ClangEdge::CONTAINS));
     }
 }
 
 /**
- * Processes an individual path in the path list. Creates the associated nodes
- * and edges.
- * @param path The path to create.
- * @param curPath The set of created nodes.
- * @param curContains The set of created edges.
+ * Gets every path that was added to the list.
+ * @return The paths.
  */
-void FileParse::processPath(string path, vector<ClangNode*>& curPath, vector<ClangEdge*>& curContains) {
-    //Start by iterating at each path element.
-    vector<string> pathComponents = vector<string>();
-    vector<string> pathLabels = vector<string>();
-    int i = 0;
-    for (auto& curr : boost::filesystem::path(path)){
-        if (i == 0) {
-            pathComponents.push_back(curr.string());
-        } else {
-            string craft = (i == 1) ? "" : "/";
-            pathComponents.push_back(pathComponents.at(i - 1) + craft + curr.string());
-        }
-
-        pathLabels.push_back(curr.string());
-        i++;
+vector<string> FileParse::getPaths() {
+    vector<string> paths;
+    for (int end : pathEnds){
+        //Collects the components from the end of the path.
+        vector<int> chain;
+        for (int node = end; node != 0; node = trie.at(node).parent) chain.push_back(node);
+
+        string fullPath;
+        for (auto it = chain.rbegin(); it != chain.rend(); it++) fullPath = getFullPath(fullPath, *it);
+        paths.push_back(fullPath);
     }
 
-    //Next, we iterate until we hit the end.
-    ClangNode* prevNode = nullptr;
-    for (int i = 0; i < pathComponents.size(); i++){
-        ClangNode* currentNode;
-
-        //Check if a path component exists.
-        int existsIndex = doesNodeExist(ASTWalker::generateMD5(pathComponents.at(i)), curPath);
-        if (existsIndex == -1){
-            //Determines the type of node.
-            ClangNode::NodeType type;
-            if (i + 1 == pathComponents.size()){
-                type = ClangNode::FILE;
-            } else {
-                type = ClangNode::SUBSYSTEM;
-            }
-
-            //Creates the node.
-            string current = ASTWalker::generateMD5(pathComponents.at(i));
-            currentNode = new ClangNode(current, pathLabels.at(i), type);
-            curPath.push_back(currentNode);
-        } else {
-            currentNode = curPath.at(existsIndex);
-        }
-
-        //Next, deals with contains.
-        if (prevNode != nullptr && !doesEdgeExist(prevNode, currentNode, curContains)){
-            //Adds a new link.
-            curContains.push_back(new ClangEdge(prevNode, currentNode, ClangEdge::CONTAINS));
-        }
-
-        prevNode = currentNode;
-    }
+    return paths;
 }
 
 /**
- * Checks if a node already exists in the associated list.
- * @param ID The ID to check for.
- * @param nodes The list of nodes to check in.
- * @return Index of where the node is in the list.
+ * Gets the ID of a path component, adding it if it's new.
+ * @param label The component.
+ * @return The ID of the component.
  */
-int FileParse::doesNodeExist(string ID, const vector<ClangNode*>& nodes){
-    //Iterates through and checks.
-    for (int i = 0; i < nodes.size(); i++){
-        ClangNode* curNode = nodes.at(i);
-        if (curNode->getID().compare(ID) == 0) return i;
-    }
+int FileParse::internLabel(const string& label) {
+    auto it = labelIDs.find(label);
+    if (it != labelIDs.end()) return it->second;
+
+    int ID = (int) labels.size();
+    labels.push_back(label);
+    labelIDs[label] = ID;
+    return ID;
+}
 
-    return -1;
+/**
+ * Gets a child of a trie node, creating it if it doesn't exist. A node keeps
+ * the type it was created with.
+ * @param parent The parent node.
+ * @param label The path component.
+ * @param isFile Whether the component ends the path being added.
+ * @return The child node.
+ */
+int FileParse::getChild(int parent, const string& label, bool isFile) {
+    int labelID = internLabel(label);
+    auto it = trie.at(parent).children.find(labelID);
+    if (it != trie.at(parent).children.end()) return it->second;
+
+    //Creates the node.
+    PathNode child;
+    child.parent = parent;
+    child.label = labelID;
+    child.depth = trie.at(parent).depth + 1;
+    child.isFile = isFile;
+    child.isPath = false;
+
+    int childID = (int) trie.size();
+    trie.at(parent).children[labelID] = childID;
+    trie.push_back(child);
+    return childID;
 }
 
 /**
- * Checks if an edge already exists in the associated list.
- * @param src The source ID.
- * @param dst The destination ID.
- * @param edges The edge list to check in.
- * @return The index of where the node is in the list.
+ * Builds the full path of a trie node from its parent's path.
+ * @param parentPath The full path of the parent.
+ * @param node The node.
+ * @return The full path.
  */
-bool FileParse::doesEdgeExist(ClangNode* src, ClangNode* dst, const vector<ClangEdge*>& edges){
-    //Iterates through and checks.
-    for (auto curEdge : edges){
-        if (curEdge->getSrc() == src && curEdge->getDst() == dst) return true;
-    }
+string FileParse::getFullPath(const string& parentPath, int node) {
+    const PathNode& cur = trie.at(node);
+    if (cur.depth == 0) return labels.at(cur.label);
 
-    return false;
+    //The root component already ends in a separator.
+    string craft = (cur.depth == 1) ? "" : "/";
+    return parentPath + craft + labels.at(cur.label);
 }
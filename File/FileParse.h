@@ -29,6 +29,7 @@
 
 #include <string>
 #include <vector>
+#include <unordered_map>
 #include "../Graph/ClangNode.h"
 #include "../Graph/ClangEdge.h"
 
@@ -40,19 +41,31 @@ public:
 
     /** Path Creation Operations */
     void addPath(std::string path);
-    void processPaths(std::vector<ClangNode*>& nodes, std::vector<ClangEdge*>& edges);
+    void processPaths(std::vector<ClangNode*>& nodes, std::vector<ClangEdge*>& edges,
+                      std::unordered_map<std::string, ClangNode*>& files);
+    std::vector<std::string> getPaths();
 
 private:
+    /** Path Trie Node */
+    typedef struct {
+        int parent;
+        int label;
+        int depth;
+        bool isFile;
+        bool isPath;
+        std::unordered_map<int, int> children;
+    } PathNode;
+
     /** Member Variables */
-    std::vector<std::string> paths;
+    std::vector<PathNode> trie;
+    std::vector<int> pathEnds;
+    std::vector<std::string> labels;
+    std::unordered_map<std::string, int> labelIDs;
 
     /** Helper Methods */
-    void processPath(std::string path, std::vector<ClangNode*>& curPath,
-                     std::vector<ClangEdge*>& curContains);
-
-    /** Node Search Operations */
-    int doesNodeExist(std::string ID, const std::vector<ClangNode*>& nodes);
-    bool doesEdgeExist(ClangNode* src, ClangNode* dst, const std::vector<ClangEdge*>& edges);
+    int internLabel(const std::string& label);
+    int getChild(int parent, const std::string& label, bool isFile);
+    std::string getFullPath(const std::string& parentPath, int node);
 };
 
 
@@ -0,0 +1,198 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// FileWatcher.cpp
+//
+// Created By: Bryan J Muscedere
+// Date: 19/10/26.
+//
+// Watches directories for changes to files using inotify. Changes are
+// collected until the directories have been quiet for a short while so a
+// burst of saves is reported as a single set of changed files.
+//
+// Copyright (C) 2017, Bryan J. Muscedere
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <chrono>
+#include <cerrno>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include "FileWatcher.h"
+
+using namespace std;
+using namespace std::chrono;
+namespace bs = boost::filesystem;
+
+/** Events that mean a file's contents or existence changed. Editors often save by renaming over the file. */
+const static uint32_t WATCH_MASK = IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                                   IN_DELETE_SELF | IN_ONLYDIR;
+
+/**
+ * Constructor. Opens an inotify instance.
+ */
+FileWatcher::FileWatcher(){
+    notifyFD = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    eventBuffer.resize(EVENT_BUFFER_SIZE);
+}
+
+/**
+ * Destructor. Closes the inotify instance and all its watches.
+ */
+FileWatcher::~FileWatcher(){
+    if (notifyFD >= 0) close(notifyFD);
+}
+
+/**
+ * Checks whether inotify is available.
+ * @return Whether changes can be watched.
+ */
+bool FileWatcher::isOpen(){
+    return notifyFD >= 0;
+}
+
+/**
+ * Starts watching a directory. Directories created later under a recursive
+ * watch are watched as they appear.
+ * @param dir The directory to watch.
+ * @param recursive Whether subdirectories are watched as well.
+ * @return The number of directories that are now watched.
+ */
+int FileWatcher::addDirectory(bs::path dir, bool recursive){
+    boost::system::error_code error;
+    dir = bs::canonical(dir, error);
+    if (error || notifyFD < 0 || !bs::is_directory(dir, error)) return 0;
+
+    //Skips directories we already watch, unless they now need to be recursive.
+    auto existing = watchedPaths.find(dir.string());
+    if (existing != watchedPaths.end() && (existing->second || !recursive)) return 0;
+
+    int numAdded = 0;
+    if (existing == watchedPaths.end()){
+        int wd = inotify_add_watch(notifyFD, dir.c_str(), WATCH_MASK);
+        if (wd < 0) return 0;
+
+        watchDirs[wd] = dir.string();
+        numAdded++;
+    }
+    watchedPaths[dir.string()] = recursive;
+    if (!recursive) return numAdded;
+
+    //Watches the subdirectories.
+    for (bs::directory_iterator iter(dir, error), end; !error && iter != end; iter.increment(error)){
+        if (bs::is_directory(iter->path(), error) && !bs::is_symlink(iter->path(), error)){
+            numAdded += addDirectory(iter->path(), true);
+        }
+    }
+
+    return numAdded;
+}
+
+/**
+ * Waits for files to change. Once something changes, events are collected
+ * until none arrive for the debounce period.
+ * @param changed The full paths of the files that changed.
+ * @param debounceMS How long the directories must be quiet before returning.
+ * @param timeoutMS How long to wait for a change, or -1 to wait forever.
+ * @param stopFD A descriptor that stops the wait when it becomes readable, or -1.
+ * @return Why the wait ended.
+ */
+FileWatcher::WaitResult FileWatcher::waitForChanges(set<string>& changed, int debounceMS, int timeoutMS,
+                                                    int stopFD){
+    if (notifyFD < 0) return FAILED;
+    steady_clock::time_point deadline = steady_clock::now() + milliseconds(timeoutMS);
+
+    struct pollfd fds[2];
+    fds[0].fd = notifyFD;
+    fds[0].events = POLLIN;
+    fds[1].fd = stopFD;
+    fds[1].events = POLLIN;
+    nfds_t numFDs = (stopFD >= 0) ? 2 : 1;
+
+    //Waits for the first change.
+    while (changed.size() == 0){
+        int wait = -1;
+        if (timeoutMS >= 0){
+            wait = (int) duration_cast<milliseconds>(deadline - steady_clock::now()).count();
+            if (wait <= 0) return TIMED_OUT;
+        }
+
+        int code = poll(fds, numFDs, wait);
+        if (code < 0 && errno == EINTR) continue;
+        if (code < 0) return FAILED;
+        if (numFDs > 1 && fds[1].revents != 0) return STOPPED;
+        if (fds[0].revents != 0 && !readEvents(changed)) return FAILED;
+    }
+
+    //Keeps collecting until things are quiet.
+    while (true){
+        int code = poll(fds, 1, debounceMS);
+        if (code < 0 && errno == EINTR) continue;
+        if (code < 0) return FAILED;
+        if (code == 0) break;
+        if (!readEvents(changed)) return FAILED;
+    }
+
+    return CHANGED;
+}
+
+/**
+ * Reads the pending inotify events.
+ * @param changed The full paths of the files that changed.
+ * @return Whether the events could be read.
+ */
+bool FileWatcher::readEvents(set<string>& changed){
+    while (true){
+        ssize_t size = read(notifyFD, eventBuffer.data(), eventBuffer.size());
+        if (size < 0 && errno == EINTR) continue;
+        if (size < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+        if (size <= 0) return false;
+
+        //Walks through each event.
+        for (char* pos = eventBuffer.data(); pos < eventBuffer.data() + size;){
+            struct inotify_event* event = (struct inotify_event*) pos;
+            pos += sizeof(struct inotify_event) + event->len;
+
+            auto dir = watchDirs.find(event->wd);
+            if (dir == watchDirs.end()) continue;
+
+            //Directories that go away stop being watched.
+            if (event->mask & (IN_DELETE_SELF | IN_IGNORED)){
+                watchedPaths.erase(dir->second);
+                watchDirs.erase(dir);
+                continue;
+            }
+            if (event->len == 0) continue;
+
+            //New directories under a recursive watch are watched too.
+            bs::path file = bs::path(dir->second) / event->name;
+            if (event->mask & IN_ISDIR){
+                auto parent = watchedPaths.find(dir->second);
+                if ((event->mask & (IN_CREATE | IN_MOVED_TO)) && parent != watchedPaths.end() && parent->second){
+                    addDirectory(file, true);
+
+                    //Files may have landed in it before the watch did.
+                    boost::system::error_code error;
+                    for (bs::recursive_directory_iterator iter(file, error), end; !error && iter != end;
+                         iter.increment(error)){
+                        if (bs::is_regular_file(iter->path(), error)) changed.insert(iter->path().string());
+                    }
+                }
+                continue;
+            }
+
+            changed.insert(file.string());
+        }
+    }
+}
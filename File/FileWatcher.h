@@ -0,0 +1,65 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// FileWatcher.h
+//
+// Created By: Bryan J Muscedere
+// Date: 19/10/26.
+//
+// Watches directories for changes to files using inotify. Changes are
+// collected until the directories have been quiet for a short while so a
+// burst of saves is reported as a single set of changed files.
+//
+// Copyright (C) 2017, Bryan J. Muscedere
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CLANGEX_FILEWATCHER_H
+#define CLANGEX_FILEWATCHER_H
+
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <boost/filesystem.hpp>
+
+class FileWatcher {
+public:
+    /** Wait Results */
+    enum WaitResult {CHANGED, STOPPED, TIMED_OUT, FAILED};
+
+    /** Constructor/Destructor */
+    FileWatcher();
+    ~FileWatcher();
+
+    /** Watch Operations */
+    bool isOpen();
+    int addDirectory(boost::filesystem::path dir, bool recursive);
+    WaitResult waitForChanges(std::set<std::string>& changed, int debounceMS, int timeoutMS, int stopFD = -1);
+
+private:
+    /** Private Constants */
+    const size_t EVENT_BUFFER_SIZE = 64 * 1024;
+
+    /** Private Variables */
+    int notifyFD = -1;
+    std::map<int, std::string> watchDirs;
+    std::map<std::string, bool> watchedPaths;
+    std::vector<char> eventBuffer;
+
+    /** Helper Methods */
+    bool readEvents(std::set<std::string>& changed);
+};
+
+
+#endif //CLANGEX_FILEWATCHER_H
@@ -61,7 +61,7 @@ string ClangEdge::getTypeString(EdgeType type) {
  */
 ClangEdge::EdgeType ClangEdge::getTypeEdge(string name){
     //Goes through and checks for type.
-    if (name.compare("contains") == 0){
+    if (name.compare("contain") == 0 || name.compare("contains") == 0){
         return CONTAINS;
     } else if (name.compare("call") == 0){
         return CALLS;
@@ -232,6 +232,16 @@ void ClangEdge::setDst(ClangNode* newDst){
     if (src && dst) unresolved = false;
 }
 
+/**
+ * Drops the links to the source and destination nodes. The IDs are kept so
+ * the edge can be resolved again.
+ */
+void ClangEdge::unresolve(){
+    src = nullptr;
+    dst = nullptr;
+    unresolved = true;
+}
+
 /**
  * Adds an attribute.
  * @param key The key to add.
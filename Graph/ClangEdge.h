@@ -152,6 +152,7 @@ public:
     /** Setters */
     void setSrc(ClangNode* newSrc);
     void setDst(ClangNode* newDst);
+    void unresolve();
 
     /** Attribute Getters/Setters */
     bool addAttribute(std::string key, std::string value);
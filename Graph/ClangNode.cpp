@@ -36,6 +36,9 @@ ClangNode::AccessStruct ClangNode::VIS_ATTRIBUTE;
 ClangNode::VarStruct ClangNode::VAR_ATTRIBUTE;
 ClangNode::StructStruct ClangNode::STRUCT_ATTRIBUTE;
 
+/** Flag Definitions */
+const string ClangNode::NAME_FLAG = "label";
+
 /**
  * Converts an enum to a string representation. Used for TA encoding.
  * @param type The node type to convert.
@@ -170,6 +173,15 @@ ClangNode::NodeType ClangNode::getType(){
     return type;
 }
 
+/**
+ * Sets the name of the node. The name is stored as the label attribute.
+ * @param name The new name of the node.
+ */
+void ClangNode::setName(string name) {
+    nodeAttributes[NAME_FLAG] = vector<string>();
+    nodeAttributes[NAME_FLAG].push_back(name);
+}
+
 /**
  * Adds an attribute to the node.
  * @param key The key of the attribute.
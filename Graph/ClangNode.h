@@ -41,12 +41,13 @@ private:
         const std::string attrName = "filename";
 
         /**
-         * Gets the file name for the object.
+         * Gets the file name for the object. The full path is kept so files
+         * with the same name in different directories can be told apart.
          * @param path The boost path being used.
          */
         std::string processFileName(std::string path){
             boost::filesystem::path p(path);
-            return p.filename().string();
+            return p.string();
         }
     } AttributeStruct;
 
@@ -179,6 +180,7 @@ public:
     ClangNode::NodeType getType();
 
     /** Attribute Getters/Setters */
+    void setName(std::string name);
     bool addAttribute(std::string key, std::string value);
     bool clearAttributes(std::string key);
     std::vector<std::string> getAttribute(std::string key);
@@ -198,10 +200,12 @@ public:
     static VarStruct VAR_ATTRIBUTE;
     static StructStruct STRUCT_ATTRIBUTE;
 
+    /** Name Attribute Key */
+    static const std::string NAME_FLAG;
+
 private:
     /** TA Flags */
     const std::string INSTANCE_FLAG = "$INSTANCE";
-    const std::string NAME_FLAG = "label";
 
     /** Member Variables */
     std::string ID;
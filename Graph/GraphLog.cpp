@@ -0,0 +1,566 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// GraphLog.cpp
+//
+// Created By: Bryan J Muscedere
+// Date: 19/10/26.
+//
+// Append-only binary log used by the low-memory graph to spill entities,
+// relations and attributes to disk. Records are length-prefixed and refer
+// to strings through a table that is rebuilt for each batch of records.
+// Records are grouped into frames that are compressed with zlib and
+// checksummed. Each purge ends with a commit record so a crash part way
+// through a purge can be rolled back to the last complete one.
+//
+// Copyright (C) 2017, Bryan J. Muscedere
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <chrono>
+#include <zlib.h>
+#include <unistd.h>
+#include "GraphLog.h"
+
+using namespace std;
+
+/**
+ * Constructor. Sets up a log for a file.
+ * @param fileName The file that holds the log.
+ */
+GraphLog::GraphLog(string fileName){
+    this->fileName = fileName;
+}
+
+/**
+ * Destructor. Closes any open streams.
+ */
+GraphLog::~GraphLog(){
+    closeWriter();
+    closeReader();
+}
+
+/**
+ * Opens the log for writing.
+ * @param append Whether we add to the end of the log or start a new one.
+ * @return Whether the log was opened.
+ */
+bool GraphLog::openWriter(bool append){
+    closeWriter();
+
+    //Sets the buffer before opening so it takes effect.
+    writeBuffer.resize(IO_BUFFER_SIZE);
+    writer.rdbuf()->pubsetbuf(writeBuffer.data(), writeBuffer.size());
+    writer.open(fileName, ios::out | ios::binary | ((append) ? ios::app : ios::trunc));
+    if (!writer.is_open()) return false;
+
+    beginBatch();
+    return true;
+}
+
+/**
+ * Starts a new batch. Strings written before this point are forgotten.
+ */
+void GraphLog::beginBatch(){
+    writeTable.clear();
+    tableBytes = 0;
+    emitRecord(BATCH, string());
+}
+
+/**
+ * Sets how large the string table can grow before a new batch is started.
+ * Readers hold the table of the batch they're in, so this bounds their memory too.
+ * @param budget The approximate size of the table in bytes.
+ */
+void GraphLog::setTableBudget(size_t budget){
+    tableBudget = budget;
+}
+
+/**
+ * Writes an instance to the log.
+ * @param ID The ID of the instance.
+ * @param type The type of the instance.
+ */
+void GraphLog::writeInstance(const string& ID, const string& type){
+    checkTable();
+
+    string data;
+    putVarint(data, intern(ID));
+    putVarint(data, intern(type));
+    emitRecord(INSTANCE, data);
+}
+
+/**
+ * Writes a relation to the log.
+ * @param rel The relation name.
+ * @param src The source ID.
+ * @param dst The destination ID.
+ */
+void GraphLog::writeRelation(const string& rel, const string& src, const string& dst){
+    checkTable();
+
+    string data;
+    putVarint(data, intern(rel));
+    putVarint(data, intern(src));
+    putVarint(data, intern(dst));
+    emitRecord(RELATION, data);
+}
+
+/**
+ * Writes the attributes of an entity to the log. Empty attributes are skipped.
+ * @param ID The ID of the entity.
+ * @param attrs The attributes of the entity.
+ */
+void GraphLog::writeAttributes(const string& ID, const map<string, vector<string>>& attrs){
+    AttributeList list;
+    for (auto const& it : attrs) if (it.second.size() > 0) list.push_back(it);
+
+    writeAttributes(ID, list);
+}
+
+/**
+ * Writes the attributes of an entity to the log.
+ * @param ID The ID of the entity.
+ * @param attrs The attributes of the entity.
+ */
+void GraphLog::writeAttributes(const string& ID, const AttributeList& attrs){
+    if (attrs.size() == 0) return;
+    checkTable();
+
+    record.clear();
+    putVarint(record, intern(ID));
+    putAttributes(attrs);
+    emitRecord(ATTRIBUTE, record);
+}
+
+/**
+ * Writes the attributes of a relation to the log. Empty attributes are skipped.
+ * @param rel The relation name.
+ * @param src The source ID.
+ * @param dst The destination ID.
+ * @param attrs The attributes of the relation.
+ */
+void GraphLog::writeRelAttributes(const string& rel, const string& src, const string& dst,
+                                  const map<string, vector<string>>& attrs){
+    AttributeList list;
+    for (auto const& it : attrs) if (it.second.size() > 0) list.push_back(it);
+
+    writeRelAttributes(rel, src, dst, list);
+}
+
+/**
+ * Writes the attributes of a relation to the log.
+ * @param rel The relation name.
+ * @param src The source ID.
+ * @param dst The destination ID.
+ * @param attrs The attributes of the relation.
+ */
+void GraphLog::writeRelAttributes(const string& rel, const string& src, const string& dst,
+                                  const AttributeList& attrs){
+    if (attrs.size() == 0) return;
+    checkTable();
+
+    record.clear();
+    putVarint(record, intern(rel));
+    putVarint(record, intern(src));
+    putVarint(record, intern(dst));
+    putAttributes(attrs);
+    emitRecord(REL_ATTRIBUTE, record);
+}
+
+/**
+ * Writes a commit record. Everything written before it is treated as one
+ * complete segment, tagged with the first file that isn't fully in the log.
+ * @param fileNum The number of the first incomplete file.
+ * @param file The name of the first incomplete file.
+ */
+void GraphLog::writeCommit(int fileNum, const string& file){
+    checkTable();
+
+    string data;
+    putVarint(data, intern(to_string(fileNum)));
+    putVarint(data, intern(file));
+    emitRecord(COMMIT, data);
+
+    //Commits always end a frame so the log can be cut right after them.
+    flushFrame();
+}
+
+/**
+ * Closes the writer.
+ * @return Whether everything was written.
+ */
+bool GraphLog::closeWriter(){
+    if (!writer.is_open()) return true;
+
+    bool flushed = flushFrame();
+    writer.close();
+    writeTable.clear();
+    tableBytes = 0;
+    bool success = flushed && !writer.fail();
+    writer.clear();
+
+    return success;
+}
+
+/**
+ * Gets the number of bytes written before compression.
+ * @return The uncompressed size.
+ */
+unsigned long long GraphLog::getRawBytes(){
+    return rawBytes;
+}
+
+/**
+ * Gets the number of bytes written after compression.
+ * @return The compressed size.
+ */
+unsigned long long GraphLog::getCompressedBytes(){
+    return compressedBytes;
+}
+
+/**
+ * Gets the time spent compressing.
+ * @return The time in seconds.
+ */
+double GraphLog::getCompressSeconds(){
+    return compressSeconds;
+}
+
+/**
+ * Opens the log for reading from the start.
+ * @return Whether the log was opened.
+ */
+bool GraphLog::openReader(){
+    closeReader();
+
+    readBuffer.resize(IO_BUFFER_SIZE);
+    reader.rdbuf()->pubsetbuf(readBuffer.data(), readBuffer.size());
+    reader.open(fileName, ios::in | ios::binary);
+    block.clear();
+    blockPos = 0;
+
+    return reader.is_open();
+}
+
+/**
+ * Reads the next instance, relation or attribute record. String and batch
+ * records are handled here and are never returned.
+ * @param record Set to the next record.
+ * @return Whether a record was read. A partial record at the end is treated as the end of the log.
+ */
+bool GraphLog::next(LogRecord& record){
+    while (reader.is_open()){
+        if (blockPos >= block.size() && !readFrame()) return false;
+        int type = (unsigned char) block[blockPos++];
+
+        //Reads the payload.
+        unsigned long long length;
+        if (!readVarint(length) || length > block.size() - blockPos) return false;
+        payload.assign(block, blockPos, length);
+        blockPos += length;
+
+        //Handles the string table.
+        if (type == BATCH){
+            readTable.clear();
+            continue;
+        } else if (type == STRING){
+            readTable.push_back(payload);
+            continue;
+        }
+
+        //Decodes the record.
+        size_t numFields;
+        bool hasAttributes;
+        if (type == INSTANCE){
+            numFields = 2;
+            hasAttributes = false;
+        } else if (type == RELATION){
+            numFields = 3;
+            hasAttributes = false;
+        } else if (type == ATTRIBUTE){
+            numFields = 1;
+            hasAttributes = true;
+        } else if (type == REL_ATTRIBUTE){
+            numFields = 3;
+            hasAttributes = true;
+        } else if (type == COMMIT){
+            numFields = 2;
+            hasAttributes = false;
+        } else {
+            continue;
+        }
+
+        record.type = (RecordType) type;
+        record.fields.resize(numFields);
+        record.attributes.clear();
+
+        size_t pos = 0;
+        for (size_t i = 0; i < numFields; i++) if (!getString(pos, record.fields.at(i))) return false;
+        if (hasAttributes && !getAttributes(pos, record.attributes)) return false;
+
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * Closes the reader.
+ */
+void GraphLog::closeReader(){
+    if (reader.is_open()) reader.close();
+    reader.clear();
+    readTable.clear();
+    block.clear();
+    blockPos = 0;
+}
+
+/**
+ * Cuts the log back to the end of its last commit. Anything after it is from
+ * a purge that never finished and is removed.
+ * @param commit Set to the last commit record.
+ * @return Whether a commit was found.
+ */
+bool GraphLog::rollback(LogRecord& commit){
+    if (!openReader()) return false;
+
+    //Finds where the last commit ends.
+    LogRecord record;
+    long long committed = 0;
+    bool found = false;
+    while (next(record)){
+        if (record.type != COMMIT || blockPos != block.size()) continue;
+
+        committed = reader.tellg();
+        commit = record;
+        found = true;
+    }
+    closeReader();
+
+    return truncate(fileName.c_str(), committed) == 0 && found;
+}
+
+/**
+ * Starts a new batch if the string table is over its budget. This is only
+ * called between records since a record's strings must be in one batch.
+ */
+void GraphLog::checkTable(){
+    if (tableBytes >= tableBudget) beginBatch();
+}
+
+/**
+ * Gets the table index for a string, adding it to the log if it's new in this batch.
+ * @param value The string to look up.
+ * @return The index of the string.
+ */
+unsigned int GraphLog::intern(const string& value){
+    auto it = writeTable.find(value);
+    if (it != writeTable.end()) return it->second;
+
+    unsigned int index = (unsigned int) writeTable.size();
+    writeTable[value] = index;
+    tableBytes += value.size() + STRING_OVERHEAD;
+    emitRecord(STRING, value);
+
+    return index;
+}
+
+/**
+ * Appends a variable length integer to a string.
+ * @param dst The string to append to.
+ * @param value The value to encode.
+ */
+void GraphLog::putVarint(string& dst, unsigned long long value){
+    while (value >= 0x80){
+        dst += (char) ((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    dst += (char) value;
+}
+
+/**
+ * Writes a record to the log.
+ * @param type The type of record.
+ * @param data The payload of the record.
+ */
+void GraphLog::emitRecord(RecordType type, const string& data){
+    string header;
+    header += (char) type;
+    putVarint(header, data.size());
+
+    frame += header;
+    frame += data;
+    if (frame.size() >= FRAME_SIZE) flushFrame();
+}
+
+/**
+ * Compresses the buffered records and writes them as one frame. A frame holds
+ * its uncompressed and compressed sizes and a CRC32 of the records, followed
+ * by the zlib data.
+ * @return Whether the frame was compressed.
+ */
+bool GraphLog::flushFrame(){
+    if (frame.size() == 0) return true;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    //Compresses the frame.
+    uLongf compLength = compressBound(frame.size());
+    compressed.resize(compLength);
+    unsigned long checksum = crc32(0L, (const Bytef*) frame.data(), frame.size());
+    int result = compress2((Bytef*) &compressed[0], &compLength, (const Bytef*) frame.data(), frame.size(),
+                           COMPRESSION_LEVEL);
+    if (result != Z_OK) return false;
+
+    string header;
+    putVarint(header, frame.size());
+    putVarint(header, compLength);
+    putVarint(header, checksum);
+    writer.write(header.data(), header.size());
+    writer.write(compressed.data(), compLength);
+
+    //Updates the statistics.
+    rawBytes += frame.size();
+    compressedBytes += header.size() + compLength;
+    compressSeconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    frame.clear();
+
+    return true;
+}
+
+/**
+ * Appends an attribute list to the current record.
+ * @param attrs The attributes to encode.
+ */
+void GraphLog::putAttributes(const AttributeList& attrs){
+    putVarint(record, attrs.size());
+    for (auto const& attr : attrs){
+        putVarint(record, intern(attr.first));
+        putVarint(record, attr.second.size());
+        for (auto const& value : attr.second) putVarint(record, intern(value));
+    }
+}
+
+/**
+ * Reads and decompresses the next frame of the log.
+ * @return Whether a complete frame was read.
+ */
+bool GraphLog::readFrame(){
+    unsigned long long rawLength, compLength, checksum;
+    if (!readStreamVarint(rawLength) || !readStreamVarint(compLength) || !readStreamVarint(checksum)) return false;
+    if (rawLength > MAX_FRAME_SIZE || compLength > compressBound(rawLength)) return false;
+
+    //Reads the compressed data.
+    compressed.resize(compLength);
+    if (compLength > 0 && !reader.read(&compressed[0], compLength)) return false;
+
+    //Decompresses it.
+    block.resize(rawLength);
+    uLongf length = rawLength;
+    int result = uncompress((Bytef*) &block[0], &length, (const Bytef*) compressed.data(), compLength);
+    if (result != Z_OK || length != rawLength || rawLength == 0) return false;
+    if (crc32(0L, (const Bytef*) block.data(), block.size()) != checksum) return false;
+
+    blockPos = 0;
+    return true;
+}
+
+/**
+ * Reads a variable length integer from the log file.
+ * @param value Set to the value read.
+ * @return Whether the value was read.
+ */
+bool GraphLog::readStreamVarint(unsigned long long& value){
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7){
+        int cur = reader.get();
+        if (cur == char_traits<char>::eof()) return false;
+
+        value |= (unsigned long long) (cur & 0x7F) << shift;
+        if ((cur & 0x80) == 0) return true;
+    }
+
+    return false;
+}
+
+/**
+ * Reads a variable length integer from the current frame.
+ * @param value Set to the value read.
+ * @return Whether the value was read.
+ */
+bool GraphLog::readVarint(unsigned long long& value){
+    value = 0;
+    for (int shift = 0; shift < 64 && blockPos < block.size(); shift += 7){
+        unsigned char cur = (unsigned char) block[blockPos++];
+
+        value |= (unsigned long long) (cur & 0x7F) << shift;
+        if ((cur & 0x80) == 0) return true;
+    }
+
+    return false;
+}
+
+/**
+ * Decodes a variable length integer from the current payload.
+ * @param pos The position in the payload.
+ * @param value Set to the value read.
+ * @return Whether the value was read.
+ */
+bool GraphLog::getVarint(size_t& pos, unsigned long long& value){
+    value = 0;
+    for (int shift = 0; shift < 64 && pos < payload.size(); shift += 7){
+        unsigned char cur = (unsigned char) payload[pos++];
+
+        value |= (unsigned long long) (cur & 0x7F) << shift;
+        if ((cur & 0x80) == 0) return true;
+    }
+
+    return false;
+}
+
+/**
+ * Decodes a string reference from the current payload.
+ * @param pos The position in the payload.
+ * @param value Set to the string.
+ * @return Whether the string was found in the table.
+ */
+bool GraphLog::getString(size_t& pos, string& value){
+    unsigned long long index;
+    if (!getVarint(pos, index) || index >= readTable.size()) return false;
+
+    value = readTable[index];
+    return true;
+}
+
+/**
+ * Decodes an attribute list from the current payload.
+ * @param pos The position in the payload.
+ * @param attrs Set to the attributes.
+ * @return Whether the attributes were decoded.
+ */
+bool GraphLog::getAttributes(size_t& pos, AttributeList& attrs){
+    unsigned long long numAttrs;
+    if (!getVarint(pos, numAttrs) || numAttrs > payload.size() - pos) return false;
+
+    attrs.resize(numAttrs);
+    for (auto& attr : attrs){
+        unsigned long long numValues;
+        if (!getString(pos, attr.first) || !getVarint(pos, numValues)) return false;
+        if (numValues > payload.size() - pos) return false;
+
+        attr.second.resize(numValues);
+        for (auto& value : attr.second) if (!getString(pos, value)) return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,137 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// GraphLog.h
+//
+// Created By: Bryan J Muscedere
+// Date: 19/10/26.
+//
+// Append-only binary log used by the low-memory graph to spill entities,
+// relations and attributes to disk. Records are length-prefixed and refer
+// to strings through a table that is rebuilt for each batch of records.
+// Records are grouped into frames that are compressed with zlib and
+// checksummed. Each purge ends with a commit record so a crash part way
+// through a purge can be rolled back to the last complete one.
+//
+// Copyright (C) 2017, Bryan J. Muscedere
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CLANGEX_GRAPHLOG_H
+#define CLANGEX_GRAPHLOG_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <unordered_map>
+
+class GraphLog {
+public:
+    /** Attribute Types */
+    typedef std::vector<std::pair<std::string, std::vector<std::string>>> AttributeList;
+
+    /** Record Types */
+    enum RecordType {BATCH, STRING, INSTANCE, RELATION, ATTRIBUTE, REL_ATTRIBUTE, COMMIT};
+
+    /** Record Structure */
+    typedef struct {
+        RecordType type;
+        std::vector<std::string> fields;
+        AttributeList attributes;
+    } LogRecord;
+
+    /** Constructor/Destructor */
+    GraphLog(std::string fileName);
+    ~GraphLog();
+
+    /** Writer Operations */
+    bool openWriter(bool append = true);
+    void beginBatch();
+    void setTableBudget(size_t budget);
+    void writeInstance(const std::string& ID, const std::string& type);
+    void writeRelation(const std::string& rel, const std::string& src, const std::string& dst);
+    void writeAttributes(const std::string& ID, const std::map<std::string, std::vector<std::string>>& attrs);
+    void writeAttributes(const std::string& ID, const AttributeList& attrs);
+    void writeRelAttributes(const std::string& rel, const std::string& src, const std::string& dst,
+                            const std::map<std::string, std::vector<std::string>>& attrs);
+    void writeRelAttributes(const std::string& rel, const std::string& src, const std::string& dst,
+                            const AttributeList& attrs);
+    void writeCommit(int fileNum, const std::string& file);
+    bool closeWriter();
+
+    /** Compression Statistics */
+    unsigned long long getRawBytes();
+    unsigned long long getCompressedBytes();
+    double getCompressSeconds();
+
+    /** Reader Operations */
+    bool openReader();
+    bool next(LogRecord& record);
+    void closeReader();
+
+    /** Recovery Operations */
+    bool rollback(LogRecord& commit);
+
+private:
+    /** Private Constants */
+    const size_t IO_BUFFER_SIZE = 1024 * 1024;
+    const size_t FRAME_SIZE = 1024 * 1024;
+    const unsigned long long MAX_FRAME_SIZE = 1024 * 1024 * 1024;
+    const int COMPRESSION_LEVEL = 1;
+    const size_t STRING_OVERHEAD = 64;
+    const size_t DEFAULT_TABLE_BUDGET = 64 * 1024 * 1024;
+
+    /** Private Variables */
+    std::string fileName;
+
+    /** Writer State */
+    std::ofstream writer;
+    std::vector<char> writeBuffer;
+    std::string record;
+    std::string frame;
+    std::string compressed;
+    std::unordered_map<std::string, unsigned int> writeTable;
+    size_t tableBytes = 0;
+    size_t tableBudget = DEFAULT_TABLE_BUDGET;
+    unsigned long long rawBytes = 0;
+    unsigned long long compressedBytes = 0;
+    double compressSeconds = 0;
+
+    /** Reader State */
+    std::ifstream reader;
+    std::vector<char> readBuffer;
+    std::string payload;
+    std::string block;
+    size_t blockPos = 0;
+    std::vector<std::string> readTable;
+
+    /** Encoding Helpers */
+    void checkTable();
+    unsigned int intern(const std::string& value);
+    void putVarint(std::string& dst, unsigned long long value);
+    void emitRecord(RecordType type, const std::string& data);
+    void putAttributes(const AttributeList& attrs);
+    bool flushFrame();
+
+    /** Decoding Helpers */
+    bool readFrame();
+    bool readStreamVarint(unsigned long long& value);
+    bool readVarint(unsigned long long& value);
+    bool getVarint(size_t& pos, unsigned long long& value);
+    bool getString(size_t& pos, std::string& value);
+    bool getAttributes(size_t& pos, AttributeList& attrs);
+};
+
+
+#endif //CLANGEX_GRAPHLOG_H
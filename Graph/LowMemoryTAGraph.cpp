@@ -30,19 +30,27 @@
 #include <boost/filesystem/operations.hpp>
 #include <boost/algorithm/string/split.hpp>
 #include <boost/algorithm/string/classification.hpp>
+#include <memory>
+#include <algorithm>
+#include <functional>
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
 #include "LowMemoryTAGraph.h"
+#include "../Driver/TraceRecorder.h"
+#include "../TupleAttribute/ModelJoiner.h"
 
 using namespace std;
 namespace bs = boost::filesystem;
 
 /** Const Methods */
-int LowMemoryTAGraph::currentNumber = 0;
+atomic<int> LowMemoryTAGraph::currentNumber(0);
 const string LowMemoryTAGraph::CUR_FILE_LOC = "curFile.txt";
 const string LowMemoryTAGraph::CUR_SETTING_LOC = "curSetting.txt";
-const string LowMemoryTAGraph::BASE_INSTANCE_FN = "instances.ta";
-const string LowMemoryTAGraph::BASE_RELATION_FN = "relations.ta";
-const string LowMemoryTAGraph::BASE_MV_RELATION_FN = "old.relations.ta";
-const string LowMemoryTAGraph::BASE_ATTRIBUTE_FN = "attributes.ta";
+const string LowMemoryTAGraph::BASE_LOG_FN = "graph.log";
+const string LowMemoryTAGraph::BASE_COMPACT_LOG_FN = "compact.graph.log";
 
 /**
  * Creates a graph with a base and a specific number.
@@ -53,10 +61,8 @@ LowMemoryTAGraph::LowMemoryTAGraph(string basePath, int curNum) : TAGraph() {
     purge = true;
     fileNumber = curNum;
 
-    instanceFN = bs::weakly_canonical(bs::path(basePath + "/" + to_string(fileNumber) + "-" + BASE_INSTANCE_FN)).string();
-    relationFN = bs::weakly_canonical(bs::path(basePath + "/" + to_string(fileNumber) + "-" + BASE_RELATION_FN)).string();
-    mvRelationFN = bs::weakly_canonical(bs::path(basePath + "/" + to_string(fileNumber) + "-" + BASE_MV_RELATION_FN)).string();
-    attributeFN = bs::weakly_canonical(bs::path(basePath + "/" + to_string(fileNumber) + "-" + BASE_ATTRIBUTE_FN)).string();
+    logFN = bs::weakly_canonical(bs::path(basePath + "/" + to_string(fileNumber) + "-" + BASE_LOG_FN)).string();
+    compactLogFN = bs::weakly_canonical(bs::path(basePath + "/" + to_string(fileNumber) + "-" + BASE_COMPACT_LOG_FN)).string();
     settingFN = bs::weakly_canonical(bs::path(basePath + "/" + to_string(fileNumber) + "-" + CUR_SETTING_LOC)).string();
     curFileFN = bs::weakly_canonical(bs::path(basePath + "/" + to_string(fileNumber) + "-" + CUR_FILE_LOC)).string();
 }
@@ -67,24 +73,15 @@ LowMemoryTAGraph::LowMemoryTAGraph(string basePath, int curNum) : TAGraph() {
  */
 LowMemoryTAGraph::LowMemoryTAGraph(string basePath) : TAGraph() {
     purge = true;
-    fileNumber = LowMemoryTAGraph::currentNumber;
-    LowMemoryTAGraph::currentNumber++;
+    fileNumber = LowMemoryTAGraph::currentNumber++;
 
-    instanceFN = bs::weakly_canonical(bs::path(basePath + "/" + to_string(fileNumber) + "-" + BASE_INSTANCE_FN)).string();
-    relationFN = bs::weakly_canonical(bs::path(basePath + "/" + to_string(fileNumber) + "-" + BASE_RELATION_FN)).string();
-    mvRelationFN = bs::weakly_canonical(bs::path(basePath + "/" + to_string(fileNumber) + "-" + BASE_MV_RELATION_FN)).string();
-    attributeFN = bs::weakly_canonical(bs::path(basePath + "/" + to_string(fileNumber) + "-" + BASE_ATTRIBUTE_FN)).string();
+    logFN = bs::weakly_canonical(bs::path(basePath + "/" + to_string(fileNumber) + "-" + BASE_LOG_FN)).string();
+    compactLogFN = bs::weakly_canonical(bs::path(basePath + "/" + to_string(fileNumber) + "-" + BASE_COMPACT_LOG_FN)).string();
     settingFN = bs::weakly_canonical(bs::path(basePath + "/" + to_string(fileNumber) + "-" + CUR_SETTING_LOC)).string();
     curFileFN = bs::weakly_canonical(bs::path(basePath + "/" + to_string(fileNumber) + "-" + CUR_FILE_LOC)).string();
 
-    if (doesFileExist(instanceFN)) deleteFile(instanceFN);
-    if (doesFileExist(relationFN)) deleteFile(relationFN);
-    if (doesFileExist(attributeFN)) deleteFile(attributeFN);
-    std::ofstream f = std::ofstream{ instanceFN };
-    f.close();
-    f = ofstream{ relationFN };
-    f.close();
-    f = ofstream{ attributeFN };
+    if (doesFileExist(logFN)) deleteFile(logFN);
+    std::ofstream f = std::ofstream{ logFN };
     f.close();
     f = ofstream{ settingFN };
     f.close();
@@ -97,24 +94,15 @@ LowMemoryTAGraph::LowMemoryTAGraph(string basePath) : TAGraph() {
  */
 LowMemoryTAGraph::LowMemoryTAGraph() : TAGraph() {
     purge = true;
-    fileNumber = LowMemoryTAGraph::currentNumber;
-    LowMemoryTAGraph::currentNumber++;
+    fileNumber = LowMemoryTAGraph::currentNumber++;
 
-    instanceFN = bs::weakly_canonical(bs::path(to_string(fileNumber) + "-" + BASE_INSTANCE_FN)).string();
-    relationFN = bs::weakly_canonical(bs::path(to_string(fileNumber) + "-" + BASE_RELATION_FN)).string();
-    mvRelationFN = bs::weakly_canonical(bs::path(to_string(fileNumber) + "-" + BASE_MV_RELATION_FN)).string();
-    attributeFN = bs::weakly_canonical(bs::path(to_string(fileNumber) + "-" + BASE_ATTRIBUTE_FN)).string();
+    logFN = bs::weakly_canonical(bs::path(to_string(fileNumber) + "-" + BASE_LOG_FN)).string();
+    compactLogFN = bs::weakly_canonical(bs::path(to_string(fileNumber) + "-" + BASE_COMPACT_LOG_FN)).string();
     settingFN = bs::weakly_canonical(bs::path(to_string(fileNumber) + "-" + CUR_SETTING_LOC)).string();
     curFileFN = bs::weakly_canonical(bs::path(to_string(fileNumber) + "-" + CUR_FILE_LOC)).string();
 
-    if (doesFileExist(instanceFN)) deleteFile(instanceFN);
-    if (doesFileExist(relationFN)) deleteFile(relationFN);
-    if (doesFileExist(attributeFN)) deleteFile(attributeFN);
-    std::ofstream f = std::ofstream{ instanceFN };
-    f.close();
-    f = ofstream{ relationFN };
-    f.close();
-    f = ofstream{ attributeFN };
+    if (doesFileExist(logFN)) deleteFile(logFN);
+    std::ofstream f = std::ofstream{ logFN };
     f.close();
     f = ofstream{ settingFN };
     f.close();
@@ -127,9 +115,19 @@ LowMemoryTAGraph::LowMemoryTAGraph() : TAGraph() {
  * Deletes all the files to disk.
  */
 LowMemoryTAGraph::~LowMemoryTAGraph() {
-    if (doesFileExist(instanceFN)) deleteFile(instanceFN);
-    if (doesFileExist(relationFN)) deleteFile(relationFN);
-    if (doesFileExist(attributeFN)) deleteFile(attributeFN);
+    //Stops the background writer.
+    waitForSpills();
+    if (writer.joinable()){
+        {
+            lock_guard<mutex> lock(spillMutex);
+            stopWriter = true;
+        }
+        spillCond.notify_all();
+        writer.join();
+    }
+
+    if (doesFileExist(logFN)) deleteFile(logFN);
+    if (doesFileExist(compactLogFN)) deleteFile(compactLogFN);
     if (doesFileExist(settingFN)) deleteFile(settingFN);
     if (doesFileExist(curFileFN)) deleteFile(curFileFN);
 }
@@ -139,14 +137,22 @@ LowMemoryTAGraph::~LowMemoryTAGraph() {
  * @param basePath The base path to change the location.
  */
 void LowMemoryTAGraph::changeRoot(std::string basePath){
-    instanceFN = bs::weakly_canonical(bs::path(basePath + "/" + to_string(fileNumber) + "-" + BASE_INSTANCE_FN)).string();
-    relationFN = bs::weakly_canonical(bs::path(basePath + "/" + to_string(fileNumber) + "-" + BASE_RELATION_FN)).string();
-    mvRelationFN = bs::weakly_canonical(bs::path(basePath + "/" + to_string(fileNumber) + "-" + BASE_MV_RELATION_FN)).string();
-    attributeFN = bs::weakly_canonical(bs::path(basePath + "/" + to_string(fileNumber) + "-" + BASE_ATTRIBUTE_FN)).string();
+    waitForSpills();
+
+    logFN = bs::weakly_canonical(bs::path(basePath + "/" + to_string(fileNumber) + "-" + BASE_LOG_FN)).string();
+    compactLogFN = bs::weakly_canonical(bs::path(basePath + "/" + to_string(fileNumber) + "-" + BASE_COMPACT_LOG_FN)).string();
     settingFN = bs::weakly_canonical(bs::path(basePath + "/" + to_string(fileNumber) + "-" + CUR_SETTING_LOC)).string();
     curFileFN = bs::weakly_canonical(bs::path(basePath + "/" + to_string(fileNumber) + "-" + CUR_FILE_LOC)).string();
 }
 
+/**
+ * Gets the number of this graph in its directory.
+ * @return The graph number.
+ */
+int LowMemoryTAGraph::getGraphNumber(){
+    return fileNumber;
+}
+
 /**
  * Adds a node to the graph.
  * @param node The node to add.
@@ -154,14 +160,23 @@ void LowMemoryTAGraph::changeRoot(std::string basePath){
  * @return Whether it was added.
  */
 bool LowMemoryTAGraph::addNode(ClangNode* node, bool assumeValid){
-    //Check the number of entities.
-    int amt = getNumberEntities();
-    if (amt > PURGE_AMOUNT){
+    //Check how much memory the graph is using. This comes first so a copy purged now is seen below.
+    if (isNearBudget()){
         purgeCurrentGraph();
     }
 
+    //Nodes that were already spilled are treated as duplicates.
+    if (!assumeValid && wasWritten(hash<string>()(node->getID()))){
+        delete node;
+        return false;
+    }
+
     //Add the graph.
-    return TAGraph::addNode(node, assumeValid);
+    size_t size = getNodeSize(node);
+    bool added = TAGraph::addNode(node, assumeValid);
+    if (added) footprint += size;
+
+    return added;
 }
 
 /**
@@ -171,43 +186,119 @@ bool LowMemoryTAGraph::addNode(ClangNode* node, bool assumeValid){
  * @return Whether it was added.
  */
 bool LowMemoryTAGraph::addEdge(ClangEdge* edge, bool assumeValid){
-    //Check the number of entities.
-    int amt = getNumberEntities();
-    if (amt > PURGE_AMOUNT){
+    //Check how much memory the graph is using. This comes first so a copy purged now is seen below.
+    if (isNearBudget()){
         purgeCurrentGraph();
     }
 
+    //Edges that were already spilled are treated as duplicates.
+    if (!assumeValid && wasWritten(getEdgeKey(edge))){
+        delete edge;
+        return false;
+    }
+
     //Add the graph.
-    return TAGraph::addEdge(edge, assumeValid);
+    size_t size = getEdgeSize(edge);
+    bool added = TAGraph::addEdge(edge, assumeValid);
+    if (added) footprint += size;
+
+    return added;
 }
 
 /**
- * Generates the TA for this graph.
- * @return The TA format.
+ * Adds an attribute to a node in the graph.
+ * @param ID The ID of the node.
+ * @param key The attribute key.
+ * @param value The attribute value.
+ * @return Whether it was added.
  */
-string LowMemoryTAGraph::generateTAFormat() {
-    string format = generateTAHeader();
-    string curLine;
+bool LowMemoryTAGraph::addAttribute(string ID, string key, string value){
+    bool added = TAGraph::addAttribute(ID, key, value);
+    if (added) footprint += key.size() + value.size() + ATTR_OVERHEAD;
 
-    //Generate the instances.
-    format += "FACT TUPLE :\n";
-    ifstream instances(instanceFN);
-    if (instances.is_open()) while(getline(instances, curLine)) format += curLine + "\n";
-    instances.close();
+    return added;
+}
 
-    //Generate the relations.
-    ifstream relations(relationFN);
-    if (relations.is_open()) while(getline(relations, curLine)) format += curLine + "\n";
-    relations.close();
-    format += "\n";
+/**
+ * Adds an attribute to an edge in the graph.
+ * @param IDSrc The source ID.
+ * @param IDDst The destination ID.
+ * @param type The edge type.
+ * @param key The attribute key.
+ * @param value The attribute value.
+ * @return Whether it was added.
+ */
+bool LowMemoryTAGraph::addAttribute(string IDSrc, string IDDst, ClangEdge::EdgeType type, string key,
+                                    string value){
+    bool added = TAGraph::addAttribute(IDSrc, IDDst, type, key, value);
+    if (added) footprint += key.size() + value.size() + ATTR_OVERHEAD;
 
-    //Generate the attributes.
-    format += "FACT ATTRIBUTE :\n";
-    ifstream attributes(attributeFN);
-    if (attributes.is_open()) while(getline(attributes, curLine)) format += curLine + "\n";
-    attributes.close();
+    return added;
+}
+
+/**
+ * Writes the TA for this graph straight to a file. Instances go to the file as
+ * they're read while relations and attributes are staged next to the log and
+ * then copied onto the end, so the model is never held in memory.
+ * @param fileName The file to write.
+ * @return Whether the file was written.
+ */
+bool LowMemoryTAGraph::writeTAFormat(string fileName) {
+    waitForSpills();
+    TraceRecorder::Span span("writeTA", fileName);
+
+    string relationFN = logFN + ".relations";
+    string attributeFN = logFN + ".attributes";
+    vector<char> taBuffer(IO_BUFFER_SIZE), relBuffer(IO_BUFFER_SIZE), attrBuffer(IO_BUFFER_SIZE);
+
+    //Opens the output and the staging files.
+    ofstream taFile, relFile, attrFile;
+    taFile.rdbuf()->pubsetbuf(taBuffer.data(), taBuffer.size());
+    relFile.rdbuf()->pubsetbuf(relBuffer.data(), relBuffer.size());
+    attrFile.rdbuf()->pubsetbuf(attrBuffer.data(), attrBuffer.size());
+    taFile.open(fileName, ios::out | ios::trunc);
+    relFile.open(relationFN, ios::out | ios::trunc);
+    attrFile.open(attributeFN, ios::out | ios::trunc);
+
+    bool succ = taFile.is_open() && relFile.is_open() && attrFile.is_open();
+    if (succ) {
+        taFile << generateTAHeader() << "FACT TUPLE :\n";
+
+        //Converts each record in the log.
+        GraphLog log(logFN);
+        GraphLog::LogRecord record;
+        succ = log.openReader();
+        if (succ) {
+            while (log.next(record)) {
+                if (record.type == GraphLog::INSTANCE) {
+                    taFile << INSTANCE_FLAG << " " << record.fields.at(0) << " " << record.fields.at(1) << "\n";
+                } else if (record.type == GraphLog::RELATION) {
+                    relFile << record.fields.at(0) << " " << record.fields.at(1) << " " << record.fields.at(2) << "\n";
+                } else if (record.type == GraphLog::ATTRIBUTE) {
+                    attrFile << generateAttributeLine(record.fields.at(0), record.attributes) << "\n";
+                } else if (record.type == GraphLog::REL_ATTRIBUTE) {
+                    string relID = "(" + record.fields.at(0) + " " + record.fields.at(1) + " " +
+                                   record.fields.at(2) + ")";
+                    attrFile << generateAttributeLine(relID, record.attributes) << "\n";
+                }
+            }
+        }
+        relFile << "\nFACT ATTRIBUTE :\n";
+    }
+    taFile.close();
+    relFile.close();
+    attrFile.close();
+    succ = succ && !taFile.fail() && !relFile.fail() && !attrFile.fail();
+
+    //Copies the staged sections onto the output.
+    {
+        TraceRecorder::Span appendSpan("appendSections", fileName);
+        succ = succ && appendFile(relationFN, fileName) && appendFile(attributeFN, fileName);
+    }
+    deleteFile(relationFN);
+    deleteFile(attributeFN);
 
-    return format;
+    return succ;
 }
 
 /**
@@ -227,282 +318,284 @@ void LowMemoryTAGraph::resolveFiles(ClangExclude exclusions){
 }
 
 /**
- * Resolves external references.
+ * Resolves external references. Instances and relations are sorted on disk
+ * and merge-joined so memory stays within the budget.
  * @param print The printer that prints messages.
- * @param silent Whether we should print silently.
+ * @param silent Whether we should print silently. Errors are always printed.
+ * @return Whether the log was resolved. If not, the log is left as it was.
  */
-void LowMemoryTAGraph::resolveExternalReferences(Printer* print, bool silent) {
+bool LowMemoryTAGraph::resolveExternalReferences(Printer* print, bool silent) {
     //First, purge the current graph.
     purgeCurrentGraph();
+    waitForSpills();
+
+    //Sets up the sorters next to the log. Up to three are held at once and share
+    //what's left of the budget after the compacted log's string table.
+    string tempDir = bs::path(logFN).parent_path().string();
+    string baseName = to_string(fileNumber) + "-";
+    string idFile = compactLogFN + ".ids";
+    size_t sorterBudget = (memBudget - memBudget / TABLE_SHARE) / NUM_HELD_SORTERS;
+    unique_ptr<ExternalSorter> instances(new ExternalSorter(tempDir, baseName + "instances", sorterBudget));
+    unique_ptr<ExternalSorter> relations(new ExternalSorter(tempDir, baseName + "relations", sorterBudget));
+
+    //Sorts the instances and relations.
+    GraphLog compact(compactLogFN);
+    compact.setTableBudget(memBudget / TABLE_SHARE);
+    bool sorted;
+    {
+        TraceRecorder::Span span("sortLog");
+        sorted = sortLog(*instances, *relations);
+    }
+    if (!sorted || !compact.openWriter(false)){
+        print->printErrorResolve(logFN);
+        return false;
+    }
 
-    //Generate a map of the instances.
-    unordered_map<string, string> instanceMap;
-    ifstream instances(instanceFN);
-    if (!instances.is_open()) return;
-
-    string curLine;
-    while (getline(instances, curLine)){
-        vector<string> lineSplit = tokenize(curLine);
-        if (lineSplit.size() != 3) continue;
-
-        //Checks whether instance already exists.
-        if (instanceMap.find(lineSplit.at(1)) == instanceMap.end()){
-            instanceMap[lineSplit.at(1)] = lineSplit.at(2);
+    //Sets up the joiner to write the compacted log.
+    ModelJoiner::JoinSink sink;
+    sink.instance = [&](const string& ID, const string& type){
+        compact.writeInstance(ID, type);
+        return true;
+    };
+    sink.relation = [&](const string& rel, const string& src, const string& dst){
+        compact.writeRelation(rel, src, dst);
+        return true;
+    };
+    sink.entityAttributes = [&](const string& ID, const GraphLog::AttributeList& attrs){
+        compact.writeAttributes(ID, attrs);
+        return true;
+    };
+    sink.relationAttributes = [&](const string& rel, const string& src, const string& dst,
+                                  const GraphLog::AttributeList& attrs){
+        compact.writeRelAttributes(rel, src, dst, attrs);
+        return true;
+    };
+    ModelJoiner joiner(sink);
+
+    //Writes the instances and joins the relations on both ends. Kept relations are marked as valid.
+    unique_ptr<ExternalSorter> relAttributes(new ExternalSorter(tempDir, baseName + "relAttributes", sorterBudget));
+    bool succ;
+    {
+        TraceRecorder::Span span("joinRelations");
+        succ = joiner.writeInstances(*instances, idFile);
+        instances.reset();
+        if (succ) {
+            ExternalSorter joined(tempDir, baseName + "joined", sorterBudget);
+            succ = joiner.joinRelations(*relations, joined, idFile);
+            relations.reset();
+            if (succ) succ = joiner.writeRelations(joined, *relAttributes, idFile);
         }
     }
-    instances.close();
-    deleteFile(instanceFN);
-
-    //Next, resolves the relations.
-    bs::path org = relationFN;
-    bs::path dst = mvRelationFN;
-    rename(org, dst);
-
-    vector<string> removedRels;
-
-    ifstream original(mvRelationFN);
-    ofstream destination(relationFN, std::ios_base::out);
-    if (!original.is_open() || !destination.is_open()) return;
-    while(getline(original, curLine)){
-        vector<string> lineSplit = tokenize(curLine);
-        if (lineSplit.size() != 3) continue;
-
-        //Checks if the relation can be resolved.
-        if (instanceMap.find(lineSplit.at(1)) == instanceMap.end() ||
-                instanceMap.find(lineSplit.at(2)) == instanceMap.end()){
-            removedRels.push_back(lineSplit.at(0) + " " + lineSplit.at(1) + " " + lineSplit.at(2));
-            continue;
-        }
+    numResolved = joiner.getNumRelations();
+    numUnresolved = joiner.getNumDangling();
+
+    //Compacts the attributes of the instances and relations that were kept.
+    if (succ) {
+        TraceRecorder::Span span("compactAttributes");
+        ExternalSorter attributes(tempDir, baseName + "attributes", sorterBudget);
+        succ = sortAttributes(attributes, *relAttributes) && joiner.writeAttributes(attributes, idFile) &&
+               joiner.writeRelAttributes(*relAttributes);
+    }
+    relAttributes.reset();
+    deleteFile(idFile);
+
+    //Replaces the log with the compacted one.
+    if (succ) compact.writeCommit(curFileNum, curFileName);
+    bool replaced = compact.closeWriter() && succ && syncFile(compactLogFN);
+    boost::system::error_code error;
+    if (replaced) bs::rename(bs::path(compactLogFN), bs::path(logFN), error);
+    if (!replaced || error){
+        deleteFile(compactLogFN);
+        print->printErrorResolve(logFN);
+        return false;
+    }
+    writeCheckpoint(curFileNum, curFileName);
 
-        destination << curLine << "\n";
+    //Afterwards, notify of success.
+    if (!silent){
+        print->printSpillStats(spillRawBytes, spillCompressedBytes, spillSeconds);
+        print->printResolveRefDone(numResolved, numUnresolved);
     }
-    original.close();
-    destination.close();
-    deleteFile(mvRelationFN);
-
-    //Compress attributes.
-    unordered_map<string, vector<pair<string, vector<string>>>> attrMap;
-    ifstream attributes(attributeFN);
-    if (!attributes.is_open()) return;
-
-    while(getline(attributes, curLine)) {
-        //Prepare the line.
-        vector<string> entry = tokenize(curLine);
-
-        //Checks for what type of system we're dealing with.
-        if (entry.at(0).compare("(") == 0 || entry.at(0).find("(") == 0) {
-            //Relation attribute.
-            string relID = entry.at(0) + " " + entry.at(1) + " " + entry.at(2);
-            relID.erase(0, 1);
-            relID.erase(relID.size() - 1);
-
-            //Check if the relationID matches.
-            if (find(removedRels.begin(), removedRels.end(), relID) != removedRels.end()){
-                continue;
-            }
 
-            //Generates the attribute list.
-            relID = "(" + relID + ")";
-            entry.erase(entry.begin(), entry.begin() + 3);
-            auto attrs = generateStrAttributes(entry);
-            if (attrs.size() == 0) continue;
-
-            //Find the attributes.
-            if (attrMap.find(relID) == attrMap.end()){
-                attrMap[relID] = attrs;
-            } else {
-                //Compact the attributes.
-                auto currentAttrs = attrMap[relID];
-
-                for (auto curA : attrs){
-                    bool found = false;
-                    for (auto cAI : currentAttrs){
-                        if (cAI.first == curA.first){
-                            found = true;
-
-                            auto cAIVal = cAI.second;
-                            for (auto val : curA.second){
-                                if (find(cAIVal.begin(), cAIVal.end(), val) == cAIVal.end()){
-                                    cAIVal.push_back(val);
-                                }
-                            }
-                            break;
-                        }
-                    }
-
-                    if (!found){
-                        currentAttrs.push_back(curA);
-                    }
-                }
+    return true;
+}
 
-                attrMap[relID] = currentAttrs;
-            }
-        } else {
-            //Regular attribute.
-            //Gets the name and trims down the vector.
-            string attrName = entry.at(0);
-            entry.erase(entry.begin());
-
-            //Generates the attribute list.
-            auto attrs = generateStrAttributes(entry);
-            if (attrs.size() == 0) continue;
-
-            //Find the attributes.
-            if (attrMap.find(attrName) == attrMap.end()){
-                attrMap[attrName] = attrs;
-            } else {
-                //Compact the attributes.
-                auto currentAttrs = attrMap[attrName];
-
-                for (auto curA : attrs){
-                    bool found = false;
-                    for (auto cAI : currentAttrs){
-                        if (cAI.first == curA.first){
-                            found = true;
-
-                            auto cAIVal = cAI.second;
-                            for (auto val : curA.second){
-                                if (find(cAIVal.begin(), cAIVal.end(), val) == cAIVal.end()){
-                                    cAIVal.push_back(val);
-                                }
-                            }
-                            break;
-                        }
-                    }
-
-                    if (!found){
-                        currentAttrs.push_back(curA);
-                    }
-                }
+/**
+ * Moves everything another graph has spilled into this one. The other log is
+ * copied onto the end of ours as-is, so the two can be resolved together.
+ * @param other The graph to absorb. Its files are removed when it's deleted.
+ * @return Whether the log was copied.
+ */
+bool LowMemoryTAGraph::absorb(LowMemoryTAGraph* other){
+    TraceRecorder::Span span("absorb");
+    other->purgeCurrentGraph();
+    other->waitForSpills();
+    purgeCurrentGraph();
+    waitForSpills();
 
-                attrMap[attrName] = currentAttrs;
-            }
-        }
-    }
-    attributes.close();
-
-    //Write the attributes.
-    ofstream destAttr(attributeFN, std::ios_base::out);
-    if (!destAttr.is_open()) return;
-    for (auto entry : attrMap){
-        string attrLine = entry.first + " { ";
-
-        for (auto entries : entry.second){
-            attrLine += entries.first + " = ";
-            if (entries.second.size() == 1) attrLine += entries.second.at(0) + " ";
-            else {
-                attrLine += "( ";
-                for (auto curVal : entries.second) attrLine += curVal + " ";
-                attrLine += ") ";
-            }
+    //Copies the log and the paths that were seen.
+    if (!appendFile(other->logFN, logFN)) return false;
+    for (string path : other->getPaths()) addPath(path);
+
+    size_t numOld = writtenKeys.size();
+    writtenKeys.insert(writtenKeys.end(), other->writtenKeys.begin(), other->writtenKeys.end());
+    inplace_merge(writtenKeys.begin(), writtenKeys.begin() + numOld, writtenKeys.end());
+    writtenKeys.erase(unique(writtenKeys.begin(), writtenKeys.end()), writtenKeys.end());
+
+    //The last commit came from the other log, so commit again under our own recovery point.
+    purgeCurrentGraph();
+    waitForSpills();
+    return true;
+}
+
+/**
+ * Changes how much memory the graph can use. The graph is purged when it nears
+ * the budget and resolution splits it between its sorters.
+ * @param budget The budget in bytes.
+ */
+void LowMemoryTAGraph::setMemBudget(size_t budget){
+    memBudget = budget;
+}
+
+/**
+ * Sorts the instances by ID and the relations by source.
+ * @param instances The sorter for instances.
+ * @param relations The sorter for relations.
+ * @return Whether the log was sorted.
+ */
+bool LowMemoryTAGraph::sortLog(ExternalSorter& instances, ExternalSorter& relations){
+    GraphLog log(logFN);
+    GraphLog::LogRecord record;
+    if (!log.openReader()) return false;
+
+    //The sequence number keeps the first declaration of an instance first.
+    codec.resetSeq();
+    while (log.next(record)){
+        bool succ = true;
+        if (record.type == GraphLog::INSTANCE) {
+            succ = instances.add(record.fields.at(0) + RecordCodec::FIELD_SEP + codec.nextSeq() +
+                                 RecordCodec::FIELD_SEP + record.fields.at(1));
+        } else if (record.type == GraphLog::RELATION) {
+            succ = relations.add(record.fields.at(1) + RecordCodec::FIELD_SEP + record.fields.at(0) +
+                                 RecordCodec::FIELD_SEP + record.fields.at(2));
         }
-        destAttr << attrLine + " }\n";
+
+        if (!succ) return false;
     }
-    attrMap.clear();
-    destAttr.close();
 
-    //Write the instances.
-    ofstream outI(instanceFN);
-    if (!outI.is_open()) return;
+    return instances.sort() && relations.sort();
+}
+
+/**
+ * Reads the attributes from the log into the sorters.
+ * @param attributes Sorter for entity attributes, keyed by ID.
+ * @param relAttributes Sorter for relation attributes, keyed by relation.
+ * @return Whether the attributes were sorted.
+ */
+bool LowMemoryTAGraph::sortAttributes(ExternalSorter& attributes, ExternalSorter& relAttributes){
+    GraphLog log(logFN);
+    GraphLog::LogRecord record;
+    if (!log.openReader()) return false;
+
+    while (log.next(record)){
+        bool succ = true;
+        if (record.type == GraphLog::ATTRIBUTE) {
+            succ = attributes.add(record.fields.at(0) + RecordCodec::FIELD_SEP + codec.nextSeq() +
+                                  RecordCodec::FIELD_SEP + RecordCodec::encodeAttributes(record.attributes));
+        } else if (record.type == GraphLog::REL_ATTRIBUTE) {
+            succ = relAttributes.add(record.fields.at(1) + RecordCodec::FIELD_SEP + record.fields.at(0) +
+                                     RecordCodec::FIELD_SEP + record.fields.at(2) + RecordCodec::FIELD_SEP +
+                                     RecordCodec::ATTR_FLAG + RecordCodec::FIELD_SEP + codec.nextSeq() +
+                                     RecordCodec::FIELD_SEP + RecordCodec::encodeAttributes(record.attributes));
+        }
 
-    for (auto it : instanceMap) {
-        outI << INSTANCE_FLAG << " " << it.first << " " << it.second << "\n";
+        if (!succ) return false;
     }
-    outI.close();
+
+    return attributes.sort() && relAttributes.sort();
 }
 
 /**
- * Adds nodes to a file system.
- * @param fileSkip Whether we skip files.
+ * Adds nodes to a file system. The spilled attributes are read in one pass
+ * and each file attribute is looked up in the path index.
  */
-void LowMemoryTAGraph::addNodesToFile(std::map<std::string, ClangNode*> fileSkip){
+void LowMemoryTAGraph::addNodesToFile(){
+    waitForSpills();
+
     //Load in each attribute.
-    ifstream attributes(attributeFN);
-    if (!attributes.is_open()) return;
-
-    string current;
-    while (getline(attributes, current)){
-        boost::algorithm::trim(current);
-
-        //Check for a relation attribute.
-        if (current.at(0) == '(') continue;
-
-        //Get the name and attributes.
-        string name = current.substr(0, current.find(" { "));
-        string attrs = current.substr(current.find(" { ") + 3);
-        attrs.pop_back();
-        attrs.pop_back();
-
-        //Split by space.
-        vector<string> tokens;
-        boost::algorithm::split(tokens, attrs, boost::is_any_of(" "));
-
-        //Process the attributes.
-        string attrValue;
-        int pos = 0;
-        bool doNotCheck = false;
-        for (string curTok : tokens){
-            boost::algorithm::trim(curTok);
-
-            //Check the value of pos.
-            if (pos == 0){
-                if (curTok == FILE_ATTRIBUTE){
-                    doNotCheck = false;
-                } else {
-                    doNotCheck = true;
-                }
-            } else if (pos == 2 ) {
-                pos = -1;
-                if (doNotCheck == true) {
-                    pos = 0;
-                    continue;
-                }
+    GraphLog log(logFN);
+    GraphLog::LogRecord record;
+    if (!log.openReader()) return;
 
-                //Add the file node.
-                string file = curTok;
-                ClangNode* fileNode;
-                if (file.compare("") != 0) {
-                    //Find the appropriate node.
-                    vector<ClangNode*> fileVec = findNodeByName(file);
-                    if (fileVec.size() > 0) {
-                        fileNode = fileVec.at(0);
-
-                        //We now look up the file node.
-                        auto ptrSkip = fileSkip.find(file);
-                        if (ptrSkip != fileSkip.end()) {
-                            ClangNode *skip = ptrSkip->second;
-                            fileNode = skip;
-                        }
-                    } else {
-                        continue;
-                    }
-
-                    //Add it to the graph.
-                    ClangEdge *edge = new ClangEdge(fileNode, file, ClangEdge::FILE_CONTAIN);
-                    addEdge(edge);
-                }
-            }
+    while (log.next(record)){
+        if (record.type != GraphLog::ATTRIBUTE) continue;
+
+        //Finds the file attribute.
+        for (auto const& attr : record.attributes){
+            if (attr.first != FILE_ATTRIBUTE || attr.second.size() != 1) continue;
 
-            pos++;
+            ClangNode* fileNode = findFileNode(attr.second.at(0));
+            if (!fileNode) continue;
+
+            //Add it to the graph.
+            ClangEdge *edge = new ClangEdge(fileNode, record.fields.at(0), ClangEdge::FILE_CONTAIN);
+            addEdge(edge);
         }
     }
-
-    attributes.close();
 }
 
 /**
- * Dumps the current file to disk.
+ * Records the file that is about to be walked. Segments written from here on
+ * are tagged with it, since it's the first file not fully on disk.
  * @param fileNum The file number.
- * @param file The file to dump.
+ * @param file The file being walked.
  */
 void LowMemoryTAGraph::dumpCurrentFile(int fileNum, string file){
-    //Opens the file list.
-    std::ofstream curFile(curFileFN);
-    if (!curFile.is_open()) return;
+    curFileNum = fileNum;
+    curFileName = file;
+
+    //If nothing has been added since the last purge, that batch holds every earlier file.
+    if (footprint > 0) return;
+    lock_guard<mutex> lock(spillMutex);
+    if (pendingBatches.size() > 0){
+        pendingBatches.back()->fileNum = fileNum;
+        pendingBatches.back()->file = file;
+    }
+}
+
+/**
+ * Writes the file that recovery should start from. The file is replaced
+ * atomically so a crash leaves either the old or the new point.
+ * @param fileNum The file number.
+ * @param file The file to start from.
+ */
+void LowMemoryTAGraph::writeCheckpoint(int fileNum, string file){
+    string tempFN = curFileFN + ".tmp";
 
     //Writes the current file.
+    std::ofstream curFile(tempFN);
+    if (!curFile.is_open()) return;
     curFile << fileNum << endl << file;
     curFile.close();
+
+    if (curFile.fail() || !syncFile(tempFN)) return;
+    rename(tempFN.c_str(), curFileFN.c_str());
+}
+
+/**
+ * Rolls a graph's log back to its last committed segment after a crash.
+ * @param basePath The directory holding the graph.
+ * @param curNum The graph number.
+ * @return The first file that must be walked again.
+ */
+int LowMemoryTAGraph::rollback(string basePath, int curNum){
+    string logFN = bs::weakly_canonical(bs::path(basePath + "/" + to_string(curNum) + "-" + BASE_LOG_FN)).string();
+
+    GraphLog log(logFN);
+    GraphLog::LogRecord commit;
+    if (!log.rollback(commit)) return 0;
+
+    return stoi(commit.fields.at(0));
 }
 
 /**
@@ -510,8 +603,10 @@ void LowMemoryTAGraph::dumpCurrentFile(int fileNum, string file){
  * @param files The files being processed.
  * @param exclude The exclusions.
  * @param blobMode Blob mode toggle.
+ * @param group The graph this one gets merged into when recovered. Defaults to itself.
  */
-void LowMemoryTAGraph::dumpSettings(vector<bs::path> files, TAGraph::ClangExclude exclude, bool blobMode){
+void LowMemoryTAGraph::dumpSettings(vector<bs::path> files, TAGraph::ClangExclude exclude, bool blobMode,
+                                    int group){
     //Opens the file.
     std::ofstream curSettings(settingFN);
     if (!curSettings.is_open()) return;
@@ -526,7 +621,8 @@ void LowMemoryTAGraph::dumpSettings(vector<bs::path> files, TAGraph::ClangExclud
     //Next, dump the excludes.
     curSettings << exclude.cClass << exclude.cEnum << exclude.cFile << exclude.cFunction << exclude.cStruct <<
                 exclude.cSubSystem << exclude.cUnion << exclude.cVariable;
-    curSettings << blobMode;
+    curSettings << blobMode << endl;
+    curSettings << ((group < 0) ? fileNumber : group);
     curSettings.close();
 }
 
@@ -540,6 +636,20 @@ bool LowMemoryTAGraph::doesFileExist(string fN){
     return (stat (fN.c_str(), &buffer) == 0);
 }
 
+/**
+ * Flushes a file to stable storage.
+ * @param fN The file to sync.
+ * @return Whether the file was synced.
+ */
+bool LowMemoryTAGraph::syncFile(string fN){
+    int fd = open(fN.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    bool succ = fsync(fd) == 0;
+    close(fd);
+    return succ;
+}
+
 /**
  * Deletes a file.
  * @param fN The file to delete.
@@ -548,6 +658,59 @@ void LowMemoryTAGraph::deleteFile(string fN) {
     remove(fN.c_str());
 }
 
+/**
+ * Copies one file onto the end of another. The kernel does the copy where it
+ * can, otherwise we fall back to large block copies.
+ * @param srcFN The file to copy.
+ * @param dstFN The file to append to.
+ * @return Whether the file was copied.
+ */
+bool LowMemoryTAGraph::appendFile(string srcFN, string dstFN){
+    int src = open(srcFN.c_str(), O_RDONLY);
+    if (src < 0) return false;
+    int dst = open(dstFN.c_str(), O_WRONLY | O_APPEND);
+    if (dst < 0){
+        close(src);
+        return false;
+    }
+
+    struct stat srcStat;
+    bool succ = fstat(src, &srcStat) == 0;
+    off_t remaining = (succ) ? srcStat.st_size : 0;
+
+#ifdef __linux__
+    //Lets the kernel move the data directly.
+    while (remaining > 0){
+        ssize_t sent = sendfile(dst, src, nullptr, (size_t) remaining);
+        if (sent <= 0) break;
+        remaining -= sent;
+    }
+#endif
+
+    //Copies whatever is left in blocks.
+    vector<char> buffer(IO_BUFFER_SIZE);
+    while (succ && remaining > 0){
+        ssize_t numRead = read(src, buffer.data(), buffer.size());
+        if (numRead <= 0){
+            succ = false;
+            break;
+        }
+
+        for (ssize_t written = 0; written < numRead;){
+            ssize_t cur = write(dst, buffer.data() + written, (size_t) (numRead - written));
+            if (cur <= 0){
+                succ = false;
+                break;
+            }
+            written += cur;
+        }
+        remaining -= numRead;
+    }
+
+    close(src);
+    return close(dst) == 0 && succ;
+}
+
 /**
  * Alters whether we purge.
  * @param purge The purge toggle.
@@ -557,144 +720,210 @@ void LowMemoryTAGraph::setPurgeStatus(bool purge){
 }
 
 /**
- * Dumps the current TA to disk.
+ * Dumps the current TA to disk. The graph is handed to a background writer
+ * as a batch and a fresh graph is started. We only wait if too many batches
+ * are already waiting to be written.
  */
 void LowMemoryTAGraph::purgeCurrentGraph(){
     if (!purge) return;
+    TraceRecorder::Span span("purge", curFileName);
+    markWritten();
+
+    //Swaps out the graph. The file being walked is only partly in this batch.
+    SpillBatch* batch = new SpillBatch();
+    batch->fileNum = curFileNum;
+    batch->file = curFileName;
+    batch->nodes.swap(nodeList);
+    batch->edges.swap(edgeSrcList);
+    edgeDstList.clear();
+    nodeNameList.clear();
+    footprint = 0;
+
+    //Queues the batch for writing.
+    {
+        unique_lock<mutex> lock(spillMutex);
+        spillCond.wait(lock, [this](){
+            return pendingBatches.size() + ((activeBatch != nullptr) ? 1 : 0) < MAX_IN_FLIGHT;
+        });
+        pendingBatches.push_back(batch);
+    }
+    spillCond.notify_all();
 
-    //Start by writing everything to disk.
-    ofstream instances(instanceFN, std::ios::out | std::ios::app);
-    if (!instances.is_open()) return;
-    instances << generateInstances();
-    instances.close();
-
-    ofstream relations(relationFN, std::ios::out | std::ios::app);
-    if (!relations.is_open()) return;
-    relations << generateRelationships();
-    relations.close();
-
-    ofstream attributes(attributeFN, std::ios::out | std::ios::app);
-    if (!attributes.is_open()) return;
-    attributes << generateAttributes();
-    attributes.close();
+    if (!writer.joinable()) writer = thread(&LowMemoryTAGraph::runWriter, this);
+}
 
-    //Clear the graph.
-    clearGraph();
+/**
+ * Waits until every purged batch is on disk.
+ */
+void LowMemoryTAGraph::waitForSpills(){
+    unique_lock<mutex> lock(spillMutex);
+    spillCond.wait(lock, [this](){ return pendingBatches.size() == 0 && activeBatch == nullptr; });
 }
 
 /**
- * Gets the number of entities in the graph.
- * @return The number of entities in the graph.
+ * Runs the background writer. Batches are written in the order they were purged.
  */
-int LowMemoryTAGraph::getNumberEntities(){
-    //Get the number of keys in the graph.
-    auto curAmnt = (int) nodeList.size();
-    return curAmnt;
+void LowMemoryTAGraph::runWriter(){
+    TraceRecorder::nameThread("spill writer " + to_string(fileNumber));
+    unique_lock<mutex> lock(spillMutex);
+    while (true){
+        spillCond.wait(lock, [this](){ return pendingBatches.size() > 0 || stopWriter; });
+        if (pendingBatches.size() == 0) return;
+
+        activeBatch = pendingBatches.front();
+        pendingBatches.pop_front();
+        lock.unlock();
+
+        writeBatch(activeBatch);
+
+        lock.lock();
+        delete activeBatch;
+        activeBatch = nullptr;
+        spillCond.notify_all();
+    }
 }
 
 /**
- * Tokenizes the string based on a space.
- * @param curString The current string to split.
- * @return A vector of tokens.
+ * Writes a batch to the log as one committed segment and frees it. The
+ * recovery point only moves once the segment is on stable storage.
+ * @param batch The batch to write.
  */
-vector<string> LowMemoryTAGraph::tokenize(string curString){
-    vector<string> tokens;
+void LowMemoryTAGraph::writeBatch(SpillBatch* batch){
+    TraceRecorder::Span span("spill", batch->file);
+    GraphLog log(logFN);
+    log.setTableBudget(memBudget / TABLE_SHARE);
+    bool opened = log.openWriter();
+
+    for (auto it = batch->nodes.begin(); it != batch->nodes.end(); it++){
+        ClangNode* node = it->second;
+        if (!node) continue;
+
+        if (opened){
+            log.writeInstance(node->getID(), ClangNode::getTypeString(node->getType()));
+            log.writeAttributes(node->getID(), node->getAttributes());
+        }
+        delete node;
+    }
+
+    for (auto it = batch->edges.begin(); it != batch->edges.end(); it++){
+        for (ClangEdge* edge : it->second){
+            if (opened){
+                string rel = ClangEdge::getTypeString(edge->getType());
+
+                log.writeRelation(rel, edge->getSrcID(), edge->getDstID());
+                log.writeRelAttributes(rel, edge->getSrcID(), edge->getDstID(), edge->getAttributes());
+            }
+            delete edge;
+        }
+    }
+
+    //Commits the segment and moves the recovery point past it.
+    if (opened) log.writeCommit(batch->fileNum, batch->file);
+    bool committed = log.closeWriter() && opened && syncFile(logFN);
+    if (committed) writeCheckpoint(batch->fileNum, batch->file);
+
+    spillRawBytes += log.getRawBytes();
+    spillCompressedBytes += log.getCompressedBytes();
+    spillSeconds += log.getCompressSeconds();
+
+    batch->nodes.clear();
+    batch->edges.clear();
+}
 
-    boost::split(tokens, curString, boost::is_any_of(" "), boost::token_compress_on);
-    return tokens;
+/**
+ * Checks whether the graph is close to its memory budget.
+ * @return Whether the graph should be purged.
+ */
+bool LowMemoryTAGraph::isNearBudget(){
+    return footprint >= (size_t) (memBudget * PURGE_THRESHOLD);
 }
 
 /**
- * Generate a set of attributes based on a vector of tokens.
- * @param line The vector of tokens.
- * @return A vector of attributes.
+ * Estimates how much memory a node uses in the graph.
+ * @param node The node to estimate.
+ * @return The approximate number of bytes.
  */
-vector<pair<string, vector<string>>> LowMemoryTAGraph::generateStrAttributes(std::vector<std::string> line){
-    if (line.size() < 3){
-        return vector<pair<string, vector<string>>>();
+size_t LowMemoryTAGraph::getNodeSize(ClangNode* node){
+    //The ID and name are also kept as keys in the lookup tables.
+    size_t size = NODE_OVERHEAD + 2 * (node->getID().size() + node->getName().size());
+    for (auto const& attr : node->getAttributes()){
+        for (auto const& value : attr.second) size += attr.first.size() + value.size() + ATTR_OVERHEAD;
     }
 
-    //Start by expecting the { symbol.
-    if (line.at(0).compare("{") == 0){
-        line.erase(line.begin());
-    } else if (line.at(0).find("{") == 0){
-        line.at(0).erase(0, 1);
-    } else {
-        return vector<pair<string, vector<string>>>();
+    return size;
+}
+
+/**
+ * Estimates how much memory an edge uses in the graph.
+ * @param edge The edge to estimate.
+ * @return The approximate number of bytes.
+ */
+size_t LowMemoryTAGraph::getEdgeSize(ClangEdge* edge){
+    //The source and destination are also kept as keys in the lookup tables.
+    size_t size = EDGE_OVERHEAD + 2 * (edge->getSrcID().size() + edge->getDstID().size());
+    for (auto const& attr : edge->getAttributes()){
+        for (auto const& value : attr.second) size += attr.first.size() + value.size() + ATTR_OVERHEAD;
     }
 
-    //Now, we iterate until we hit the end.
-    int i = 0;
-    bool end = false;
-    string current = line.at(i);
-    vector<pair<string, vector<string>>> attrList = vector<pair<string, vector<string>>>();
-    do {
-        //Adds in the first part of the entry.
-        pair<string, vector<string>> currentEntry = pair<string, vector<string>>();
-        currentEntry.first = current;
-
-        //Checks for validity.
-        if (i + 2 >= line.size() || line.at(++i).compare("=") != 0){
-            return vector<pair<string, vector<string>>>();
-        }
+    return size;
+}
 
-        //Gets the next KV pair.
-        string next = line.at(++i);
-        if (next.compare("(") == 0 || next.find("(") == 0) {
-            //First, remove the ( symbol.
-            if (next.compare("(") == 0){
-                if (i + 1 == line.size()){
-                    return vector<pair<string, vector<string>>>();
-                }
-                next = line.at(++i);
-            } else if (next.find("(") == 0){
-                next.erase(0, 1);
-            }
+/**
+ * Gets the key used to remember that an edge was spilled.
+ * @param edge The edge to look up.
+ * @return The hash of the edge.
+ */
+size_t LowMemoryTAGraph::getEdgeKey(ClangEdge* edge){
+    return hash<string>()(edge->getSrcID() + RecordCodec::FIELD_SEP + edge->getDstID() + RecordCodec::FIELD_SEP +
+                          ClangEdge::getTypeString(edge->getType()));
+}
 
-            //We now iterate through the attribute list.
-            bool endList = false;
-            do {
-                //Check if we hit the end.
-                if (next.compare(")") == 0) {
-                    break;
-                } else if (next.find(")") == next.size() - 1) {
-                    next.erase(next.size() - 1, 1);
-                    endList = true;
-                }
+/**
+ * Checks whether a node or edge was already spilled.
+ * @param key The hash of the node ID or edge.
+ * @return Whether it was spilled.
+ */
+bool LowMemoryTAGraph::wasWritten(size_t key){
+    return binary_search(writtenKeys.begin(), writtenKeys.end(), key);
+}
 
-                //Next, process the item.
-                currentEntry.second.push_back(next);
+/**
+ * Remembers every node and edge in the current graph as spilled. Only hashes
+ * are kept so this stays small next to the graph itself.
+ */
+void LowMemoryTAGraph::markWritten(){
+    size_t numOld = writtenKeys.size();
+    for (auto it = nodeList.begin(); it != nodeList.end(); it++) writtenKeys.push_back(hash<string>()(it->first));
+    for (auto it = edgeSrcList.begin(); it != edgeSrcList.end(); it++){
+        for (ClangEdge* edge : it->second) writtenKeys.push_back(getEdgeKey(edge));
+    }
 
-                //Finally check if we've hit the conditions.
-                if (endList){
-                    break;
-                } else if (i + 1 == line.size()){
-                    return vector<pair<string, vector<string>>>();
-                } else {
-                    next = line.at(++i);
-                }
-            } while (true);
-        } else {
-            //Check if we have a "} symbol at the end.
-            if (next.find("}") == next.size() - 1){
-                end = true;
-                next.erase(next.size() - 1, 1);
-            }
+    //Merges the new keys in.
+    sort(writtenKeys.begin() + numOld, writtenKeys.end());
+    inplace_merge(writtenKeys.begin(), writtenKeys.begin() + numOld, writtenKeys.end());
+    writtenKeys.erase(unique(writtenKeys.begin(), writtenKeys.end()), writtenKeys.end());
+}
 
-            //Add it to the current entry.
-            currentEntry.second.push_back(next);
-        }
+/**
+ * Generates an attribute line for an entity or relation.
+ * @param name The ID of the entity or the bracketed relation.
+ * @param attrs The attributes to print.
+ * @return The attribute line.
+ */
+string LowMemoryTAGraph::generateAttributeLine(string name, const GraphLog::AttributeList& attrs){
+    string attrLine = name + " {";
 
-        //Increments the current string.
-        if (i + 1 == line.size() && end == false){
-            return vector<pair<string, vector<string>>>();
-        } else if (!end){
-            current = line.at(++i);
+    for (auto const& entry : attrs){
+        attrLine += " " + entry.first + " = ";
+        if (entry.second.size() == 1) {
+            attrLine += "\"" + entry.second.at(0) + "\"";
+        } else {
+            attrLine += "(";
+            for (auto const& curVal : entry.second) attrLine += " \"" + curVal + "\"";
+            attrLine += " )";
         }
+    }
+    attrLine += " }";
 
-        //Adds the entry in.
-        attrList.push_back(currentEntry);
-    } while (current.compare("}") != 0 && end == false);
-
-    return attrList;
+    return attrLine;
 }
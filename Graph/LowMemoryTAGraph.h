@@ -27,9 +27,17 @@
 #define CLANGEX_LOWMEMORYTAGRAPH_H
 
 #include <string>
+#include <atomic>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include <boost/filesystem.hpp>
 #include "../Printer/Printer.h"
 #include "TAGraph.h"
+#include "GraphLog.h"
+#include "../TupleAttribute/ExternalSorter.h"
+#include "../TupleAttribute/RecordCodec.h"
 
 class LowMemoryTAGraph : public TAGraph {
 public:
@@ -41,57 +49,121 @@ public:
 
     /** Changes the Root */
     void changeRoot(std::string basePath);
+    int getGraphNumber();
 
     /** Node Adders */
     bool addNode(ClangNode* node, bool assumeValid = false) override;
     bool addEdge(ClangEdge* edge, bool assumeValid = false) override;
 
+    /** Attribute Adders */
+    bool addAttribute(std::string ID, std::string key, std::string value) override;
+    bool addAttribute(std::string IDSrc, std::string IDDst, ClangEdge::EdgeType type, std::string key,
+                      std::string value) override;
+
     /** TA Generation */
-    std::string generateTAFormat() override;
+    bool writeTAFormat(std::string fileName) override;
     void resolveFiles(ClangExclude exclusions) override;
-    void resolveExternalReferences(Printer* print, bool silent = false) override;
+    bool resolveExternalReferences(Printer* print, bool silent = false) override;
+    void setMemBudget(size_t budget);
+    bool absorb(LowMemoryTAGraph* other);
 
     /** File System Adders */
-    void addNodesToFile(std::map<std::string, ClangNode*> fileSkip) override;
+    void addNodesToFile() override;
 
     /** Settings/File Dumpers */
     void dumpCurrentFile(int fileNum, std::string file);
+    static int rollback(std::string basePath, int curNum);
     void dumpSettings(std::vector<boost::filesystem::path> files,
-                      TAGraph::ClangExclude exclude, bool blobMode);
+                      TAGraph::ClangExclude exclude, bool blobMode, int group = -1);
 
     /** TA Dumper */
     void purgeCurrentGraph();
+    void waitForSpills();
 
     static const std::string CUR_FILE_LOC;
     static const std::string CUR_SETTING_LOC;
-    static const std::string BASE_INSTANCE_FN;
-    static const std::string BASE_RELATION_FN;
-    static const std::string BASE_MV_RELATION_FN;
-    static const std::string BASE_ATTRIBUTE_FN;
+    static const std::string BASE_LOG_FN;
+    static const std::string BASE_COMPACT_LOG_FN;
 
 private:
-    const int PURGE_AMOUNT = 1000;
-
-    std::string instanceFN;
-    std::string relationFN;
-    std::string mvRelationFN;
-    std::string attributeFN;
+    /** Spill Batch */
+    typedef struct {
+        std::unordered_map<std::string, ClangNode*> nodes;
+        std::unordered_map<std::string, std::vector<ClangEdge*>> edges;
+        int fileNum = 0;
+        std::string file;
+    } SpillBatch;
+
+    const int MAX_IN_FLIGHT = 2;
+    const double PURGE_THRESHOLD = 0.9;
+    const size_t IO_BUFFER_SIZE = 1024 * 1024;
+    const size_t NODE_OVERHEAD = 256;
+    const size_t EDGE_OVERHEAD = 192;
+    const size_t ATTR_OVERHEAD = 64;
+    const size_t DEFAULT_MEM_BUDGET = (size_t) 1024 * 1024 * 1024;
+    const int TABLE_SHARE = 4;
+    const int NUM_HELD_SORTERS = 3;
+
+    std::string logFN;
+    std::string compactLogFN;
     std::string settingFN;
     std::string curFileFN;
 
-    static int currentNumber;
+    static std::atomic<int> currentNumber;
     int fileNumber;
     bool purge;
+    size_t memBudget = DEFAULT_MEM_BUDGET;
+    size_t footprint = 0;
+    RecordCodec codec;
+
+    /** First File Not Fully Spilled */
+    int curFileNum = 0;
+    std::string curFileName;
+
+    /** Hashes of IDs and Edges Already Spilled (Sorted) */
+    std::vector<size_t> writtenKeys;
+
+    /** Background Writer */
+    std::thread writer;
+    std::mutex spillMutex;
+    std::condition_variable spillCond;
+    std::deque<SpillBatch*> pendingBatches;
+    SpillBatch* activeBatch = nullptr;
+    bool stopWriter = false;
+
+    /** Spill Statistics */
+    unsigned long long spillRawBytes = 0;
+    unsigned long long spillCompressedBytes = 0;
+    double spillSeconds = 0;
+
+    /** Resolution Counters */
+    int numResolved = 0;
+    int numUnresolved = 0;
+
+    /** Resolution Phases */
+    bool sortLog(ExternalSorter& instances, ExternalSorter& relations);
+    bool sortAttributes(ExternalSorter& attributes, ExternalSorter& relAttributes);
+
+    /** Spill Operations */
+    void runWriter();
+    void writeBatch(SpillBatch* batch);
+    void writeCheckpoint(int fileNum, std::string file);
 
     /** File Operations */
     bool doesFileExist(std::string fN);
     void deleteFile(std::string fN);
+    static bool syncFile(std::string fN);
+    bool appendFile(std::string srcFN, std::string dstFN);
 
     /** Helper Methods */
     void setPurgeStatus(bool purge);
-    int getNumberEntities();
-    std::vector<std::string> tokenize(std::string);
-    std::vector<std::pair<std::string, std::vector<std::string>>> generateStrAttributes(std::vector<std::string> line);
+    bool isNearBudget();
+    size_t getNodeSize(ClangNode* node);
+    size_t getEdgeSize(ClangEdge* edge);
+    size_t getEdgeKey(ClangEdge* edge);
+    bool wasWritten(size_t key);
+    void markWritten();
+    std::string generateAttributeLine(std::string name, const GraphLog::AttributeList& attrs);
 };
 
 
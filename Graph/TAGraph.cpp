@@ -25,9 +25,11 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 /////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+#include <fstream>
 #include <ctime>
 #include "TAGraph.h"
 #include "../Walker/ASTWalker.h"
+#include "../Driver/TraceRecorder.h"
 
 using namespace std;
 
@@ -174,10 +176,39 @@ bool TAGraph::addAttribute(string ID, string key, string value){
     //Check if the attribute exists.
     if (node->doesAttributeExist(key, value)) return true;
 
+    //The label is the name of the node.
+    if (key.compare(ClangNode::NAME_FLAG) == 0) return renameNode(node, value);
+
     //Add the node attribute.
     return node->addAttribute(key, value);
 }
 
+/**
+ * Changes the name of a node in the graph.
+ * @param node The node to rename.
+ * @param name The new name of the node.
+ * @return Whether the node was renamed.
+ */
+bool TAGraph::renameNode(ClangNode* node, string name){
+    if (node == nullptr) return false;
+
+    //Removes the node from its old name.
+    string oldName = node->getName();
+    vector<string>& oldIDs = nodeNameList[oldName];
+    for (auto it = oldIDs.begin(); it != oldIDs.end(); it++){
+        if (it->compare(node->getID()) == 0){
+            oldIDs.erase(it);
+            break;
+        }
+    }
+    if (oldIDs.size() == 0) nodeNameList.erase(oldName);
+
+    //Adds it under the new name.
+    node->setName(name);
+    nodeNameList[name].push_back(node->getID());
+    return true;
+}
+
 /**
  * Adds an attribute to an edge in the graph.
  * @param IDSrc The source ID.
@@ -374,10 +405,26 @@ string TAGraph::generateTAFormat() {
 }
 
 /**
- * Adds nodes in the graph to a file node.
- * @param fileSkip Whether we're going to skip a certain component.
+ * Writes the Tuple-Attribute representation of the graph to a file.
+ * @param fileName The file to write.
+ * @return Whether the file was written.
  */
-void TAGraph::addNodesToFile(map<string, ClangNode*> fileSkip) {
+bool TAGraph::writeTAFormat(string fileName) {
+    TraceRecorder::Span span("writeTA", fileName);
+    std::ofstream taFile(fileName);
+    if (!taFile.is_open()) return false;
+
+    taFile << generateTAFormat();
+    taFile.close();
+
+    return !taFile.fail();
+}
+
+/**
+ * Adds nodes in the graph to a file node. Each node's file attribute holds
+ * the full path of its file, which is looked up in the path index.
+ */
+void TAGraph::addNodesToFile() {
     //Iterate through all our nodes and find the appropriate file.
     for (auto it = nodeList.begin(); it != nodeList.end(); it++) {
         ClangNode* node = it->second;
@@ -386,37 +433,36 @@ void TAGraph::addNodesToFile(map<string, ClangNode*> fileSkip) {
         vector<string> fileAttrVec = node->getAttribute(FILE_ATTRIBUTE);
         if (fileAttrVec.size() != 1) continue;
 
-        for (string file : fileAttrVec) {
-            ClangNode* fileNode;
-            if (file.compare("") != 0) {
-                //Find the appropriate node.
-                vector<ClangNode*> fileVec = findNodeByName(file);
-                if (fileVec.size() > 0) {
-                    fileNode = fileVec.at(0);
-
-                    //We now look up the file node.
-                    auto ptrSkip = fileSkip.find(file);
-                    if (ptrSkip != fileSkip.end()) {
-                        ClangNode *skip = ptrSkip->second;
-                        fileNode = skip;
-                    }
-                } else {
-                    continue;
-                }
-
-                //Add it to the graph.
-                ClangEdge *edge = new ClangEdge(fileNode, node, ClangEdge::FILE_CONTAIN);
-                addEdge(edge);
-            }
-        }
+        ClangNode* fileNode = findFileNode(fileAttrVec.at(0));
+        if (!fileNode) continue;
+
+        //Add it to the graph.
+        ClangEdge *edge = new ClangEdge(fileNode, node, ClangEdge::FILE_CONTAIN);
+        addEdge(edge);
     }
 }
 
+/**
+ * Finds the node that contains entities in a file. If file nodes are excluded
+ * this is the subsystem the file is in.
+ * @param path The full path of the file.
+ * @return The node, or null if there isn't one.
+ */
+ClangNode* TAGraph::findFileNode(const string& path) {
+    if (path.size() == 0) return nullptr;
+
+    auto it = pathIndex.find(path);
+    if (it == pathIndex.end()) return nullptr;
+    return it->second;
+}
+
 /**
  * Goes through the undefined edges and tries to resolve them. If not, deletes the reference.
+ * @param print The printer that prints messages.
  * @param silent Whether we output the results or not.
+ * @return Whether the references were resolved. This always works in memory.
  */
-void TAGraph::resolveExternalReferences(Printer* print, bool silent) {
+bool TAGraph::resolveExternalReferences(Printer* print, bool silent) {
     int resolved = 0;
     int unresolved = 0;
     vector<ClangEdge*> toRemove;
@@ -453,6 +499,8 @@ void TAGraph::resolveExternalReferences(Printer* print, bool silent) {
     if (!silent){
         print->printResolveRefDone(resolved, unresolved);
     }
+
+    return true;
 }
 
 /**
@@ -463,33 +511,69 @@ void TAGraph::resolveFiles(TAGraph::ClangExclude exclusions){
     bool assumeValid = true;
     vector<ClangNode*> fileNodes = vector<ClangNode*>();
     vector<ClangEdge*> fileEdges = vector<ClangEdge*>();
+    unordered_map<string, ClangNode*> filePaths;
 
     //Gets all the associated clang nodes.
-    fileParser.processPaths(fileNodes, fileEdges);
+    fileParser.processPaths(fileNodes, fileEdges, filePaths);
 
-    //Adds them to the graph.
+    //Works out which nodes are kept.
+    unordered_set<ClangNode*> kept;
     for (ClangNode *file : fileNodes) {
         if ((file->getType() == ClangNode::NodeType::SUBSYSTEM && !exclusions.cSubSystem) ||
             (file->getType() == ClangNode::NodeType::FILE && !exclusions.cFile)) {
-            addNode(file, assumeValid);
-        } else {
-            delete file;
+            kept.insert(file);
         }
     }
 
-    //Adds the edges to the graph.
-    map<string, ClangNode*> fileSkip;
+    //Files from an initial model are already in the graph. Reuse those nodes instead.
+    unordered_map<ClangNode*, ClangNode*> existing;
+    for (ClangNode *file : kept) {
+        if (nodeExists(file->getID())) existing[file] = findNodeByID(file->getID());
+    }
+
+    //Adds the edges to the graph. Excluded files hand their entities to their subsystem.
+    unordered_map<ClangNode*, ClangNode*> fileSkip;
     for (ClangEdge *edge : fileEdges) {
-        //Surpasses.
         if (exclusions.cFile && edge->getDst()->getType() == ClangNode::FILE){
-            fileSkip[edge->getDst()->getID()] = edge->getSrc();
+            if (kept.count(edge->getSrc())) fileSkip[edge->getDst()] = edge->getSrc();
+            delete edge;
+            continue;
+        }
+
+        //Edges between existing nodes may already be in the graph.
+        auto src = existing.find(edge->getSrc());
+        auto dst = existing.find(edge->getDst());
+        if (src != existing.end()) edge->setSrc(src->second);
+        if (dst != existing.end()) edge->setDst(dst->second);
+        addEdge(edge, assumeValid && src == existing.end() && dst == existing.end());
+    }
+
+    //Builds the path index.
+    pathIndex.clear();
+    pathIndex.reserve(filePaths.size());
+    for (auto it = filePaths.begin(); it != filePaths.end(); it++){
+        ClangNode* node = nullptr;
+        if (kept.count(it->second)) {
+            node = it->second;
         } else {
-            addEdge(edge, assumeValid);
+            auto skip = fileSkip.find(it->second);
+            if (skip != fileSkip.end()) node = skip->second;
         }
+        if (!node) continue;
+
+        auto reuse = existing.find(node);
+        pathIndex[it->first] = (reuse != existing.end()) ? reuse->second : node;
+    }
+
+    //Adds the nodes to the graph.
+    for (ClangNode *file : fileNodes) {
+        if (kept.count(file) && !existing.count(file)) addNode(file, assumeValid);
+        else delete file;
     }
 
     //Next, for each item in the graph, add it to a file.
-    addNodesToFile(fileSkip);
+    addNodesToFile();
+    pathIndex.clear();
 }
 
 /**
@@ -498,6 +582,116 @@ void TAGraph::resolveFiles(TAGraph::ClangExclude exclusions){
  */
 void TAGraph::addPath(string path){
     fileParser.addPath(path);
+    if (trackPaths) trackedPaths.insert(path);
+}
+
+/**
+ * Gets the paths that were added to the TA graph.
+ * @return The paths.
+ */
+vector<string> TAGraph::getPaths(){
+    return fileParser.getPaths();
+}
+
+/**
+ * Sets whether the paths added to the graph are recorded. This tells which
+ * files a translation unit pulled entities from.
+ * @param track Whether paths are recorded.
+ */
+void TAGraph::setPathTracking(bool track){
+    trackPaths = track;
+    trackedPaths.clear();
+}
+
+/**
+ * Gets the paths recorded since the last call and starts a new record.
+ * @return The recorded paths.
+ */
+unordered_set<string> TAGraph::takeTrackedPaths(){
+    unordered_set<string> paths;
+    paths.swap(trackedPaths);
+    return paths;
+}
+
+/**
+ * Removes every entity that was extracted from a set of files so they can be
+ * extracted again. Relations out of those entities go with them. Relations
+ * into them are kept but unresolved, so they link back up if the entity is
+ * extracted again and are dropped by the next resolve if it isn't.
+ * @param paths The full paths of the files.
+ * @return The number of entities removed.
+ */
+int TAGraph::removeFileEntities(const unordered_set<string>& paths){
+    vector<ClangNode*> toRemove;
+    for (auto it = nodeList.begin(); it != nodeList.end(); it++){
+        if (!it->second) continue;
+
+        vector<string> fileAttrVec = it->second->getAttribute(FILE_ATTRIBUTE);
+        if (fileAttrVec.size() == 1 && paths.find(fileAttrVec.at(0)) != paths.end()) toRemove.push_back(it->second);
+    }
+
+    for (ClangNode* node : toRemove) detachNode(node);
+    return (int) toRemove.size();
+}
+
+/**
+ * Removes the subsystem and file nodes along with their relations. The path
+ * list is rebuilt from the entities that are left, so the next call to
+ * resolveFiles only creates files that still have entities.
+ */
+void TAGraph::clearFiles(){
+    vector<ClangNode*> toRemove;
+    for (auto it = nodeList.begin(); it != nodeList.end(); it++){
+        if (!it->second) continue;
+
+        ClangNode::NodeType type = it->second->getType();
+        if (type == ClangNode::SUBSYSTEM || type == ClangNode::FILE) toRemove.push_back(it->second);
+    }
+    for (ClangNode* node : toRemove) detachNode(node);
+
+    //Rebuilds the paths.
+    fileParser = FileParse();
+    for (auto it = nodeList.begin(); it != nodeList.end(); it++){
+        if (!it->second) continue;
+
+        vector<string> fileAttrVec = it->second->getAttribute(FILE_ATTRIBUTE);
+        if (fileAttrVec.size() == 1 && fileAttrVec.at(0).compare("") != 0) fileParser.addPath(fileAttrVec.at(0));
+    }
+}
+
+/**
+ * Takes a node out of the graph and deletes it. Its outgoing relations are
+ * deleted and its incoming relations are unresolved.
+ * @param node The node to remove.
+ */
+void TAGraph::detachNode(ClangNode* node){
+    string ID = node->getID();
+
+    //Removes the relations out of the node.
+    auto srcIt = edgeSrcList.find(ID);
+    if (srcIt != edgeSrcList.end()){
+        vector<ClangEdge*> outgoing = srcIt->second;
+        for (ClangEdge* edge : outgoing) removeEdge(edge);
+        edgeSrcList.erase(ID);
+    }
+
+    //Relations into the node are kept.
+    auto dstIt = edgeDstList.find(ID);
+    if (dstIt != edgeDstList.end()){
+        for (ClangEdge* edge : dstIt->second) edge->unresolve();
+    }
+
+    //Removes the node itself.
+    vector<string>& nameIDs = nodeNameList[node->getName()];
+    for (auto it = nameIDs.begin(); it != nameIDs.end(); it++){
+        if (it->compare(ID) == 0){
+            nameIDs.erase(it);
+            break;
+        }
+    }
+    if (nameIDs.size() == 0) nodeNameList.erase(node->getName());
+    nodeList.erase(ID);
+    delete node;
 }
 
 /**
@@ -31,6 +31,7 @@
 #include <vector>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include "ClangNode.h"
 #include "ClangEdge.h"
 #include "../Printer/Printer.h"
@@ -63,9 +64,10 @@ public:
     void removeEdge(ClangEdge* edge);
 
     /** Attribute Adders */
-    bool addAttribute(std::string ID, std::string key, std::string value);
-    bool addAttribute(std::string IDSrc, std::string IDDst, ClangEdge::EdgeType type, std::string key,
-                      std::string value);
+    bool renameNode(ClangNode* node, std::string name);
+    virtual bool addAttribute(std::string ID, std::string key, std::string value);
+    virtual bool addAttribute(std::string IDSrc, std::string IDDst, ClangEdge::EdgeType type, std::string key,
+                              std::string value);
 
     /** Node/Edge Getters */
     std::vector<ClangNode*> getNodes();
@@ -86,12 +88,21 @@ public:
 
     /** TA Operations */
     virtual std::string generateTAFormat();
-    virtual void addNodesToFile(std::map<std::string, ClangNode*> fileSkip);
+    virtual bool writeTAFormat(std::string fileName);
+    std::string generateTAHeader();
+    virtual void addNodesToFile();
 
     /** Unresolved Operations */
-    virtual void resolveExternalReferences(Printer* print, bool silent = false);
+    virtual bool resolveExternalReferences(Printer* print, bool silent = false);
     virtual void resolveFiles(ClangExclude exclusions);
     void addPath(std::string path);
+    std::vector<std::string> getPaths();
+
+    /** Incremental Operations */
+    void setPathTracking(bool track);
+    std::unordered_set<std::string> takeTrackedPaths();
+    int removeFileEntities(const std::unordered_set<std::string>& paths);
+    void clearFiles();
 
     static const std::string FILE_ATTRIBUTE;
 
@@ -104,11 +115,14 @@ protected:
     std::unordered_map<std::string, std::vector<ClangEdge*>> edgeSrcList;
     std::unordered_map<std::string, std::vector<ClangEdge*>> edgeDstList;
 
+    /** File Resolution */
+    std::unordered_map<std::string, ClangNode*> pathIndex;
+    ClangNode* findFileNode(const std::string& path);
+
     /** Clear Graph */
     void clearGraph();
 
     /** TA Helper Methods */
-    std::string generateTAHeader();
     std::string generateInstances();
     std::string generateRelationships();
     std::string generateAttributes();
@@ -117,6 +131,13 @@ private:
     /** Settings */
     FileParse fileParser;
 
+    /** Path Tracking */
+    bool trackPaths = false;
+    std::unordered_set<std::string> trackedPaths;
+
+    /** Incremental Helpers */
+    void detachNode(ClangNode* node);
+
     /** TA Const Variables */
     std::string const TA_HEADER = "//Generated TA File";
     std::string const TA_SCHEMA = "//Author: Jingwei Wu & Bryan J Muscedere\n\nSCHEME TUPLE :\n//Nodes\n$INHERIT\tcArch"
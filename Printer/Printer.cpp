@@ -25,6 +25,7 @@
 /////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include <iostream>
+#include <iomanip>
 #include "Printer.h"
 
 using namespace std;
@@ -99,6 +100,109 @@ void Printer::printResolveRefDone(int resolved, int unresolved) {
          << " references could not be resolved." << endl << endl;
 }
 
+/**
+ * Prints the results of merging several TA models.
+ * @param numModels The number of models merged.
+ * @param numInstances The number of unique instances.
+ * @param numRelations The number of unique relations.
+ * @param numDangling The number of relations dropped for missing an end.
+ */
+void Printer::printModelMergeDone(int numModels, int numInstances, int numRelations, int numDangling) {
+    cout << "Merged " << numModels << " models into " << numInstances << " instances and " << numRelations
+         << " relations. " << numDangling << " dangling relations were dropped." << endl << endl;
+}
+
+/**
+ * Prints the results of filtering a TA model.
+ * @param numKept The number of facts kept.
+ * @param numDropped The number of facts dropped.
+ */
+void Printer::printFilterDone(int numKept, int numDropped) {
+    cout << "Filter kept " << numKept << " facts and dropped " << numDropped << " facts." << endl << endl;
+}
+
+/**
+ * Prints how well the low memory spill files compressed.
+ * @param rawBytes The bytes spilled before compression.
+ * @param compressedBytes The bytes written to disk.
+ * @param seconds The time spent compressing.
+ */
+void Printer::printSpillStats(unsigned long long rawBytes, unsigned long long compressedBytes, double seconds) {
+    double rawMB = rawBytes / (1024.0 * 1024.0);
+    double ratio = (compressedBytes > 0) ? (double) rawBytes / compressedBytes : 0;
+    double throughput = (seconds > 0) ? rawMB / seconds : 0;
+
+    cout << "Spilled " << rawMB << " MB compressed to " << compressedBytes / (1024.0 * 1024.0) << " MB (ratio "
+         << ratio << ":1, " << throughput << " MB/s)." << endl << endl;
+}
+
+/**
+ * Prints that watch mode is waiting for changes.
+ * @param numDirs The number of directories being watched.
+ * @param stopOnInput Whether pressing enter stops watching.
+ */
+void Printer::printWatchStart(int numDirs, bool stopOnInput) {
+    cout << "Watching " << numDirs << " directories for changes.";
+    if (stopOnInput) cout << " Press enter to stop.";
+    cout << endl << endl;
+}
+
+/**
+ * Prints that watch mode applied a set of changes.
+ * @param numChanged The number of files that changed.
+ * @param numExtracted The number of files that were extracted again.
+ * @param seconds The time taken to update the model.
+ * @param fileName The TA file that was rewritten.
+ */
+void Printer::printWatchUpdate(int numChanged, int numExtracted, double seconds, string fileName) {
+    cout << numChanged << " file(s) changed, " << numExtracted << " extracted again. " << fileName
+         << " updated in " << seconds << "s." << endl << endl;
+}
+
+/**
+ * Prints where a run spent its time. Phases run by several workers show
+ * their time added up across the workers.
+ * @param stats The stats of the run.
+ */
+void Printer::printRunStats(RunStats& stats) {
+    RunStats::Timing total = stats.getTotal();
+    double seconds = (total.wallSeconds > 0) ? total.wallSeconds : 1;
+
+    cout << fixed << setprecision(2) << "Run statistics:" << endl
+         << "  " << left << setw(20) << "Phase" << right << setw(12) << "Wall (s)" << setw(12) << "CPU (s)" << endl;
+    for (int i = 0; i < RunStats::NUM_PHASES; i++){
+        RunStats::Timing phase = stats.getTiming((RunStats::Phase) i);
+        cout << "  " << left << setw(20) << RunStats::PHASE_NAMES[i] << right << setw(12) << phase.wallSeconds
+             << setw(12) << phase.cpuSeconds << endl;
+    }
+    cout << "  " << left << setw(20) << "total" << right << setw(12) << total.wallSeconds << setw(12)
+         << total.cpuSeconds << endl
+         << "  " << stats.getNumUnits() << " units (" << stats.getNumUnits() / seconds << "/s), "
+         << stats.getNumNodes() << " entities (" << stats.getNumNodes() / seconds << "/s), "
+         << stats.getNumEdges() << " relations (" << stats.getNumEdges() / seconds << "/s)" << endl
+         << "  Peak memory: " << stats.getPeakRSS() / (1024.0 * 1024.0) << " MB" << endl << endl;
+    cout << defaultfloat << setprecision(6);
+}
+
+/**
+ * Prints the time spent in each matcher, most expensive first. The total
+ * includes the time spent handling the matcher's matches.
+ * @param stats The stats of the run.
+ */
+void Printer::printMatcherProfile(RunStats& stats) {
+    vector<RunStats::MatcherTiming> timings = stats.getMatcherTimings();
+    if (timings.size() == 0) return;
+
+    cout << fixed << setprecision(3) << "Matcher profile:" << endl
+         << "  " << left << setw(24) << "Matcher" << right << setw(12) << "Total (s)" << setw(14) << "Callback (s)"
+         << setw(12) << "Matches" << endl;
+    for (RunStats::MatcherTiming& timing : timings){
+        cout << "  " << left << setw(24) << timing.name << right << setw(12) << timing.matchSeconds << setw(14)
+             << timing.callbackSeconds << setw(12) << timing.numMatches << endl;
+    }
+    cout << endl << defaultfloat << setprecision(6);
+}
+
 /**
  * Method that notifies the user on a processing error.
  * @return The user's repsonse if they want to continue or not.
@@ -201,6 +305,24 @@ void Printer::printErrorTAProcessGraph() {
     cout << "Please supply an initialized TA graph object!" << endl;
 }
 
+/**
+ * Error that is printed if a low memory graph could not be resolved.
+ * @param logName The graph log that was being resolved.
+ */
+void Printer::printErrorResolve(std::string logName){
+    cout << "The graph log " << logName << " could not be resolved!" << endl;
+    cout << "The model was not generated." << endl;
+}
+
+/**
+ * Error that is printed if low memory mode is requested with an initial model.
+ * @param fileName The initial TA file.
+ */
+void Printer::printErrorInitialLowMemory(std::string fileName){
+    cout << "The initial model " << fileName << " must be held in memory!" << endl;
+    cout << "Low memory mode was disabled for this run." << endl;
+}
+
 /**
  * Default Constructor.
  */
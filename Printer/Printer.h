@@ -26,6 +26,7 @@
 #define CLANGEX_PRINTER_H
 
 #include <string>
+#include "../Driver/RunStats.h"
 
 class Printer {
 public:
@@ -47,6 +48,13 @@ public:
     void printProcessStatus(Printer::PrintStatus status);
     bool printProcessFailure();
     void printResolveRefDone(int resolved, int unresolved);
+    void printModelMergeDone(int numModels, int numInstances, int numRelations, int numDangling);
+    void printFilterDone(int numKept, int numDropped);
+    void printSpillStats(unsigned long long rawBytes, unsigned long long compressedBytes, double seconds);
+    void printWatchStart(int numDirs, bool stopOnInput);
+    void printWatchUpdate(int numChanged, int numExtracted, double seconds, std::string fileName);
+    void printRunStats(RunStats& stats);
+    void printMatcherProfile(RunStats& stats);
     
     /** Print Error Methods */
     void printErrorTAProcess(int lineNum, std::string message);
@@ -55,6 +63,8 @@ public:
     void printErrorTAProcessRead(std::string fileName);
     void printErrorTAProcessWrite(std::string fileName);
     void printErrorTAProcessGraph();
+    void printErrorResolve(std::string logName);
+    void printErrorInitialLowMemory(std::string fileName);
 };
 
 #endif //CLANGEX_PRINTER_H
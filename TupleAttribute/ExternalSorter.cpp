@@ -0,0 +1,235 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ExternalSorter.cpp
+//
+// Created By: Bryan J Muscedere
+// Date: 19/10/26.
+//
+// Sorts text records that may not fit in memory. Records are buffered
+// until a memory budget is reached, then sorted and written out as runs.
+// The runs are combined with a k-way merge when records are read back.
+// Callers put the sort key at the front of each record.
+//
+// Copyright (C) 2017, Bryan J. Muscedere
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cstdio>
+#include "ExternalSorter.h"
+
+using namespace std;
+
+/**
+ * Constructor. Sets up the sorter.
+ * @param tempDir The directory to write runs to.
+ * @param name The prefix used for run files.
+ * @param memBudget The number of bytes of records to hold before spilling.
+ */
+ExternalSorter::ExternalSorter(string tempDir, string name, size_t memBudget){
+    this->baseName = tempDir + "/" + name;
+    this->memBudget = max(memBudget, MIN_BUDGET);
+}
+
+/**
+ * Destructor. Deletes any run files that are left over.
+ */
+ExternalSorter::~ExternalSorter(){
+    closeReaders();
+    for (const string& run : runs) remove(run.c_str());
+}
+
+/**
+ * Adds a record to the sorter. Records cannot contain new lines.
+ * @param record The record to add.
+ * @return Whether the record was added.
+ */
+bool ExternalSorter::add(const string& record){
+    if (sorted || failed) return false;
+
+    buffer.push_back(record);
+    memUsed += record.size() + RECORD_OVERHEAD;
+
+    //Checks if we need to spill to disk.
+    if (memUsed >= memBudget) return spill();
+    return true;
+}
+
+/**
+ * Finishes adding records and prepares them to be read back in order.
+ * @return Whether the records were sorted.
+ */
+bool ExternalSorter::sort(){
+    if (sorted) return !failed;
+    sorted = true;
+
+    //If nothing was spilled, we just sort in memory.
+    if (runs.size() == 0){
+        std::sort(buffer.begin(), buffer.end());
+        return true;
+    }
+
+    if (buffer.size() > 0 && !spill()) return false;
+
+    //Reduces the number of runs until a single merge can handle them.
+    while (runs.size() > MAX_FAN_IN){
+        vector<string> inputs(runs.begin(), runs.begin() + MAX_FAN_IN);
+        string output = generateRunName();
+        if (!mergeRuns(inputs, output)){
+            failed = true;
+            return false;
+        }
+
+        runs.erase(runs.begin(), runs.begin() + MAX_FAN_IN);
+        runs.push_back(output);
+    }
+
+    //Opens each run and loads the first record.
+    for (int i = 0; i < runs.size(); i++){
+        ifstream* reader = new ifstream(runs.at(i));
+        readers.push_back(reader);
+        if (!reader->is_open()){
+            failed = true;
+            return false;
+        }
+
+        string record;
+        if (getline(*reader, record)) heap.push(RunEntry(record, i));
+    }
+
+    return true;
+}
+
+/**
+ * Gets the next record in sorted order.
+ * @param record Set to the next record.
+ * @return Whether a record was read.
+ */
+bool ExternalSorter::next(string& record){
+    if (!sorted || failed) return false;
+
+    //Reads from memory.
+    if (runs.size() == 0){
+        if (bufferPos == buffer.size()) return false;
+        record.swap(buffer.at(bufferPos++));
+        return true;
+    }
+
+    //Otherwise, takes the smallest record from the runs.
+    if (heap.empty()) return false;
+    RunEntry top = heap.top();
+    heap.pop();
+    record.swap(top.first);
+
+    string nextRecord;
+    if (getline(*readers.at(top.second), nextRecord)) heap.push(RunEntry(nextRecord, top.second));
+    return true;
+}
+
+/**
+ * Gets the number of runs written to disk.
+ * @return The number of runs.
+ */
+int ExternalSorter::getNumRuns(){
+    return (int) runs.size();
+}
+
+/**
+ * Sorts the buffered records and writes them out as a run.
+ * @return Whether the run was written.
+ */
+bool ExternalSorter::spill(){
+    std::sort(buffer.begin(), buffer.end());
+
+    //Writes the run.
+    string runName = generateRunName();
+    ofstream run(runName);
+    if (!run.is_open()){
+        failed = true;
+        return false;
+    }
+
+    for (const string& record : buffer) run << record << "\n";
+    run.close();
+    if (run.fail()){
+        failed = true;
+        return false;
+    }
+
+    runs.push_back(runName);
+    vector<string>().swap(buffer);
+    memUsed = 0;
+    return true;
+}
+
+/**
+ * Merges a set of runs into a single run. The inputs are deleted.
+ * @param inputs The runs to merge.
+ * @param output The run to create.
+ * @return Whether the merge was successful.
+ */
+bool ExternalSorter::mergeRuns(vector<string> inputs, string output){
+    vector<ifstream*> inputReaders;
+    priority_queue<RunEntry, vector<RunEntry>, greater<RunEntry>> mergeHeap;
+
+    //Opens the inputs.
+    bool success = true;
+    for (int i = 0; i < inputs.size(); i++){
+        ifstream* reader = new ifstream(inputs.at(i));
+        inputReaders.push_back(reader);
+        if (!reader->is_open()) success = false;
+
+        string record;
+        if (success && getline(*reader, record)) mergeHeap.push(RunEntry(record, i));
+    }
+
+    //Writes out the merged run.
+    ofstream out(output);
+    if (!out.is_open()) success = false;
+    while (success && !mergeHeap.empty()){
+        RunEntry top = mergeHeap.top();
+        mergeHeap.pop();
+        out << top.first << "\n";
+
+        string record;
+        if (getline(*inputReaders.at(top.second), record)) mergeHeap.push(RunEntry(record, top.second));
+    }
+    out.close();
+    if (out.fail()) success = false;
+    if (!success) remove(output.c_str());
+
+    //Cleans up.
+    for (int i = 0; i < inputs.size(); i++){
+        delete inputReaders.at(i);
+        remove(inputs.at(i).c_str());
+    }
+
+    return success;
+}
+
+/**
+ * Generates the name of the next run file.
+ * @return The run file name.
+ */
+string ExternalSorter::generateRunName(){
+    return baseName + "-" + to_string(runCounter++) + RUN_EXT;
+}
+
+/**
+ * Closes all open run readers.
+ */
+void ExternalSorter::closeReaders(){
+    for (ifstream* reader : readers) delete reader;
+    readers.clear();
+}
@@ -0,0 +1,84 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ExternalSorter.h
+//
+// Created By: Bryan J Muscedere
+// Date: 19/10/26.
+//
+// Sorts text records that may not fit in memory. Records are buffered
+// until a memory budget is reached, then sorted and written out as runs.
+// The runs are combined with a k-way merge when records are read back.
+// Callers put the sort key at the front of each record.
+//
+// Copyright (C) 2017, Bryan J. Muscedere
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CLANGEX_EXTERNALSORTER_H
+#define CLANGEX_EXTERNALSORTER_H
+
+#include <string>
+#include <vector>
+#include <queue>
+#include <fstream>
+
+class ExternalSorter {
+public:
+    /** Constructor/Destructor */
+    ExternalSorter(std::string tempDir, std::string name, size_t memBudget);
+    ~ExternalSorter();
+
+    /** Record I/O */
+    bool add(const std::string& record);
+    bool sort();
+    bool next(std::string& record);
+
+    /** Counters */
+    int getNumRuns();
+
+private:
+    /** Private Constants */
+    const int MAX_FAN_IN = 64;
+    const size_t RECORD_OVERHEAD = sizeof(std::string) + 16;
+    const size_t MIN_BUDGET = 1024 * 1024;
+    const std::string RUN_EXT = ".run";
+
+    /** Run Entry */
+    typedef std::pair<std::string, int> RunEntry;
+
+    /** Private Variables */
+    std::string baseName;
+    size_t memBudget;
+    size_t memUsed = 0;
+    int runCounter = 0;
+    bool sorted = false;
+    bool failed = false;
+
+    /** In-Memory Records */
+    std::vector<std::string> buffer;
+    size_t bufferPos = 0;
+
+    /** Run Files */
+    std::vector<std::string> runs;
+    std::vector<std::ifstream*> readers;
+    std::priority_queue<RunEntry, std::vector<RunEntry>, std::greater<RunEntry>> heap;
+
+    /** Run Helpers */
+    bool spill();
+    bool mergeRuns(std::vector<std::string> inputs, std::string output);
+    std::string generateRunName();
+    void closeReaders();
+};
+
+#endif //CLANGEX_EXTERNALSORTER_H
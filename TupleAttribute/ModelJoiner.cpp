@@ -0,0 +1,265 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ModelJoiner.cpp
+//
+// Created By: Bryan J Muscedere
+// Date: 19/10/26.
+//
+// Joins a model that has been sorted on disk. Instances are deduplicated,
+// relations are joined against the instances on both ends and attributes
+// are combined per entity or relation. The results go to a sink so the
+// same join can write a TA file or a compacted graph log.
+//
+// Copyright (C) 2017, Bryan J. Muscedere
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <fstream>
+#include "ModelJoiner.h"
+
+using namespace std;
+
+/**
+ * Constructor. Sets up the joiner.
+ * @param sink Where the joined model is written.
+ */
+ModelJoiner::ModelJoiner(const JoinSink& sink){
+    this->sink = sink;
+}
+
+/**
+ * Destructor.
+ */
+ModelJoiner::~ModelJoiner(){ }
+
+/**
+ * Writes each instance once. The first declaration of an instance sets its type.
+ * @param instances The sorted instances, as ID, sequence number and type.
+ * @param idFile The file to write the sorted instance IDs to.
+ * @return Whether the instances were written.
+ */
+bool ModelJoiner::writeInstances(ExternalSorter& instances, string idFile){
+    ofstream ids(idFile);
+    if (!ids.is_open()) return false;
+
+    string record;
+    string lastID;
+    bool first = true;
+    while (instances.next(record)){
+        vector<string> fields = RecordCodec::splitRecord(record, 3);
+        if (fields.size() != 3) continue;
+
+        //Skips instances we've already seen.
+        if (!first && fields.at(0).compare(lastID) == 0) continue;
+        first = false;
+        lastID = fields.at(0);
+
+        if (!sink.instance(fields.at(0), fields.at(2))) return false;
+        ids << fields.at(0) << "\n";
+        numInstances++;
+    }
+
+    ids.close();
+    return !ids.fail();
+}
+
+/**
+ * Removes duplicate relations and those with an unknown source. The rest are
+ * re-keyed by their destination.
+ * @param relations The relations, sorted by source, as source, relation and destination.
+ * @param joined The sorter to add the remaining relations to.
+ * @param idFile The sorted instance IDs.
+ * @return Whether the join was successful.
+ */
+bool ModelJoiner::joinRelations(ExternalSorter& relations, ExternalSorter& joined, string idFile){
+    ifstream ids(idFile);
+    if (!ids.is_open()) return false;
+
+    string curID;
+    bool hasID = static_cast<bool>(getline(ids, curID));
+
+    string record;
+    string lastRecord;
+    while (relations.next(record)){
+        if (record.compare(lastRecord) == 0) continue;
+        lastRecord = record;
+
+        vector<string> fields = RecordCodec::splitRecord(record, 3);
+        if (fields.size() != 3) continue;
+
+        //Moves the instance list up to the source.
+        const string& src = fields.at(0);
+        while (hasID && curID.compare(src) < 0) hasID = static_cast<bool>(getline(ids, curID));
+        if (!hasID || curID.compare(src) != 0){
+            numDangling++;
+            continue;
+        }
+
+        bool succ = joined.add(fields.at(2) + RecordCodec::FIELD_SEP + fields.at(1) + RecordCodec::FIELD_SEP + src);
+        if (!succ) return false;
+    }
+
+    return joined.sort();
+}
+
+/**
+ * Writes the relations whose destination is known.
+ * @param joined The relations, sorted by destination.
+ * @param relAttributes The relation attribute sorter. Written relations are marked as valid.
+ * @param idFile The sorted instance IDs.
+ * @return Whether the relations were written.
+ */
+bool ModelJoiner::writeRelations(ExternalSorter& joined, ExternalSorter& relAttributes, string idFile){
+    ifstream ids(idFile);
+    if (!ids.is_open()) return false;
+
+    string curID;
+    bool hasID = static_cast<bool>(getline(ids, curID));
+
+    string record;
+    while (joined.next(record)){
+        vector<string> fields = RecordCodec::splitRecord(record, 3);
+        if (fields.size() != 3) continue;
+
+        //Moves the instance list up to the destination.
+        const string& dst = fields.at(0);
+        while (hasID && curID.compare(dst) < 0) hasID = static_cast<bool>(getline(ids, curID));
+        if (!hasID || curID.compare(dst) != 0){
+            numDangling++;
+            continue;
+        }
+
+        //Writes the relation and marks it as valid.
+        if (!sink.relation(fields.at(1), fields.at(2), dst)) return false;
+        bool succ = relAttributes.add(fields.at(2) + RecordCodec::FIELD_SEP + fields.at(1) + RecordCodec::FIELD_SEP +
+                                      dst + RecordCodec::FIELD_SEP + RecordCodec::VALID_FLAG);
+        if (!succ) return false;
+        numRelations++;
+    }
+
+    return true;
+}
+
+/**
+ * Writes the attributes of the instances that were kept. Attributes for the same
+ * entity are combined.
+ * @param attributes The sorted entity attributes, as ID, sequence number and attributes.
+ * @param idFile The sorted instance IDs.
+ * @return Whether the attributes were written.
+ */
+bool ModelJoiner::writeAttributes(ExternalSorter& attributes, string idFile){
+    ifstream ids(idFile);
+    if (!ids.is_open()) return false;
+
+    string curID;
+    bool hasID = static_cast<bool>(getline(ids, curID));
+
+    string record;
+    string attrID;
+    bool hasCurrent = false;
+    RecordCodec::AttributeList current;
+    while (attributes.next(record)){
+        vector<string> fields = RecordCodec::splitRecord(record, 3);
+        if (fields.size() != 3) continue;
+
+        //Writes out the previous entity.
+        if (hasCurrent && fields.at(0).compare(attrID) != 0){
+            if (!sink.entityAttributes(attrID, current)) return false;
+            current.clear();
+            hasCurrent = false;
+        }
+
+        //Moves the instance list up to the entity. Entities without an instance are skipped.
+        const string& ID = fields.at(0);
+        while (hasID && curID.compare(ID) < 0) hasID = static_cast<bool>(getline(ids, curID));
+        if (!hasID || curID.compare(ID) != 0) continue;
+
+        attrID = ID;
+        hasCurrent = true;
+        RecordCodec::combineAttributes(current, RecordCodec::decodeAttributes(fields.at(2)));
+    }
+    if (hasCurrent) return sink.entityAttributes(attrID, current);
+
+    return true;
+}
+
+/**
+ * Writes the attributes of the relations that were kept. Attributes for the
+ * same relation are combined.
+ * @param relAttributes The sorted relation attributes and valid markers, as source, relation,
+ * destination, flag and, for attributes, a sequence number and the attributes.
+ * @return Whether the attributes were written.
+ */
+bool ModelJoiner::writeRelAttributes(ExternalSorter& relAttributes){
+    string record;
+    string curKey;
+    vector<string> curFields;
+    bool valid = false;
+    bool succ = true;
+    RecordCodec::AttributeList current;
+
+    //Writes out the current relation.
+    auto flush = [&](){
+        if (valid && current.size() > 0){
+            succ = sink.relationAttributes(curFields.at(1), curFields.at(0), curFields.at(2), current);
+        }
+        current.clear();
+        valid = false;
+    };
+
+    while (succ && relAttributes.next(record)){
+        vector<string> fields = RecordCodec::splitRecord(record, 6);
+        if (fields.size() < 4) continue;
+
+        //Checks if we've moved on to a new relation.
+        string key = RecordCodec::getGroupKey(record, 3);
+        if (key.compare(curKey) != 0){
+            if (curFields.size() > 0) flush();
+            curKey = key;
+            curFields = fields;
+        }
+
+        //Valid markers sort before the attributes.
+        if (fields.at(3).compare(RecordCodec::VALID_FLAG) == 0) valid = true;
+        else if (fields.size() == 6)
+            RecordCodec::combineAttributes(current, RecordCodec::decodeAttributes(fields.at(5)));
+    }
+    if (succ && curFields.size() > 0) flush();
+
+    return succ;
+}
+
+/**
+ * Gets the number of instances written.
+ * @return The number of instances.
+ */
+int ModelJoiner::getNumInstances(){
+    return numInstances;
+}
+
+/**
+ * Gets the number of relations written.
+ * @return The number of relations.
+ */
+int ModelJoiner::getNumRelations(){
+    return numRelations;
+}
+
+/**
+ * Gets the number of relations dropped because an end was unknown.
+ * @return The number of dangling relations.
+ */
+int ModelJoiner::getNumDangling(){
+    return numDangling;
+}
@@ -0,0 +1,73 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ModelJoiner.h
+//
+// Created By: Bryan J Muscedere
+// Date: 19/10/26.
+//
+// Joins a model that has been sorted on disk. Instances are deduplicated,
+// relations are joined against the instances on both ends and attributes
+// are combined per entity or relation. The results go to a sink so the
+// same join can write a TA file or a compacted graph log.
+//
+// Copyright (C) 2017, Bryan J. Muscedere
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CLANGEX_MODELJOINER_H
+#define CLANGEX_MODELJOINER_H
+
+#include <string>
+#include <functional>
+#include "ExternalSorter.h"
+#include "RecordCodec.h"
+
+class ModelJoiner {
+public:
+    /** Output Callbacks */
+    struct JoinSink {
+        std::function<bool(const std::string&, const std::string&)> instance;
+        std::function<bool(const std::string&, const std::string&, const std::string&)> relation;
+        std::function<bool(const std::string&, const RecordCodec::AttributeList&)> entityAttributes;
+        std::function<bool(const std::string&, const std::string&, const std::string&,
+                           const RecordCodec::AttributeList&)> relationAttributes;
+    };
+
+    /** Constructor/Destructor */
+    ModelJoiner(const JoinSink& sink);
+    ~ModelJoiner();
+
+    /** Join Phases */
+    bool writeInstances(ExternalSorter& instances, std::string idFile);
+    bool joinRelations(ExternalSorter& relations, ExternalSorter& joined, std::string idFile);
+    bool writeRelations(ExternalSorter& joined, ExternalSorter& relAttributes, std::string idFile);
+    bool writeAttributes(ExternalSorter& attributes, std::string idFile);
+    bool writeRelAttributes(ExternalSorter& relAttributes);
+
+    /** Counters */
+    int getNumInstances();
+    int getNumRelations();
+    int getNumDangling();
+
+private:
+    /** Private Variables */
+    JoinSink sink;
+
+    /** Join Counters */
+    int numInstances = 0;
+    int numRelations = 0;
+    int numDangling = 0;
+};
+
+#endif //CLANGEX_MODELJOINER_H
@@ -0,0 +1,173 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// RecordCodec.cpp
+//
+// Created By: Bryan J Muscedere
+// Date: 19/10/26.
+//
+// Encodes and decodes the tab separated records that are passed through
+// the external sorters. Attribute lists are packed into a single field
+// and sequence numbers keep records with the same key in order.
+//
+// Copyright (C) 2017, Bryan J. Muscedere
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <limits>
+#include <algorithm>
+#include "RecordCodec.h"
+
+using namespace std;
+
+/** Const Members */
+const char RecordCodec::FIELD_SEP;
+const char RecordCodec::VALUE_SEP;
+const string RecordCodec::VALID_FLAG = "0";
+const string RecordCodec::ATTR_FLAG = "1";
+
+/**
+ * Constructor. Starts the sequence numbers at zero.
+ */
+RecordCodec::RecordCodec(){ }
+
+/**
+ * Destructor.
+ */
+RecordCodec::~RecordCodec(){ }
+
+/**
+ * Gets the next sequence number. Sequence numbers keep records with the same
+ * key in the order they were added.
+ * @return The padded sequence number.
+ */
+string RecordCodec::nextSeq(){
+    string num = to_string(seq++);
+    return string(SEQ_WIDTH - num.size(), '0') + num;
+}
+
+/**
+ * Starts the sequence numbers again from zero.
+ */
+void RecordCodec::resetSeq(){
+    seq = 0;
+}
+
+/**
+ * Splits a record into its fields.
+ * @param record The record to split.
+ * @param maxFields The maximum number of fields. The last field holds the rest of the record.
+ * @return The fields.
+ */
+vector<string> RecordCodec::splitRecord(const string& record, int maxFields){
+    vector<string> fields;
+
+    size_t start = 0;
+    while (fields.size() + 1 < maxFields){
+        size_t pos = record.find(FIELD_SEP, start);
+        if (pos == string::npos) break;
+
+        fields.push_back(record.substr(start, pos - start));
+        start = pos + 1;
+    }
+    fields.push_back(record.substr(start));
+
+    return fields;
+}
+
+/**
+ * Gets the first few fields of a record as a single key.
+ * @param record The record.
+ * @param numFields The number of fields in the key.
+ * @return The key.
+ */
+string RecordCodec::getGroupKey(const string& record, int numFields){
+    size_t pos = 0;
+    for (int i = 0; i < numFields; i++){
+        pos = record.find(FIELD_SEP, pos);
+        if (pos == string::npos) return record;
+        pos++;
+    }
+
+    return record.substr(0, pos - 1);
+}
+
+/**
+ * Encodes an attribute list so it can be stored in a record.
+ * @param attrs The attributes to encode.
+ * @return The encoded attributes.
+ */
+string RecordCodec::encodeAttributes(const AttributeList& attrs){
+    string encoded;
+    for (int i = 0; i < attrs.size(); i++){
+        if (i > 0) encoded += FIELD_SEP;
+
+        encoded += attrs.at(i).first;
+        for (const string& value : attrs.at(i).second) encoded += VALUE_SEP + value;
+    }
+
+    return encoded;
+}
+
+/**
+ * Decodes an attribute list from a record.
+ * @param encoded The encoded attributes.
+ * @return The attribute list.
+ */
+RecordCodec::AttributeList RecordCodec::decodeAttributes(const string& encoded){
+    AttributeList attrs;
+    if (encoded.size() == 0) return attrs;
+
+    vector<string> kvs = splitRecord(encoded, numeric_limits<int>::max());
+    for (const string& kv : kvs){
+        pair<string, vector<string>> entry;
+
+        size_t start = 0;
+        size_t pos = kv.find(VALUE_SEP);
+        entry.first = kv.substr(0, pos);
+        while (pos != string::npos){
+            start = pos + 1;
+            pos = kv.find(VALUE_SEP, start);
+            entry.second.push_back(kv.substr(start, (pos == string::npos) ? string::npos : pos - start));
+        }
+
+        attrs.push_back(entry);
+    }
+
+    return attrs;
+}
+
+/**
+ * Combines attributes the same way the low memory graph compacts them. New keys
+ * are added and new values are appended to existing keys.
+ * @param current The attributes to combine into.
+ * @param attrs The attributes to add.
+ */
+void RecordCodec::combineAttributes(AttributeList& current, const AttributeList& attrs){
+    for (const auto& curA : attrs){
+        bool found = false;
+        for (auto& cAI : current){
+            if (cAI.first.compare(curA.first) != 0) continue;
+            found = true;
+
+            for (const string& val : curA.second){
+                if (find(cAI.second.begin(), cAI.second.end(), val) == cAI.second.end()){
+                    cAI.second.push_back(val);
+                }
+            }
+            break;
+        }
+
+        if (!found) current.push_back(curA);
+    }
+}
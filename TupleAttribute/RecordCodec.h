@@ -0,0 +1,67 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// RecordCodec.h
+//
+// Created By: Bryan J Muscedere
+// Date: 19/10/26.
+//
+// Encodes and decodes the tab separated records that are passed through
+// the external sorters. Attribute lists are packed into a single field
+// and sequence numbers keep records with the same key in order.
+//
+// Copyright (C) 2017, Bryan J. Muscedere
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CLANGEX_RECORDCODEC_H
+#define CLANGEX_RECORDCODEC_H
+
+#include <string>
+#include <vector>
+
+class RecordCodec {
+public:
+    /** Attribute List */
+    typedef std::vector<std::pair<std::string, std::vector<std::string>>> AttributeList;
+
+    /** Record Separators and Flags */
+    static const char FIELD_SEP = '\t';
+    static const char VALUE_SEP = '\x1f';
+    static const std::string VALID_FLAG;
+    static const std::string ATTR_FLAG;
+
+    /** Constructor/Destructor */
+    RecordCodec();
+    ~RecordCodec();
+
+    /** Sequence Numbers */
+    std::string nextSeq();
+    void resetSeq();
+
+    /** Record Helpers */
+    static std::vector<std::string> splitRecord(const std::string& record, int maxFields);
+    static std::string getGroupKey(const std::string& record, int numFields);
+    static std::string encodeAttributes(const AttributeList& attrs);
+    static AttributeList decodeAttributes(const std::string& encoded);
+    static void combineAttributes(AttributeList& current, const AttributeList& attrs);
+
+private:
+    /** Private Constants */
+    const int SEQ_WIDTH = 16;
+
+    /** Private Variables */
+    unsigned long long seq = 0;
+};
+
+#endif //CLANGEX_RECORDCODEC_H
@@ -0,0 +1,293 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// TAFilter.cpp
+//
+// Created By: Bryan J Muscedere
+// Date: 19/10/26.
+//
+// Projects a TA model down to a set of relations and entities without
+// loading it into a graph. Lines are streamed from the input and copied
+// as-is to the output when they pass the filter.
+//
+// Copyright (C) 2017, Bryan J. Muscedere
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <fstream>
+#include <boost/algorithm/string.hpp>
+#include "TAFilter.h"
+#include "TAProcessor.h"
+#include "../Graph/ClangNode.h"
+
+using namespace std;
+
+/**
+ * Constructor. Sets up a filter that keeps everything.
+ * @param entityRelName The name of the instance relation.
+ * @param print The printer to use.
+ */
+TAFilter::TAFilter(string entityRelName, Printer* print){
+    this->entityString = entityRelName;
+    this->clangPrinter = print;
+}
+
+/**
+ * Destructor.
+ */
+TAFilter::~TAFilter(){ }
+
+/**
+ * Adds a relation type to keep. If none are added, all relations are kept.
+ * @param relName The relation name (e.g. call).
+ */
+void TAFilter::addRelation(string relName){
+    relations.insert(relName);
+}
+
+/**
+ * Adds an entity type to keep. If none are added, all entities are kept.
+ * @param typeName The entity type (e.g. cFunction).
+ * @return Whether the type is a valid ClangEx entity type.
+ */
+bool TAFilter::addEntityType(string typeName){
+    if (ClangNode::getTypeString(ClangNode::getTypeNode(typeName)).compare(typeName) != 0) return false;
+
+    entityTypes.insert(typeName);
+    return true;
+}
+
+/**
+ * Loads a list of IDs to keep. The file has one ID per line.
+ * @param fileName The file to load.
+ * @return Whether the file was read.
+ */
+bool TAFilter::loadIDList(string fileName){
+    ifstream idFile(fileName);
+    if (!idFile.is_open()){
+        clangPrinter->printErrorTAProcessRead(fileName);
+        return false;
+    }
+
+    string line;
+    while (getline(idFile, line)){
+        boost::algorithm::trim(line);
+        if (line.size() == 0 || boost::starts_with(line, "//")) continue;
+
+        allowedIDs.insert(line);
+    }
+
+    return true;
+}
+
+/**
+ * Filters a TA model and writes the result.
+ * @param inputFile The TA file to read.
+ * @param outputFile The TA file to write.
+ * @return Whether the filter was successful.
+ */
+bool TAFilter::filterModel(string inputFile, string outputFile){
+    numKept = 0;
+    numDropped = 0;
+
+    //Works out which entities are kept. Entity types need a pass over the instances first.
+    idFilter = nullptr;
+    if (entityTypes.size() > 0){
+        if (!collectEntities(inputFile)) return false;
+        idFilter = &keptIDs;
+    } else if (allowedIDs.size() > 0){
+        idFilter = &allowedIDs;
+    }
+
+    bool success = writeFiltered(inputFile, outputFile);
+    keptIDs.clear();
+    if (success) clangPrinter->printFilterDone(numKept, numDropped);
+
+    return success;
+}
+
+/**
+ * Collects the IDs of all instances with a kept entity type.
+ * @param inputFile The TA file to read.
+ * @return Whether the file was read.
+ */
+bool TAFilter::collectEntities(string inputFile){
+    ifstream input(inputFile);
+    if (!input.is_open()){
+        clangPrinter->printErrorTAProcessRead(inputFile);
+        return false;
+    }
+    vector<char> buffer(IO_BUFFER_SIZE);
+    input.rdbuf()->pubsetbuf(buffer.data(), buffer.size());
+
+    string line;
+    bool blockComment = false;
+    SectionType section = NO_SECTION;
+    while (getline(input, line)){
+        SectionType lineSection = getSectionType(line);
+        if (lineSection != NO_SECTION){
+            section = lineSection;
+            blockComment = false;
+            continue;
+        }
+        if (section != RELATION_SECTION) continue;
+
+        //Checks for an instance.
+        vector<string> tokens = TAProcessor::prepareLine(line, blockComment);
+        if (tokens.size() != 3 || tokens.at(0).compare(entityString) != 0) continue;
+        if (entityTypes.find(tokens.at(2)) == entityTypes.end()) continue;
+        if (allowedIDs.size() > 0 && allowedIDs.find(tokens.at(1)) == allowedIDs.end()) continue;
+
+        keptIDs.insert(tokens.at(1));
+    }
+
+    return true;
+}
+
+/**
+ * Copies the lines that pass the filter to the output.
+ * @param inputFile The TA file to read.
+ * @param outputFile The TA file to write.
+ * @return Whether the output was written.
+ */
+bool TAFilter::writeFiltered(string inputFile, string outputFile){
+    ifstream input(inputFile);
+    if (!input.is_open()){
+        clangPrinter->printErrorTAProcessRead(inputFile);
+        return false;
+    }
+    ofstream output(outputFile);
+    if (!output.is_open()){
+        clangPrinter->printErrorTAProcessWrite(outputFile);
+        return false;
+    }
+
+    //Uses large buffers so we run at disk speed.
+    vector<char> inBuffer(IO_BUFFER_SIZE);
+    vector<char> outBuffer(IO_BUFFER_SIZE);
+    input.rdbuf()->pubsetbuf(inBuffer.data(), inBuffer.size());
+    output.rdbuf()->pubsetbuf(outBuffer.data(), outBuffer.size());
+
+    string line;
+    bool blockComment = false;
+    SectionType section = NO_SECTION;
+    while (getline(input, line)){
+        //Section flags and the scheme are always kept.
+        SectionType lineSection = getSectionType(line);
+        if (lineSection != NO_SECTION){
+            section = lineSection;
+            blockComment = false;
+        }
+        if (lineSection != NO_SECTION || section == NO_SECTION || section == SCHEME_SECTION){
+            output << line << "\n";
+            continue;
+        }
+
+        //Blank and comment lines are kept as well.
+        string content = TAProcessor::removeComments(line, blockComment);
+        if (content.find_first_not_of(" \t\r") == string::npos){
+            output << line << "\n";
+            continue;
+        }
+
+        //Checks the line against the filter.
+        vector<string> tokens = TAProcessor::tokenizeLine(content);
+        bool keep = true;
+        if (section == RELATION_SECTION){
+            if (tokens.size() == 3 && tokens.at(0).compare(entityString) == 0) keep = keepEntity(tokens.at(1));
+            else if (tokens.size() == 3) keep = keepRelation(tokens.at(0), tokens.at(1), tokens.at(2));
+        } else {
+            keep = keepAttributeLine(tokens);
+        }
+
+        //Writes the line.
+        if (keep){
+            output << line << "\n";
+            numKept++;
+        } else {
+            numDropped++;
+        }
+    }
+
+    output.close();
+    if (output.fail()){
+        clangPrinter->printErrorTAProcessWrite(outputFile);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Checks whether a relation is kept.
+ * @param relName The relation name.
+ * @param src The source ID.
+ * @param dst The destination ID.
+ * @return Whether the relation passes the filter.
+ */
+bool TAFilter::keepRelation(const string& relName, const string& src, const string& dst){
+    if (relations.size() > 0 && relations.find(relName) == relations.end()) return false;
+
+    return keepEntity(src) && keepEntity(dst);
+}
+
+/**
+ * Checks whether an entity is kept.
+ * @param ID The ID of the entity.
+ * @return Whether the entity passes the filter.
+ */
+bool TAFilter::keepEntity(const string& ID){
+    if (idFilter == nullptr) return true;
+    return idFilter->find(ID) != idFilter->end();
+}
+
+/**
+ * Checks whether an attribute line is kept. The line is read the same way
+ * the TA processor reads it.
+ * @param tokens The tokens of the line.
+ * @return Whether the attributes pass the filter.
+ */
+bool TAFilter::keepAttributeLine(const vector<string>& tokens){
+    if (tokens.size() == 0) return true;
+
+    //Entity attributes.
+    if (tokens.at(0).find("(") != 0) return keepEntity(tokens.at(0));
+
+    //Relation attributes. The bracket may be its own token.
+    vector<string> entry = tokens;
+    if (entry.at(0).compare("(") == 0) entry.erase(entry.begin());
+    else entry.at(0).erase(0, 1);
+    if (entry.size() < 3) return true;
+
+    string dst = entry.at(2);
+    if (dst.size() > 0 && dst.back() == ')') dst.pop_back();
+
+    return keepRelation(entry.at(0), entry.at(1), dst);
+}
+
+/**
+ * Checks whether a line starts a new section.
+ * @param line The line to check.
+ * @return The type of section, if any.
+ */
+TAFilter::SectionType TAFilter::getSectionType(const string& line){
+    if (!line.compare(0, RELATION_FLAG.size(), RELATION_FLAG)){
+        return RELATION_SECTION;
+    } else if (!line.compare(0, ATTRIBUTE_FLAG.size(), ATTRIBUTE_FLAG)){
+        return ATTRIBUTE_SECTION;
+    } else if (!line.compare(0, SCHEME_FLAG.size(), SCHEME_FLAG)){
+        return SCHEME_SECTION;
+    }
+
+    return NO_SECTION;
+}
@@ -0,0 +1,87 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// TAFilter.h
+//
+// Created By: Bryan J Muscedere
+// Date: 19/10/26.
+//
+// Projects a TA model down to a set of relations and entities without
+// loading it into a graph. Lines are streamed from the input and copied
+// as-is to the output when they pass the filter.
+//
+// Copyright (C) 2017, Bryan J. Muscedere
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CLANGEX_TAFILTER_H
+#define CLANGEX_TAFILTER_H
+
+#include <string>
+#include <vector>
+#include <unordered_set>
+#include "../Printer/Printer.h"
+
+class TAFilter {
+public:
+    /** Constructor/Destructor */
+    TAFilter(std::string entityRelName, Printer* print);
+    ~TAFilter();
+
+    /** Filter Settings */
+    void addRelation(std::string relName);
+    bool addEntityType(std::string typeName);
+    bool loadIDList(std::string fileName);
+
+    /** Filter Operations */
+    bool filterModel(std::string inputFile, std::string outputFile);
+
+private:
+    /** Section Types */
+    enum SectionType {NO_SECTION, SCHEME_SECTION, RELATION_SECTION, ATTRIBUTE_SECTION};
+
+    /** Private Flags and Strings */
+    const std::string RELATION_FLAG = "FACT TUPLE :";
+    const std::string ATTRIBUTE_FLAG = "FACT ATTRIBUTE :";
+    const std::string SCHEME_FLAG = "SCHEME TUPLE :";
+    const size_t IO_BUFFER_SIZE = 1024 * 1024;
+
+    /** Private Variables */
+    std::string entityString;
+    Printer* clangPrinter;
+
+    /** Filter Sets */
+    std::unordered_set<std::string> relations;
+    std::unordered_set<std::string> entityTypes;
+    std::unordered_set<std::string> allowedIDs;
+    std::unordered_set<std::string> keptIDs;
+    const std::unordered_set<std::string>* idFilter = nullptr;
+
+    /** Filter Counters */
+    int numKept = 0;
+    int numDropped = 0;
+
+    /** Filter Passes */
+    bool collectEntities(std::string inputFile);
+    bool writeFiltered(std::string inputFile, std::string outputFile);
+
+    /** Line Checks */
+    bool keepRelation(const std::string& relName, const std::string& src, const std::string& dst);
+    bool keepEntity(const std::string& ID);
+    bool keepAttributeLine(const std::vector<std::string>& tokens);
+
+    /** Helper Methods */
+    SectionType getSectionType(const std::string& line);
+};
+
+#endif //CLANGEX_TAFILTER_H
@@ -0,0 +1,204 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// TAMerger.cpp
+//
+// Created By: Bryan J Muscedere
+// Date: 19/10/26.
+//
+// Merges many TA models into a single model in bounded memory. Each
+// model is streamed into a set of external sorters. Instances are then
+// deduplicated, relations are joined against the instances to drop
+// dangling ones, and attributes are combined per entity or relation.
+//
+// Copyright (C) 2017, Bryan J. Muscedere
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <memory>
+#include <boost/filesystem.hpp>
+#include "TAMerger.h"
+
+using namespace std;
+namespace bs = boost::filesystem;
+
+/**
+ * Constructor. Sets up the merger.
+ * @param entityRelName The name of the instance relation.
+ * @param print The printer to use.
+ * @param memBudget The number of bytes the sorters can hold in memory.
+ * @param tempDir The directory for temporary files. Uses the system directory if empty.
+ */
+TAMerger::TAMerger(string entityRelName, Printer* print, size_t memBudget, string tempDir){
+    this->entityString = entityRelName;
+    this->clangPrinter = print;
+    this->memBudget = memBudget;
+    this->tempDir = (tempDir.compare("") == 0) ? bs::temp_directory_path().string() : tempDir;
+}
+
+/**
+ * Destructor.
+ */
+TAMerger::~TAMerger(){ }
+
+/**
+ * Merges a set of TA models into a single model.
+ * @param models The TA files to merge. Earlier models win when instance types disagree.
+ * @param outputFile The file to write the merged model to.
+ * @return Whether the merge was successful.
+ */
+bool TAMerger::mergeModels(vector<string> models, string outputFile){
+    numInstances = 0;
+    numRelations = 0;
+    numDangling = 0;
+
+    //Creates a working directory for the sorters.
+    boost::system::error_code ec;
+    bs::path workDir = bs::path(tempDir) / bs::unique_path("clangex-merge-%%%%-%%%%-%%%%");
+    bs::create_directories(workDir, ec);
+    if (ec) {
+        clangPrinter->printErrorTAProcessWrite(workDir.string());
+        return false;
+    }
+
+    bool success = runMerge(models, outputFile, workDir.string());
+    bs::remove_all(workDir, ec);
+
+    if (success) clangPrinter->printModelMergeDone((int) models.size(), numInstances, numRelations, numDangling);
+    return success;
+}
+
+/**
+ * Runs each phase of the merge.
+ * @param models The TA files to merge.
+ * @param outputFile The file to write the merged model to.
+ * @param workDir The directory for sorter runs.
+ * @return Whether the merge was successful.
+ */
+bool TAMerger::runMerge(vector<string> models, string outputFile, string workDir){
+    size_t sorterBudget = memBudget / NUM_SORTERS;
+    string idFile = workDir + "/instances.ids";
+
+    //Sets up the sorters. The first two are released once they've been used.
+    unique_ptr<ExternalSorter> instances(new ExternalSorter(workDir, "instances", sorterBudget));
+    unique_ptr<ExternalSorter> relations(new ExternalSorter(workDir, "relations", sorterBudget));
+    ExternalSorter attributes(workDir, "attributes", sorterBudget);
+    ExternalSorter relAttributes(workDir, "relAttributes", sorterBudget);
+
+    //Reads in each model.
+    bool succ = readModels(models, *instances, *relations, attributes, relAttributes);
+    if (!succ) return false;
+
+    //Opens the output.
+    ofstream output(outputFile);
+    if (!output.is_open()){
+        clangPrinter->printErrorTAProcessWrite(outputFile);
+        return false;
+    }
+    output << TAGraph().generateTAHeader() << "FACT TUPLE :\n";
+
+    //Sets up the joiner to write the TA.
+    ModelJoiner::JoinSink sink;
+    sink.instance = [&](const string& ID, const string& type){
+        output << entityString << " " << ID << " " << type << "\n";
+        return !output.fail();
+    };
+    sink.relation = [&](const string& relName, const string& src, const string& dst){
+        output << relName << " " << src << " " << dst << "\n";
+        return !output.fail();
+    };
+    sink.entityAttributes = [&](const string& ID, const TAProcessor::AttributeList& attrs){
+        output << ID << TAProcessor::generateAttributeStringFromKVs(attrs) << "\n";
+        return !output.fail();
+    };
+    sink.relationAttributes = [&](const string& relName, const string& srcID, const string& dstID,
+                                  const TAProcessor::AttributeList& attrs){
+        output << "(" << relName << " " << srcID << " " << dstID << ")"
+               << TAProcessor::generateAttributeStringFromKVs(attrs) << "\n";
+        return !output.fail();
+    };
+    ModelJoiner joiner(sink);
+
+    //Writes the instances.
+    succ = joiner.writeInstances(*instances, idFile);
+    instances.reset();
+    if (!succ) return false;
+
+    //Joins the relations on both ends.
+    ExternalSorter joined(workDir, "joined", sorterBudget);
+    succ = joiner.joinRelations(*relations, joined, idFile);
+    relations.reset();
+    if (!succ) return false;
+    succ = joiner.writeRelations(joined, relAttributes, idFile);
+    numInstances = joiner.getNumInstances();
+    numRelations = joiner.getNumRelations();
+    numDangling = joiner.getNumDangling();
+    if (!succ) return false;
+
+    //Writes the attributes.
+    output << "\nFACT ATTRIBUTE :\n";
+    succ = attributes.sort() && joiner.writeAttributes(attributes, idFile);
+    if (!succ) return false;
+    succ = relAttributes.sort() && joiner.writeRelAttributes(relAttributes);
+    if (!succ) return false;
+
+    output.close();
+    if (output.fail()){
+        clangPrinter->printErrorTAProcessWrite(outputFile);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Streams each model into the sorters.
+ * @param models The TA files to read.
+ * @param instances Sorter for instances, keyed by ID.
+ * @param relations Sorter for relations, keyed by source.
+ * @param attributes Sorter for entity attributes, keyed by ID.
+ * @param relAttributes Sorter for relation attributes, keyed by relation.
+ * @return Whether the models were read successfully.
+ */
+bool TAMerger::readModels(vector<string> models, ExternalSorter& instances, ExternalSorter& relations,
+                          ExternalSorter& attributes, ExternalSorter& relAttributes){
+    for (const string& model : models){
+        clangPrinter->printMerge(model);
+
+        //Sets up the handler.
+        TAProcessor processor = TAProcessor(entityString, clangPrinter);
+        TAProcessor::TAHandler handler;
+        handler.relation = [&](const string& relName, const string& src, const string& dst){
+            if (relName.compare(entityString) == 0)
+                return instances.add(src + RecordCodec::FIELD_SEP + codec.nextSeq() + RecordCodec::FIELD_SEP + dst);
+
+            return relations.add(src + RecordCodec::FIELD_SEP + relName + RecordCodec::FIELD_SEP + dst);
+        };
+        handler.entityAttributes = [&](const string& ID, const TAProcessor::AttributeList& attrs){
+            return attributes.add(ID + RecordCodec::FIELD_SEP + codec.nextSeq() + RecordCodec::FIELD_SEP +
+                                  RecordCodec::encodeAttributes(attrs));
+        };
+        handler.relationAttributes = [&](const string& relName, const string& srcID, const string& dstID,
+                                         const TAProcessor::AttributeList& attrs){
+            return relAttributes.add(srcID + RecordCodec::FIELD_SEP + relName + RecordCodec::FIELD_SEP + dstID +
+                                     RecordCodec::FIELD_SEP + RecordCodec::ATTR_FLAG + RecordCodec::FIELD_SEP +
+                                     codec.nextSeq() + RecordCodec::FIELD_SEP + RecordCodec::encodeAttributes(attrs));
+        };
+
+        //Reads the model.
+        bool succ = processor.readTAFile(model, handler);
+        if (!succ) return false;
+    }
+
+    return instances.sort() && relations.sort();
+}
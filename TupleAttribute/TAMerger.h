@@ -0,0 +1,70 @@
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// TAMerger.h
+//
+// Created By: Bryan J Muscedere
+// Date: 19/10/26.
+//
+// Merges many TA models into a single model in bounded memory. Each
+// model is streamed into a set of external sorters. Instances are then
+// deduplicated, relations are joined against the instances to drop
+// dangling ones, and attributes are combined per entity or relation.
+//
+// Copyright (C) 2017, Bryan J. Muscedere
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CLANGEX_TAMERGER_H
+#define CLANGEX_TAMERGER_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include "ExternalSorter.h"
+#include "RecordCodec.h"
+#include "ModelJoiner.h"
+#include "TAProcessor.h"
+
+class TAMerger {
+public:
+    /** Constructor/Destructor */
+    TAMerger(std::string entityRelName, Printer* print, size_t memBudget, std::string tempDir = std::string());
+    ~TAMerger();
+
+    /** Merge Operations */
+    bool mergeModels(std::vector<std::string> models, std::string outputFile);
+
+private:
+    /** Private Constants */
+    const int NUM_SORTERS = 4;
+
+    /** Private Variables */
+    std::string entityString;
+    Printer* clangPrinter;
+    size_t memBudget;
+    std::string tempDir;
+    RecordCodec codec;
+
+    /** Merge Counters */
+    int numInstances = 0;
+    int numRelations = 0;
+    int numDangling = 0;
+
+    /** Merge Phases */
+    bool runMerge(std::vector<std::string> models, std::string outputFile, std::string workDir);
+    bool readModels(std::vector<std::string> models, ExternalSorter& instances, ExternalSorter& relations,
+                    ExternalSorter& attributes, ExternalSorter& relAttributes);
+};
+
+#endif //CLANGEX_TAMERGER_H
@@ -26,12 +26,22 @@
 /////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include <fstream>
+#include <thread>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <boost/algorithm/string/split.hpp>
 #include <boost/algorithm/string/classification.hpp>
 #include "TAProcessor.h"
+#include "../Driver/TraceRecorder.h"
 
 using namespace std;
 
+const char TAProcessor::COMMENT_CHAR;
+const char TAProcessor::COMMENT_BLOCK_CHAR;
+
 /**
  * Left trim string.
  * @param s The string to trim.
@@ -78,24 +88,43 @@ TAProcessor::TAProcessor(string entityRelName, Printer* print) : clangPrinter(pr
 TAProcessor::~TAProcessor(){ }
 
 /**
- * Reads the TA file from a given file name.
+ * Reads the TA file from a given file name. The file is mapped into memory
+ * so that large sections can be split between threads.
  * @param fileName The file name to read from.
  * @return Whether it was read successfully.
  */
 bool TAProcessor::readTAFile(string fileName){
-    //Starts by creating the file stream.
-    ifstream modelStream(fileName);
+    //Starts by opening the file.
+    int fd = open(fileName.c_str(), O_RDONLY);
 
     //Check if the file opens.
-    if (!modelStream.is_open()){
+    if (fd == -1){
+        clangPrinter->printErrorTAProcessRead(fileName);
+        return false;
+    }
+
+    //An empty file has no fact tuple section.
+    struct stat fileInfo;
+    if (fstat(fd, &fileInfo) == -1 || fileInfo.st_size == 0){
+        close(fd);
+        return false;
+    }
+
+    //Maps the file.
+    size_t size = (size_t) fileInfo.st_size;
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED){
+        close(fd);
         clangPrinter->printErrorTAProcessRead(fileName);
         return false;
     }
+    madvise(data, size, MADV_SEQUENTIAL);
 
     //Next starts the main loop.
-    bool success = readGeneric(modelStream, fileName);
+    bool success = readGeneric((const char*) data, size);
 
-    modelStream.close();
+    munmap(data, size);
+    close(fd);
     return success;
 }
 
@@ -159,245 +188,551 @@ TAGraph* TAProcessor::writeTAGraph(){
 }
 
 /**
- * From a file, reads each line. This method decides how to proceed.
- * @param modelStream The stream of the filename.
- * @param fileName The filename being read from.
+ * Reads the TA file straight into a graph. Nothing is kept in this processor's
+ * tables, so the model is only held in memory once.
+ * @param fileName The file name to read from.
+ * @param graph The graph to read into.
+ * @return Whether it was read successfully.
+ */
+bool TAProcessor::readTAFile(string fileName, TAGraph* graph){
+    if (graph == nullptr){
+        clangPrinter->printErrorTAProcessGraph();
+        return false;
+    }
+
+    //Sets up the handler to write to the graph.
+    TAHandler handler;
+    handler.relation = [this, graph](const string& relName, const string& src, const string& dst){
+        return streamRelation(graph, relName, src, dst);
+    };
+    handler.entityAttributes = [this, graph](const string& ID, const AttributeList& attrs){
+        return streamAttributes(graph, ID, attrs);
+    };
+    handler.relationAttributes = [this, graph](const string& relName, const string& srcID,
+                                               const string& dstID, const AttributeList& attrs){
+        return streamAttributes(graph, relName, srcID, dstID, attrs);
+    };
+
+    return readTAFile(fileName, handler);
+}
+
+/**
+ * Reads the TA file and passes each entry to a handler in file order. Nothing
+ * is kept in this processor's tables. Reading stops if a callback returns false.
+ * @param fileName The file name to read from.
+ * @param handler The callbacks to pass entries to. Unset callbacks are skipped.
+ * @return Whether it was read successfully.
+ */
+bool TAProcessor::readTAFile(string fileName, const TAHandler& handler){
+    streamHandler = &handler;
+    bool success = readTAFile(fileName);
+    streamHandler = nullptr;
+
+    return success;
+}
+
+/**
+ * Goes through each section of a mapped TA file. This method decides how to proceed.
+ * @param data The contents of the file.
+ * @param size The size of the file.
  * @return Whether it was successful.
  */
-bool TAProcessor::readGeneric(ifstream& modelStream, string fileName){
-    bool running = true;
+bool TAProcessor::readGeneric(const char* data, size_t size){
     bool tupleEncountered = false;
 
-    //Starts by iterating until complete.
-    string curLine;
-    int line = 1;
-    while(running){
-        //We've hit the end.
-        if (!getline(modelStream, curLine)){
-            running = false;
-            continue;
-        }
+    //Finds where each section starts.
+    vector<pair<size_t, SectionType>> flags = findSectionFlags(data, size);
+    if (flags.size() == 0) return false;
+
+    int line = 1 + countLines(data, data + flags.at(0).first);
+    SectionType prevSection = NO_SECTION;
+    for (int i = 0; i < flags.size(); i++){
+        SectionType section = flags.at(i).second;
+
+        //Gets the bounds of the section. The flag line itself is skipped.
+        const char* flagLine = data + flags.at(i).first;
+        const char* flagEnd = (const char*) memchr(flagLine, '\n', size - flags.at(i).first);
+        const char* begin = (flagEnd == nullptr) ? data + size : flagEnd + 1;
+        const char* end = (i + 1 == flags.size()) ? data + size : data + flags.at(i + 1).first;
+
+        //We now check the section.
+        bool success = true;
+        if (section == SCHEME_SECTION){
+            if (prevSection == SCHEME_SECTION){
+                clangPrinter->printErrorTAProcess(line, UNEXPECTED_FLAG);
+                return false;
+            }
 
-        //We now check the line.
-        if (!curLine.compare(0, SCHEME_FLAG.size(), SCHEME_FLAG)){
             //Fast forward.
-            bool success = readScheme(modelStream, &line);
-            if (!success) return false;
-
-        } else if (!curLine.compare(0, RELATION_FLAG.size(), RELATION_FLAG)){
+            line += 1 + countLines(begin, end);
+        } else if (section == RELATION_SECTION){
+            if (prevSection == RELATION_SECTION){
+                clangPrinter->printErrorTAProcess(line, UNEXPECTED_FLAG);
+                return false;
+            }
             tupleEncountered = true;
 
             //Reads the relations.
-            bool success = readRelations(modelStream, &line);
-            if (!success) return false;
-        } else if (!curLine.compare(0, ATTRIBUTE_FLAG.size(), ATTRIBUTE_FLAG)){
+            line++;
+            success = readSection(begin, end, RELATION_SECTION, line);
+        } else if (section == ATTRIBUTE_SECTION){
             if (tupleEncountered == false){
                 clangPrinter->printErrorTAProcess(line, ATTRIBUTE_FLAG + " encountered before " + RELATION_FLAG + "!");
                 return false;
             }
 
             //Reads the attributes.
-            bool success = readAttributes(modelStream, &line);
-            if (!success) return false;
+            line++;
+            success = readSection(begin, end, ATTRIBUTE_SECTION, line);
         }
+        if (!success) return false;
 
-        line++;
+        prevSection = section;
     }
 
     //Checks whether we've encountered a "fact tuple" section.
-    if (tupleEncountered){
-        return true;
-    }
-
-    return false;
+    return tupleEncountered;
 }
 
 /**
- * Reader that reads the schema section of the file.
- * @param modelStream The model stream.
- * @param lineNum The current line number.
- * @return Whether or not it was successful.
+ * Finds the start of every line that begins with a section flag.
+ * @param data The contents of the file.
+ * @param size The size of the file.
+ * @return The offset and type of each section in file order.
  */
-bool TAProcessor::readScheme(ifstream& modelStream, int* lineNum){
-    string line;
-
-    //Start iterating through
-    auto pos = modelStream.tellg();
-    while(getline(modelStream, line)){
-        //Check the line.
-        if (!line.compare(0, SCHEME_FLAG.size(), SCHEME_FLAG)){
-            //Invalid input.
-            clangPrinter->printErrorTAProcess(*lineNum, UNEXPECTED_FLAG);
-
-            return false;
-        } else if (!line.compare(0, RELATION_FLAG.size(), RELATION_FLAG) ||
-                !line.compare(0, ATTRIBUTE_FLAG.size(), ATTRIBUTE_FLAG)) {
-            //Breaks out of the loop.
-            break;
+vector<pair<size_t, TAProcessor::SectionType>> TAProcessor::findSectionFlags(const char* data, size_t size){
+    vector<pair<size_t, SectionType>> flags;
+    const string flagStarts[2] = {"\n" + RELATION_FLAG.substr(0, RELATION_FLAG.find(' ') + 1),
+                                  "\n" + SCHEME_FLAG.substr(0, SCHEME_FLAG.find(' ') + 1)};
+
+    //Checks the very first line.
+    SectionType type = getSectionType(data, size, 0);
+    if (type != NO_SECTION) flags.push_back(pair<size_t, SectionType>(0, type));
+
+    //Looks for the remaining flags. Each pattern is only scanned for once.
+    for (const string& start : flagStarts){
+        const char* cur = data;
+        const char* end = data + size;
+        while (cur < end){
+            const char* found = (const char*) memmem(cur, end - cur, start.c_str(), start.size());
+            if (found == nullptr) break;
+
+            size_t offset = found - data + 1;
+            type = getSectionType(data, size, offset);
+            if (type != NO_SECTION) flags.push_back(pair<size_t, SectionType>(offset, type));
+            cur = found + 1;
         }
+    }
 
-        //Get the current line.
-        pos = modelStream.tellg();
-        (*lineNum)++;
+    sort(flags.begin(), flags.end());
+    return flags;
+}
+
+/**
+ * Checks whether a line starts with a section flag.
+ * @param data The contents of the file.
+ * @param size The size of the file.
+ * @param offset The start of the line.
+ * @return The type of section, if any.
+ */
+TAProcessor::SectionType TAProcessor::getSectionType(const char* data, size_t size, size_t offset){
+    const char* line = data + offset;
+    size_t remaining = size - offset;
+
+    if (remaining >= RELATION_FLAG.size() && !memcmp(line, RELATION_FLAG.c_str(), RELATION_FLAG.size())){
+        return RELATION_SECTION;
+    } else if (remaining >= ATTRIBUTE_FLAG.size() && !memcmp(line, ATTRIBUTE_FLAG.c_str(), ATTRIBUTE_FLAG.size())){
+        return ATTRIBUTE_SECTION;
+    } else if (remaining >= SCHEME_FLAG.size() && !memcmp(line, SCHEME_FLAG.c_str(), SCHEME_FLAG.size())){
+        return SCHEME_SECTION;
     }
 
-    //Seeks backward.
-    modelStream.seekg(pos);
-    return true;
+    return NO_SECTION;
 }
 
 /**
- * Reads the relation section from the TA file.
- * @param modelStream The model stream.
- * @param lineNum The current line number.
+ * Reads a fact section. Large sections are split into chunks at line boundaries
+ * and each chunk is parsed on its own thread into local tables. The local tables
+ * are then merged back in file order. When streaming, the chunks are parsed a
+ * few at a time and their entries are passed to the handler in file order.
+ * @param begin The start of the section.
+ * @param end The end of the section.
+ * @param type The type of section being read.
+ * @param lineNum The line number of the first line. Updated to the line after the section.
  * @return Whether or not it was successful.
  */
-bool TAProcessor::readRelations(ifstream& modelStream, int* lineNum){
-    string line;
-    bool blockComment = false;
-    (*lineNum)--;
-
-    //Start iterating through
-    auto pos = modelStream.tellg();
-    while(getline(modelStream, line)){
-        if (!line.compare(0, SCHEME_FLAG.size(), SCHEME_FLAG) ||
-            !line.compare(0, ATTRIBUTE_FLAG.size(), ATTRIBUTE_FLAG)) {
-            //Breaks out of the loop.
-            break;
-        } else if (!line.compare(0, RELATION_FLAG.size(), RELATION_FLAG)) {
-            //Invalid input.
-            clangPrinter->printErrorTAProcess(*lineNum, UNEXPECTED_FLAG);
+bool TAProcessor::readSection(const char* begin, const char* end, SectionType type, int& lineNum){
+    //Splits the section into chunks.
+    vector<const char*> bounds = splitSection(begin, end, streamHandler != nullptr);
+    int numChunks = (int) bounds.size() - 1;
+    if (numChunks == 1){
+        bool success = readChunk(begin, end, type, false, lineNum);
+        lineNum += countLines(begin, end);
+        return success;
+    }
 
-            return false;
-        }
+    //Works out the block comment state at the end of each chunk for both possible start states.
+    vector<char> endIfClosed(numChunks);
+    vector<char> endIfOpen(numChunks);
+    vector<int> chunkLines(numChunks);
+    runChunks(numChunks, [&](int i){
+        endIfClosed.at(i) = scanBlockComments(bounds.at(i), bounds.at(i + 1), false, &chunkLines.at(i));
+        endIfOpen.at(i) = scanBlockComments(bounds.at(i), bounds.at(i + 1), true, nullptr);
+    });
+
+    //Now, resolves the state and line number each chunk starts with.
+    vector<char> startState(numChunks);
+    vector<int> startLine(numChunks);
+    bool blockComment = false;
+    for (int i = 0; i < numChunks; i++){
+        startState.at(i) = blockComment;
+        startLine.at(i) = lineNum;
 
-        (*lineNum)++;
+        blockComment = (blockComment) ? endIfOpen.at(i) : endIfClosed.at(i);
+        lineNum += chunkLines.at(i);
+    }
+    if (streamHandler != nullptr) return streamChunks(bounds, type, startState, startLine);
+
+    //Parses each chunk into its own tables.
+    vector<TAProcessor*> chunkTables(numChunks);
+    vector<char> results(numChunks);
+    runChunks(numChunks, [&](int i){
+        TraceRecorder::Span span("readChunk");
+        chunkTables.at(i) = new TAProcessor(entityString, clangPrinter);
+        results.at(i) = chunkTables.at(i)->readChunk(bounds.at(i), bounds.at(i + 1), type,
+                                                     startState.at(i), startLine.at(i));
+    });
+
+    //Merges the tables in order.
+    bool success = true;
+    for (int i = 0; i < numChunks; i++){
+        if (!results.at(i)) success = false;
+        if (success) mergeTables(*chunkTables.at(i));
+
+        delete chunkTables.at(i);
+    }
 
-        //Tokenize.
-        vector<string> entry = prepareLine(line, blockComment);
-        if ((blockComment && entry.size() == 0) || entry.size() == 0) continue;
+    return success;
+}
 
-        //Check whether the entry is valid.
-        if (entry.size() != 3) {
-            clangPrinter->printErrorTAProcess(*lineNum, RSF_INVALID);
-            return false;
-        }
+/**
+ * Splits a section into roughly equal chunks that end on line boundaries.
+ * @param begin The start of the section.
+ * @param end The end of the section.
+ * @param streaming Whether the chunks are streamed. Streamed chunks are kept near the
+ * minimum size since their entries are held until they're passed on.
+ * @return The chunk boundaries, including the start and end of the section.
+ */
+vector<const char*> TAProcessor::splitSection(const char* begin, const char* end, bool streaming){
+    vector<const char*> bounds;
+    bounds.push_back(begin);
+
+    //Determines the number of chunks.
+    size_t size = end - begin;
+    size_t numChunks = max((size_t) 1, size / MIN_CHUNK_SIZE);
+    if (!streaming) numChunks = min(numChunks, max((size_t) 1, (size_t) thread::hardware_concurrency()));
+
+    //Moves each boundary forward to the start of the next line.
+    for (size_t i = 1; i < numChunks; i++){
+        const char* cur = begin + (size / numChunks) * i;
+        if (cur <= bounds.back()) continue;
+
+        const char* lineEnd = (const char*) memchr(cur, '\n', end - cur);
+        if (lineEnd == nullptr || lineEnd + 1 >= end) break;
+        bounds.push_back(lineEnd + 1);
+    }
+    bounds.push_back(end);
 
-        //Next, gets the relation name.
-        auto relName = entry.at(0);
-        auto toName = entry.at(1);
-        auto fromName = entry.at(2);
+    return bounds;
+}
 
-        //Finds if a pair exists.
-        int pos = findRelEntry(relName);
-        if (pos == -1) {
-            createRelEntry(relName);
-            pos = (int) relations.size() - 1;
-        }
+/**
+ * Runs a job for each chunk. Each thread takes every nth chunk, with at most
+ * one thread per core.
+ * @param numChunks The number of chunks.
+ * @param job The job to run.
+ */
+void TAProcessor::runChunks(int numChunks, const function<void(int)>& job){
+    int numThreads = min(numChunks, max(1, (int) thread::hardware_concurrency()));
+    auto runThread = [&](int first){
+        for (int i = first; i < numChunks; i += numThreads) job(i);
+    };
+
+    vector<thread> workers;
+    for (int i = 1; i < numThreads; i++){
+        workers.push_back(thread(runThread, i));
+    }
 
-        //Creates a to from pair.
-        pair<string, string> edge = pair<string, string>();
-        edge.first = toName;
-        edge.second = fromName;
+    runThread(0);
+    for (thread& worker : workers) worker.join();
+}
 
-        //Inserts it.
-        relations.at(pos).second.insert(edge);
+/**
+ * Parses the chunks of a streamed section. A round of chunks is parsed in
+ * parallel, with each chunk's entries held in order. The entries are then
+ * passed to the handler in file order before the next round starts.
+ * @param bounds The chunk boundaries.
+ * @param type The type of section being read.
+ * @param startState Whether each chunk starts inside a block comment.
+ * @param startLine The line number each chunk starts on.
+ * @return Whether or not it was successful.
+ */
+bool TAProcessor::streamChunks(const vector<const char*>& bounds, SectionType type, const vector<char>& startState,
+                               const vector<int>& startLine){
+    int numChunks = (int) bounds.size() - 1;
+    int roundSize = max(1, (int) thread::hardware_concurrency());
+    const TAHandler& handler = *streamHandler;
+
+    for (int first = 0; first < numChunks; first += roundSize){
+        int numRound = min(roundSize, numChunks - first);
+        vector<vector<StreamEntry>> entries(numRound);
+        vector<char> results(numRound);
+
+        //Parses each chunk, holding the entries the handler wants.
+        runChunks(numRound, [&](int i){
+            TraceRecorder::Span span("readChunk");
+            vector<StreamEntry>& chunkEntries = entries.at(i);
+
+            TAHandler recorder;
+            if (handler.relation) {
+                recorder.relation = [&chunkEntries](const string& relName, const string& src, const string& dst){
+                    chunkEntries.push_back(StreamEntry{RELATION_ENTRY, relName, src, dst, AttributeList()});
+                    return true;
+                };
+            }
+            if (handler.entityAttributes) {
+                recorder.entityAttributes = [&chunkEntries](const string& ID, const AttributeList& attrs){
+                    chunkEntries.push_back(StreamEntry{ATTRIBUTE_ENTRY, ID, string(), string(), attrs});
+                    return true;
+                };
+            }
+            if (handler.relationAttributes) {
+                recorder.relationAttributes = [&chunkEntries](const string& relName, const string& srcID,
+                                                              const string& dstID, const AttributeList& attrs){
+                    chunkEntries.push_back(StreamEntry{REL_ATTRIBUTE_ENTRY, relName, srcID, dstID, attrs});
+                    return true;
+                };
+            }
 
+            TAProcessor reader(entityString, clangPrinter);
+            reader.streamHandler = &recorder;
+            int chunk = first + i;
+            results.at(i) = reader.readChunk(bounds.at(chunk), bounds.at(chunk + 1), type, startState.at(chunk),
+                                             startLine.at(chunk));
+        });
+
+        //Passes the entries on in file order. Entries before a bad line are still passed on.
+        for (int i = 0; i < numRound; i++){
+            for (const StreamEntry& entry : entries.at(i)){
+                bool succ;
+                if (entry.type == RELATION_ENTRY) succ = handler.relation(entry.name, entry.src, entry.dst);
+                else if (entry.type == ATTRIBUTE_ENTRY) succ = handler.entityAttributes(entry.name, entry.attrs);
+                else succ = handler.relationAttributes(entry.name, entry.src, entry.dst, entry.attrs);
+
+                if (!succ) return false;
+            }
+            if (!results.at(i)) return false;
+            entries.at(i).clear();
+        }
     }
 
-    //Seeks backward.
-    modelStream.seekg(pos);
+    return true;
+}
+
+/**
+ * Reads a chunk of a fact section line by line.
+ * @param begin The start of the chunk.
+ * @param end The end of the chunk.
+ * @param type The type of section being read.
+ * @param blockComment Whether the chunk starts inside a block comment.
+ * @param lineNum The line number of the first line.
+ * @return Whether or not it was successful.
+ */
+bool TAProcessor::readChunk(const char* begin, const char* end, SectionType type, bool blockComment, int lineNum){
+    const char* cur = begin;
+    while (cur < end){
+        const char* lineEnd = (const char*) memchr(cur, '\n', end - cur);
+        if (lineEnd == nullptr) lineEnd = end;
+
+        //Processes the line.
+        string line = string(cur, lineEnd);
+        bool succ = (type == RELATION_SECTION) ? readRelationLine(line, lineNum, blockComment) :
+                    readAttributeLine(line, lineNum, blockComment);
+        if (!succ) return false;
+
+        cur = lineEnd + 1;
+        lineNum++;
+    }
 
     return true;
 }
 
 /**
- * Reads the attributes from the TA file.
- * @param modelStream The model stream.
+ * Reads a single line from the relation section.
+ * @param line The line to read.
  * @param lineNum The current line number.
+ * @param blockComment Whether a block comment was encountered.
  * @return Whether or not it was successful.
  */
-bool TAProcessor::readAttributes(ifstream& modelStream, int* lineNum){
-    string line;
-    bool blockComment = false;
-    (*lineNum)--;
-
-    //Start iterating through
-    auto pos = modelStream.tellg();
-    while(getline(modelStream, line)) {
-        (*lineNum)++;
-
-        //Prepare the line.
-        vector<string> entry = prepareLine(line, blockComment);
-        if ((blockComment && entry.size() == 0) || entry.size() == 0) continue;
-
-        //Checks for what type of system we're dealing with.
-        bool succ = true;
-        if (entry.at(0).compare("(") == 0 || entry.at(0).find("(") == 0) {
-            //Relation attribute.
-            if (entry.at(0).compare("(") == 0){
-                entry.erase(entry.begin());
-            } else {
-                entry.at(0).erase(0, 1);
-            }
+bool TAProcessor::readRelationLine(const string& line, int lineNum, bool& blockComment){
+    //Tokenize.
+    vector<string> entry = prepareLine(line, blockComment);
+    if (entry.size() == 0) return true;
+
+    //Check whether the entry is valid.
+    if (entry.size() != 3) {
+        clangPrinter->printErrorTAProcess(lineNum, RSF_INVALID);
+        return false;
+    }
 
-            //Check for valid entry.
-            if (entry.size() < 3 || entry.at(1).compare(")") == 0 || entry.at(2).compare(")") == 0){
-                clangPrinter->printErrorTAProcess(*lineNum, ATTRIBUTE_SHORT);
-                return false;
-            }
+    //Next, gets the relation name.
+    const string& relName = entry.at(0);
+    if (streamHandler != nullptr){
+        return !streamHandler->relation || streamHandler->relation(relName, entry.at(1), entry.at(2));
+    }
 
-            //Gets the relation name.
-            string relName = entry.at(0);
-            entry.erase(entry.begin());
+    //Finds if a pair exists.
+    int pos = findRelEntry(relName);
+    if (pos == -1) {
+        createRelEntry(relName);
+        pos = (int) relations.size() - 1;
+    }
+
+    //Inserts the to from pair.
+    relations.at(pos).second.insert(pair<string, string>(entry.at(1), entry.at(2)));
+    return true;
+}
 
-            //Gets the IDs.
-            string srcID = entry.at(0);
+/**
+ * Reads a single line from the attribute section.
+ * @param line The line to read.
+ * @param lineNum The current line number.
+ * @param blockComment Whether a block comment was encountered.
+ * @return Whether or not it was successful.
+ */
+bool TAProcessor::readAttributeLine(const string& line, int lineNum, bool& blockComment){
+    //Prepare the line.
+    vector<string> entry = prepareLine(line, blockComment);
+    if (entry.size() == 0) return true;
+
+    //Checks for what type of system we're dealing with.
+    bool succ = true;
+    if (entry.at(0).compare("(") == 0 || entry.at(0).find("(") == 0) {
+        //Relation attribute.
+        if (entry.at(0).compare("(") == 0){
             entry.erase(entry.begin());
-            string dstID = entry.at(0);
-            if (dstID.back() == ')'){
-                dstID.erase(dstID.size() - 1, 1);
-                entry.erase(entry.begin());
-            } else {
-                entry.erase(entry.begin());
-                entry.erase(entry.begin());
-            }
+        } else {
+            entry.at(0).erase(0, 1);
+        }
 
+        //Check for valid entry.
+        if (entry.size() < 3 || entry.at(1).compare(")") == 0 || entry.at(2).compare(")") == 0){
+            clangPrinter->printErrorTAProcess(lineNum, ATTRIBUTE_SHORT);
+            return false;
+        }
 
-            //Generates the attribute list.
-            auto attrs = generateAttributes(*lineNum, succ, entry);
-            if (!succ) return false;
+        //Gets the relation name.
+        string relName = entry.at(0);
+        entry.erase(entry.begin());
 
-            //Next, we insert
-            int pos = findAttrEntry(relName, srcID, dstID);
-            if (pos == -1) {
-                createAttrEntry(relName, srcID, dstID);
-                pos = (int) relAttributes.size() - 1;
-            }
-            this->relAttributes.at(pos).second = attrs;
+        //Gets the IDs.
+        string srcID = entry.at(0);
+        entry.erase(entry.begin());
+        string dstID = entry.at(0);
+        if (dstID.back() == ')'){
+            dstID.erase(dstID.size() - 1, 1);
+            entry.erase(entry.begin());
         } else {
-            //Regular attribute.
-            //Gets the name and trims down the vector.
-            string attrName = entry.at(0);
             entry.erase(entry.begin());
+            entry.erase(entry.begin());
+        }
 
-            //Generates the attribute list.
-            auto attrs = generateAttributes(*lineNum, succ, entry);
-            if (!succ) return false;
+        //Generates the attribute list.
+        auto attrs = generateAttributes(lineNum, succ, entry);
+        if (!succ) return false;
+        if (streamHandler != nullptr){
+            return !streamHandler->relationAttributes ||
+                   streamHandler->relationAttributes(relName, srcID, dstID, attrs);
+        }
 
-            //Next, we insert
-            int pos = findAttrEntry(attrName);
-            if (pos == -1) {
-                createAttrEntry(attrName);
-                pos = (int) attributes.size() - 1;
-            }
-            this->attributes.at(pos).second = attrs;
+        //Next, we insert
+        int pos = findAttrEntry(relName, srcID, dstID);
+        if (pos == -1) {
+            createAttrEntry(relName, srcID, dstID);
+            pos = (int) relAttributes.size() - 1;
+        }
+        this->relAttributes.at(pos).second = attrs;
+    } else {
+        //Regular attribute.
+        //Gets the name and trims down the vector.
+        string attrName = entry.at(0);
+        entry.erase(entry.begin());
+
+        //Generates the attribute list.
+        auto attrs = generateAttributes(lineNum, succ, entry);
+        if (!succ) return false;
+        if (streamHandler != nullptr){
+            return !streamHandler->entityAttributes || streamHandler->entityAttributes(attrName, attrs);
         }
+
+        //Next, we insert
+        int pos = findAttrEntry(attrName);
+        if (pos == -1) {
+            createAttrEntry(attrName);
+            pos = (int) attributes.size() - 1;
+        }
+        this->attributes.at(pos).second = attrs;
     }
 
     return true;
 }
 
+/**
+ * Merges the tables of another processor into this one. Attributes that were
+ * already read are replaced, just like a later line in the same file.
+ * @param other The processor to merge in. Its tables are emptied.
+ */
+void TAProcessor::mergeTables(TAProcessor& other){
+    //Merges the relations.
+    for (auto& rel : other.relations){
+        int pos = findRelEntry(rel.first);
+        if (pos == -1){
+            createRelEntry(rel.first);
+            relations.back().second = std::move(rel.second);
+            continue;
+        }
+
+        relations.at(pos).second.insert(rel.second.begin(), rel.second.end());
+    }
+
+    //Merges the entity attributes.
+    for (auto& attr : other.attributes){
+        int pos = findAttrEntry(attr.first);
+        if (pos == -1){
+            createAttrEntry(attr.first);
+            pos = (int) attributes.size() - 1;
+        }
+
+        attributes.at(pos).second = std::move(attr.second);
+    }
+
+    //Merges the relation attributes.
+    for (auto& attr : other.relAttributes){
+        const vector<string>& items = attr.first;
+        int pos = findAttrEntry(items.at(0), items.at(1), items.at(2));
+        if (pos == -1){
+            createAttrEntry(items.at(0), items.at(1), items.at(2));
+            pos = (int) relAttributes.size() - 1;
+        }
+
+        relAttributes.at(pos).second = std::move(attr.second);
+    }
+
+    other.relations.clear();
+    other.attributes.clear();
+    other.relAttributes.clear();
+}
+
 /**
  * Writes relations to a TA graph.
  * @param graph The graph to write to.
@@ -412,8 +747,8 @@ bool TAProcessor::writeRelations(TAGraph* graph){
     }
 
     //Gets the entity relation.
-    auto entity = relations.at(pos).second;
-    for (auto entry : entity){
+    const auto& entity = relations.at(pos).second;
+    for (const auto& entry : entity){
         //Gets the name.
         string ID = entry.first;
 
@@ -426,16 +761,16 @@ bool TAProcessor::writeRelations(TAGraph* graph){
     }
 
     //Next, processes the other relationships.
-    int i = 0;
-    for (auto rels : relations){
+    for (int i = 0; i < relations.size(); i++){
         if (i == pos) continue;
 
+        const auto& rels = relations.at(i);
         string relName = rels.first;
         ClangEdge::EdgeType type = ClangEdge::getTypeEdge(relName);
 
-        std::set<pair<string, string>>::iterator it;
+        std::set<pair<string, string>>::const_iterator it;
         for (it = rels.second.begin(); it != rels.second.end(); it++) {
-            auto nodes = *it;
+            const auto& nodes = *it;
 
             //Gets the nodes.
             ClangNode* src = graph->findNodeByID(nodes.first);
@@ -466,17 +801,17 @@ bool TAProcessor::writeRelations(TAGraph* graph){
  */
 bool TAProcessor::writeAttributes(TAGraph* graph){
     //We simply go through and process them.
-    for (auto attr : attributes){
-        string itemID = attr.first;
+    for (const auto& attr : attributes){
+        const string& itemID = attr.first;
 
         //Next, we go through all the KVs.
-        for (auto kv : attr.second){
-            string key = kv.first;
-            vector<string> values = kv.second;
+        for (const auto& kv : attr.second){
+            const string& key = kv.first;
+            const vector<string>& values = kv.second;
 
             //Now, updates the attributes.
-            for (auto value : values) {
-                bool succ = graph->addAttribute(itemID, key, value);
+            for (const auto& value : values) {
+                bool succ = graph->addAttribute(itemID, key, stripQuotes(value));
                 if (!succ) {
                     clangPrinter->printErrorTAProcess(Printer::ENTITY_ATTRIBUTE, itemID);
                     return false;
@@ -486,8 +821,8 @@ bool TAProcessor::writeAttributes(TAGraph* graph){
     }
 
     //Next, we deal with relation attributes.
-    for (auto attr : relAttributes){
-        vector<string> items = attr.first;
+    for (const auto& attr : relAttributes){
+        const vector<string>& items = attr.first;
         if (items.size() != 3) {
             clangPrinter->printErrorTAProcessMalformed();
             return false;
@@ -498,13 +833,13 @@ bool TAProcessor::writeAttributes(TAGraph* graph){
         string dstID = items.at(2);
 
         //Next, we go through all the KVs.
-        for (auto kv : attr.second){
-            string key = kv.first;
-            vector<string> values = kv.second;
+        for (const auto& kv : attr.second){
+            const string& key = kv.first;
+            const vector<string>& values = kv.second;
 
             //Now, updates the attributes.
-            for (auto value : values) {
-                bool succ = graph->addAttribute(srcID, dstID, relName, key, value);
+            for (const auto& value : values) {
+                bool succ = graph->addAttribute(srcID, dstID, relName, key, stripQuotes(value));
                 if (!succ) {
                     clangPrinter->printErrorTAProcess(Printer::RELATION_ATTRIBUTE, "(" + srcID + ", " + dstID + ")");
                     return false;
@@ -516,6 +851,71 @@ bool TAProcessor::writeAttributes(TAGraph* graph){
     return true;
 }
 
+/**
+ * Streams a single relation into a graph. Edges are added by ID and are
+ * resolved once the graph has been fully built.
+ * @param graph The graph to add to.
+ * @param relName The name of the relation.
+ * @param src The source ID.
+ * @param dst The destination ID (or the type for instances).
+ * @return Whether or not it was successful.
+ */
+bool TAProcessor::streamRelation(TAGraph* graph, const string& relName, const string& src, const string& dst){
+    if (relName.compare(entityString) == 0){
+        graph->addNode(new ClangNode(src, src, ClangNode::getTypeNode(dst)));
+        return true;
+    }
+
+    graph->addEdge(new ClangEdge(src, dst, ClangEdge::getTypeEdge(relName)));
+    return true;
+}
+
+/**
+ * Streams the attributes of an entity into a graph.
+ * @param graph The graph to add to.
+ * @param ID The ID of the entity.
+ * @param attrs The attributes to add.
+ * @return Whether or not it was successful.
+ */
+bool TAProcessor::streamAttributes(TAGraph* graph, const string& ID, const AttributeList& attrs){
+    for (const auto& kv : attrs){
+        for (const auto& value : kv.second){
+            bool succ = graph->addAttribute(ID, kv.first, stripQuotes(value));
+            if (!succ) {
+                clangPrinter->printErrorTAProcess(Printer::ENTITY_ATTRIBUTE, ID);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Streams the attributes of a relation into a graph.
+ * @param graph The graph to add to.
+ * @param relName The name of the relation.
+ * @param srcID The source ID.
+ * @param dstID The destination ID.
+ * @param attrs The attributes to add.
+ * @return Whether or not it was successful.
+ */
+bool TAProcessor::streamAttributes(TAGraph* graph, const string& relName, const string& srcID,
+                                   const string& dstID, const AttributeList& attrs){
+    ClangEdge::EdgeType type = ClangEdge::getTypeEdge(relName);
+    for (const auto& kv : attrs){
+        for (const auto& value : kv.second){
+            bool succ = graph->addAttribute(srcID, dstID, type, kv.first, stripQuotes(value));
+            if (!succ) {
+                clangPrinter->printErrorTAProcess(Printer::RELATION_ATTRIBUTE, "(" + srcID + ", " + dstID + ")");
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
 /**
  * Generates a TA string based on this system's internal representation.
  * @return The TA string.
@@ -547,11 +947,11 @@ string TAProcessor::generateRelationString(){
     relString += RELATION_FLAG + "\n";
 
     //Iterate through the relations.
-    for (auto curr : relations){
-        string relName = curr.first;
+    for (const auto& curr : relations){
+        const string& relName = curr.first;
 
         //Iterate through the entries.
-        for (auto currRel : curr.second){
+        for (const auto& currRel : curr.second){
             relString += relName + " " + currRel.first + " " + currRel.second + "\n";
         }
     }
@@ -569,15 +969,15 @@ string TAProcessor::generateAttributeString(){
     attrString += ATTRIBUTE_FLAG + "\n";
 
     //Iterate through the entity attributes first.
-    for (auto curr : attributes){
-        string attributeID = curr.first;
+    for (const auto& curr : attributes){
+        const string& attributeID = curr.first;
         attrString += attributeID + generateAttributeStringFromKVs(curr.second) + "\n";
     }
 
     //Next, deals with the relation attribute list.
-    for (auto curr : relAttributes){
-        vector<string> items = curr.first;
-        auto kVs = curr.second;
+    for (const auto& curr : relAttributes){
+        const vector<string>& items = curr.first;
+        const auto& kVs = curr.second;
 
         if (items.size() != 3) return "";
 
@@ -593,17 +993,17 @@ string TAProcessor::generateAttributeString(){
  * @param attr The attribute KV pair map.
  * @return The attribute string.
  */
-string TAProcessor::generateAttributeStringFromKVs(vector<pair<string, vector<string>>> attr){
+string TAProcessor::generateAttributeStringFromKVs(const AttributeList& attr){
     string attrString = " { ";
 
     //Iterate through the pairs.
-    for (auto currAttr : attr){
+    for (const auto& currAttr : attr){
         //Check what type of string we need to generate.
         if (currAttr.second.size() == 1){
             attrString += currAttr.first + " = " + currAttr.second.at(0) + " ";
         } else {
             attrString += currAttr.first + " = (";
-            for (auto value : currAttr.second)
+            for (const auto& value : currAttr.second)
                 attrString += " " + value;
 
             attrString += " ) ";
@@ -726,9 +1126,15 @@ vector<pair<string, vector<string>>> TAProcessor::generateAttributes(int lineNum
  */
 vector<string> TAProcessor::prepareLine(string line, bool& blockComment){
     //Perform comment processing.
-    line = removeStandardComment(line);
-    line = removeBlockComment(line, blockComment);
+    return tokenizeLine(removeComments(line, blockComment));
+}
 
+/**
+ * Splits a line without comments into its tokens.
+ * @param line The line to split.
+ * @return The tokenized string.
+ */
+vector<string> TAProcessor::tokenizeLine(const string& line){
     //Split into a vector.
     vector<string> stringList;
     boost::split(stringList, line, boost::is_any_of(" "));
@@ -748,6 +1154,17 @@ vector<string> TAProcessor::prepareLine(string line, bool& blockComment){
     return modified;
 }
 
+/**
+ * Removes standard and block comments from a line.
+ * @param line The line to process.
+ * @param blockComment Whether or not a block comment was encountered.
+ * @return The line without comments.
+ */
+string TAProcessor::removeComments(string line, bool& blockComment){
+    line = removeStandardComment(line);
+    return removeBlockComment(line, blockComment);
+}
+
 /**
  * Removes a standard comment from a line.
  * @param line The line to process.
@@ -778,6 +1195,9 @@ string TAProcessor::removeStandardComment(string line){
  * @return The line without the block comment.
  */
 string TAProcessor::removeBlockComment(string line, bool& blockComment){
+    //Lines without a comment character keep every character.
+    if (!blockComment && line.size() > 1 && line.find(COMMENT_CHAR) == string::npos) return line;
+
     string newLine = "";
 
     //Iterate through the string two characters at a time.
@@ -811,31 +1231,105 @@ string TAProcessor::removeBlockComment(string line, bool& blockComment){
 }
 
 /**
- * Finds a relationship entry.
- * @param name The name of the relationship.
- * @return The index of the relationship.
+ * Works out whether a block comment is open at the end of a chunk. Uses the
+ * same rules as removeStandardComment and removeBlockComment without copying lines.
+ * @param begin The start of the chunk.
+ * @param end The end of the chunk.
+ * @param blockComment Whether the chunk starts inside a block comment.
+ * @param numLines Set to the number of lines in the chunk (if not null).
+ * @return Whether a block comment is open at the end of the chunk.
  */
-int TAProcessor::findRelEntry(string name){
-    int i = 0;
+bool TAProcessor::scanBlockComments(const char* begin, const char* end, bool blockComment, int* numLines){
+    int lines = 0;
+
+    const char* cur = begin;
+    while (cur < end){
+        const char* lineEnd = (const char*) memchr(cur, '\n', end - cur);
+        if (lineEnd == nullptr) lineEnd = end;
+        lines++;
+
+        //Lines without a '*' can't change the state.
+        if (memchr(cur, COMMENT_BLOCK_CHAR, lineEnd - cur) != nullptr){
+            //Anything after a standard comment is ignored.
+            const char* stop = lineEnd;
+            for (const char* c = cur; c + 1 < lineEnd; c++){
+                if (c[0] == COMMENT_CHAR && c[1] == COMMENT_CHAR){
+                    stop = c;
+                    break;
+                }
+            }
+
+            //Looks for block comment starts and ends.
+            for (const char* c = cur; c + 1 < stop; c++){
+                if (blockComment && c[0] == COMMENT_BLOCK_CHAR && c[1] == COMMENT_CHAR){
+                    blockComment = false;
+                    c++;
+                } else if (!blockComment && c[0] == COMMENT_CHAR && c[1] == COMMENT_BLOCK_CHAR){
+                    blockComment = true;
+                    c++;
+                }
+            }
+        }
+
+        cur = lineEnd + 1;
+    }
+
+    if (numLines != nullptr) *numLines = lines;
+    return blockComment;
+}
+
+/**
+ * Counts the number of lines in a block of text.
+ * @param begin The start of the text.
+ * @param end The end of the text.
+ * @return The number of lines.
+ */
+int TAProcessor::countLines(const char* begin, const char* end){
+    int lines = 0;
 
-    //Goes through the relation vector.
-    for (auto rel : relations){
-        if (rel.first.compare(name) == 0) return i;
+    const char* cur = begin;
+    while (cur < end){
+        const char* lineEnd = (const char*) memchr(cur, '\n', end - cur);
+        if (lineEnd == nullptr) lineEnd = end;
 
-        i++;
+        lines++;
+        cur = lineEnd + 1;
     }
 
-    return -1;
+    return lines;
+}
+
+/**
+ * Removes the quotes around an attribute value. The graph adds them back on output.
+ * @param value The value to process.
+ * @return The value without quotes.
+ */
+string TAProcessor::stripQuotes(const string& value){
+    if (value.size() >= 2 && value.front() == '"' && value.back() == '"') return value.substr(1, value.size() - 2);
+    return value;
+}
+
+/**
+ * Finds a relationship entry.
+ * @param name The name of the relationship.
+ * @return The index of the relationship.
+ */
+int TAProcessor::findRelEntry(const string& name){
+    auto it = relationIndex.find(name);
+    if (it == relationIndex.end()) return -1;
+
+    return it->second;
 }
 
 /**
  * Creates a relationship entry in the system.
  * @param name The name of the relationship.
  */
-void TAProcessor::createRelEntry(string name){
+void TAProcessor::createRelEntry(const string& name){
     pair<string, set<pair<string, string>>> entry = pair<string, set<pair<string, string>>>();
     entry.first = name;
 
+    relationIndex[name] = (int) relations.size();
     relations.push_back(entry);
 }
 
@@ -844,17 +1338,11 @@ void TAProcessor::createRelEntry(string name){
  * @param attrName The name of the attribute.
  * @return The index of the attribute.
  */
-int TAProcessor::findAttrEntry(string attrName){
-    int i = 0;
+int TAProcessor::findAttrEntry(const string& attrName){
+    auto it = attributeIndex.find(attrName);
+    if (it == attributeIndex.end()) return -1;
 
-    //Goes through the attribute vector.
-    for (auto attr : attributes){
-        if (attr.first.compare(attrName) == 0) return i;
-
-        i++;
-    }
-
-    return -1;
+    return it->second;
 }
 
 /**
@@ -864,33 +1352,23 @@ int TAProcessor::findAttrEntry(string attrName){
  * @param dst The destination name.
  * @return The index of the attribute
  */
-int TAProcessor::findAttrEntry(string relName, string src, string dst){
-    int i = 0;
-
-    //Goes through the attribute vector
-    for (auto attr : relAttributes){
-        //Abort!
-        if (attr.first.size() != 3) return -1;
-
-        if (attr.first.at(0).compare(relName) == 0 &&
-                attr.first.at(1).compare(src) == 0 &&
-                attr.first.at(2).compare(dst) ==0) return i;
-
-        i++;
-    }
+int TAProcessor::findAttrEntry(const string& relName, const string& src, const string& dst){
+    auto it = relAttributeIndex.find(generateRelAttrKey(relName, src, dst));
+    if (it == relAttributeIndex.end()) return -1;
 
-    return -1;
+    return it->second;
 }
 
 /**
  * Creates an attribute entry.
  * @param attrName The name of the attribute.
  */
-void TAProcessor::createAttrEntry(string attrName){
+void TAProcessor::createAttrEntry(const string& attrName){
     //Create the pair object.
     pair<string, vector<pair<string, vector<string>>>> entry = pair<string, vector<pair<string, vector<string>>>>();
     entry.first = attrName;
 
+    attributeIndex[attrName] = (int) attributes.size();
     attributes.push_back(entry);
 }
 
@@ -900,7 +1378,7 @@ void TAProcessor::createAttrEntry(string attrName){
  * @param src The source name.
  * @param dst The destination name.
  */
-void TAProcessor::createAttrEntry(string relName, string src, string dst){
+void TAProcessor::createAttrEntry(const string& relName, const string& src, const string& dst){
     //Create the pair object.
     pair<vector<string>, vector<pair<string, vector<string>>>> entry =
         pair<vector<string>, vector<pair<string, vector<string>>>>();
@@ -908,9 +1386,22 @@ void TAProcessor::createAttrEntry(string relName, string src, string dst){
     entry.first.push_back(src);
     entry.first.push_back(dst);
 
+    relAttributeIndex[generateRelAttrKey(relName, src, dst)] = (int) relAttributes.size();
     relAttributes.push_back(entry);
 }
 
+/**
+ * Generates the key used to index a relation attribute. IDs never contain
+ * spaces since the TA format is space delimited.
+ * @param relName The name of the relation.
+ * @param src The source name.
+ * @param dst The destination name.
+ * @return The key for the relation attribute index.
+ */
+string TAProcessor::generateRelAttrKey(const string& relName, const string& src, const string& dst){
+    return relName + " " + src + " " + dst;
+}
+
 /**
  * Processes a collection of ClangNodes and adds them.
  * @param nodes The collection of ClangNodes.
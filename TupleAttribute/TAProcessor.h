@@ -30,10 +30,23 @@
 
 #include <string>
 #include <set>
+#include <functional>
+#include <unordered_map>
 #include "../Graph/TAGraph.h"
 
 class TAProcessor {
 public:
+    /** Attribute List */
+    typedef std::vector<std::pair<std::string, std::vector<std::string>>> AttributeList;
+
+    /** Streaming Callbacks */
+    struct TAHandler {
+        std::function<bool(const std::string&, const std::string&, const std::string&)> relation;
+        std::function<bool(const std::string&, const AttributeList&)> entityAttributes;
+        std::function<bool(const std::string&, const std::string&, const std::string&,
+                           const AttributeList&)> relationAttributes;
+    };
+
     /** Constructor/Destructor */
     TAProcessor(std::string entityRelName, Printer* print);
     ~TAProcessor();
@@ -46,10 +59,37 @@ public:
     bool readTAGraph(TAGraph* graph);
     TAGraph* writeTAGraph();
 
+    /** TA Streaming */
+    bool readTAFile(std::string fileName, TAGraph* graph);
+    bool readTAFile(std::string fileName, const TAHandler& handler);
+
+    /** TA Component Generators */
+    static std::string generateAttributeStringFromKVs(const AttributeList& attr);
+
+    /** TA Line Helpers */
+    static std::vector<std::string> prepareLine(std::string line, bool &blockComment);
+    static std::vector<std::string> tokenizeLine(const std::string& line);
+    static std::string removeComments(std::string line, bool &blockComment);
+    static std::string removeStandardComment(std::string line);
+    static std::string removeBlockComment(std::string line, bool &blockComment);
+
 private:
+    /** Section Types */
+    enum SectionType {NO_SECTION, SCHEME_SECTION, RELATION_SECTION, ATTRIBUTE_SECTION};
+
+    /** Streamed Entries Held While Chunks Are Parsed */
+    enum EntryType {RELATION_ENTRY, ATTRIBUTE_ENTRY, REL_ATTRIBUTE_ENTRY};
+    typedef struct {
+        EntryType type;
+        std::string name;
+        std::string src;
+        std::string dst;
+        AttributeList attrs;
+    } StreamEntry;
+
     /** Private Flags and Strings */
-    const char COMMENT_CHAR = '/';
-    const char COMMENT_BLOCK_CHAR = '*';
+    static const char COMMENT_CHAR = '/';
+    static const char COMMENT_BLOCK_CHAR = '*';
     const std::string UNEXPECTED_FLAG = "Unexpected flag.";
     const std::string RSF_INVALID = "Line should contain a single tuple in RSF format.";
     const std::string ATTRIBUTE_SHORT = "Attribute line is too short to be valid!";
@@ -57,44 +97,67 @@ private:
     const std::string ATTRIBUTE_FLAG = "FACT ATTRIBUTE :";
     const std::string SCHEME_FLAG = "SCHEME TUPLE :";
     const std::string SCHEMA_HEADER = "//TAProcessor TA File Created by ClangEx";
+    const size_t MIN_CHUNK_SIZE = 8 * 1024 * 1024;
 
     /** Private Variables */
     std::string entityString;
     Printer *clangPrinter;
+    const TAHandler *streamHandler = nullptr;
     std::vector<std::pair<std::string, std::set<std::pair<std::string, std::string>>>> relations;
     std::vector<std::pair<std::string, std::vector<std::pair<std::string, std::vector<std::string>>>>> attributes;
     std::vector<std::pair<std::vector<std::string>,
             std::vector<std::pair<std::string, std::vector<std::string>>>>> relAttributes;
 
+    /** Table Indexes */
+    std::unordered_map<std::string, int> relationIndex;
+    std::unordered_map<std::string, int> attributeIndex;
+    std::unordered_map<std::string, int> relAttributeIndex;
+
     /** TA Readers */
-    bool readGeneric(std::ifstream& modelStream, std::string fileName);
-    bool readScheme(std::ifstream& modelStream, int* lineNum);
-    bool readRelations(std::ifstream& modelStream, int* lineNum);
-    bool readAttributes(std::ifstream& modelStream, int* lineNum);
+    bool readGeneric(const char* data, size_t size);
+    std::vector<std::pair<size_t, SectionType>> findSectionFlags(const char* data, size_t size);
+    SectionType getSectionType(const char* data, size_t size, size_t offset);
+    bool readSection(const char* begin, const char* end, SectionType type, int& lineNum);
+    bool readChunk(const char* begin, const char* end, SectionType type, bool blockComment, int lineNum);
+    bool readRelationLine(const std::string& line, int lineNum, bool& blockComment);
+    bool readAttributeLine(const std::string& line, int lineNum, bool& blockComment);
+
+    /** Parallel Helpers */
+    std::vector<const char*> splitSection(const char* begin, const char* end, bool streaming);
+    void runChunks(int numChunks, const std::function<void(int)>& job);
+    bool streamChunks(const std::vector<const char*>& bounds, SectionType type, const std::vector<char>& startState,
+                      const std::vector<int>& startLine);
+    void mergeTables(TAProcessor& other);
 
     /** TA Writers */
     bool writeRelations(TAGraph* graph);
     bool writeAttributes(TAGraph* graph);
 
+    /** TA Graph Streamers */
+    bool streamRelation(TAGraph* graph, const std::string& relName, const std::string& src, const std::string& dst);
+    bool streamAttributes(TAGraph* graph, const std::string& ID, const AttributeList& attrs);
+    bool streamAttributes(TAGraph* graph, const std::string& relName, const std::string& srcID,
+                          const std::string& dstID, const AttributeList& attrs);
+
     /** TA Component Generators */
     std::string generateTAString();
     std::string generateRelationString();
     std::string generateAttributeString();
-    std::string generateAttributeStringFromKVs(std::vector<std::pair<std::string, std::vector<std::string>>> attr);
     std::vector<std::pair<std::string, std::vector<std::string>>> generateAttributes(int lineNum,
                                                                                      bool& succ,
                                                                                      std::vector<std::string> line);
 
     /** Helper Methods */
-    std::vector<std::string> prepareLine(std::string line, bool &blockComment);
-    std::string removeStandardComment(std::string line);
-    std::string removeBlockComment(std::string line, bool &blockComment);
-    int findRelEntry(std::string name);
-    void createRelEntry(std::string name);
-    int findAttrEntry(std::string attrName);
-    int findAttrEntry(std::string relName, std::string src, std::string dst);
-    void createAttrEntry(std::string attrName);
-    void createAttrEntry(std::string relName, std::string src, std::string dst);
+    bool scanBlockComments(const char* begin, const char* end, bool blockComment, int* numLines);
+    int countLines(const char* begin, const char* end);
+    int findRelEntry(const std::string& name);
+    void createRelEntry(const std::string& name);
+    int findAttrEntry(const std::string& attrName);
+    int findAttrEntry(const std::string& relName, const std::string& src, const std::string& dst);
+    void createAttrEntry(const std::string& attrName);
+    void createAttrEntry(const std::string& relName, const std::string& src, const std::string& dst);
+    std::string stripQuotes(const std::string& value);
+    std::string generateRelAttrKey(const std::string& relName, const std::string& src, const std::string& dst);
 
     /** Node / Edge Processors */
     void processNodes(std::vector<ClangNode*> nodes);
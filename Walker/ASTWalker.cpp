@@ -53,6 +53,47 @@ TAGraph* ASTWalker::getGraph(){
     return graph;
 }
 
+/**
+ * Gets the time spent adding matches to the graph.
+ * @return The time spent in the match callbacks.
+ */
+RunStats::Timing ASTWalker::getInsertTiming(){
+    return insertTiming;
+}
+
+/**
+ * Gets the number of entities added to the graph.
+ * @return The number of entities.
+ */
+unsigned long long ASTWalker::getNumNodes(){
+    return numNodes;
+}
+
+/**
+ * Gets the number of relations added to the graph.
+ * @return The number of relations.
+ */
+unsigned long long ASTWalker::getNumEdges(){
+    return numEdges;
+}
+
+/**
+ * Gives each matcher registered from now on its own timed callback.
+ */
+void ASTWalker::enableProfiling(){
+    profiling = true;
+}
+
+/**
+ * Adds the time spent in each matcher's callbacks to a run's stats.
+ * @param stats The stats of the run.
+ */
+void ASTWalker::recordProfile(RunStats* stats){
+    for (auto& callback : profiledCallbacks){
+        stats->addMatcherCallbacks(callback->name, callback->timing.wallSeconds, callback->numMatches);
+    }
+}
+
 /**
  * Generates an MD5 hash of the current string.
  * @param text The string to convert.
@@ -262,6 +303,7 @@ void ASTWalker::addFunctionDecl(const MatchFinder::MatchResult results, const Fu
     ClangNode* node = new ClangNode(ID, label, ClangNode::FUNCTION);
     bool succ = graph->addNode(node);
     if (!succ) return;
+    numNodes++;
 
     //Adds parameters.
     graph->addAttribute(node->getID(),
@@ -339,6 +381,7 @@ void ASTWalker::addVariableDecl(const MatchFinder::MatchResult results,
     ClangNode* node = new ClangNode(ID, label, ClangNode::VARIABLE);
     bool succ = graph->addNode(node);
     if (!succ) return;
+    numNodes++;
 
     //Process attributes.
     graph->addAttribute(node->getID(),
@@ -386,6 +429,7 @@ void ASTWalker::addClassDecl(const MatchFinder::MatchResult results, const CXXRe
     ClangNode* node = new ClangNode(ID, className, ClangNode::CLASS);
     bool succ = graph->addNode(node);
     if (!succ) return;
+    numNodes++;
 
     //Process attributes.
     graph->addAttribute(node->getID(),
@@ -426,6 +470,7 @@ void ASTWalker::addEnumDecl(const MatchFinder::MatchResult result, const EnumDec
     ClangNode* node = new ClangNode(ID, enumName, ClangNode::ENUM);
     bool succ = graph->addNode(node);
     if (!succ) return;
+    numNodes++;
 
     //Process attributes.
     graph->addAttribute(node->getID(),
@@ -452,6 +497,7 @@ void ASTWalker::addEnumConstantDecl(const MatchFinder::MatchResult result, const
     ClangNode* node = new ClangNode(ID, enumName, ClangNode::ENUM_CONST);
     bool succ = graph->addNode(node);
     if (!succ) return;
+    numNodes++;
 
     //Process attributes.
     graph->addAttribute(node->getID(),
@@ -478,6 +524,7 @@ void ASTWalker::addStructDecl(const MatchFinder::MatchResult result, const clang
     ClangNode* node = new ClangNode(ID, label, ClangNode::STRUCT);
     bool succ = graph->addNode(node);
     if (!succ) return;
+    numNodes++;
 
     //Process the attributes.
     graph->addAttribute(node->getID(),
@@ -507,6 +554,7 @@ void ASTWalker::addUnionDecl(const MatchFinder::MatchResult result, const Record
     ClangNode* node = new ClangNode(ID, label, ClangNode::UNION);
     bool succ = graph->addNode(node);
     if (!succ) return;
+    numNodes++;
 
     //Process the attributes.
     graph->addAttribute(node->getID(),
@@ -744,6 +792,7 @@ void ASTWalker::processEdge(string srcID, string srcLabel, string dstID, string
     }
     bool succ = graph->addEdge(edge);
     if (!succ) return;
+    numEdges++;
 
     //Iterate through our vector and add.
     for (auto mapItem : attributes) {
@@ -752,6 +801,34 @@ void ASTWalker::processEdge(string srcID, string srcLabel, string dstID, string
     }
 }
 
+/**
+ * Constructor. Sets up a callback that times matches before passing them on.
+ * @param walker The walker that handles the matches.
+ * @param name The name of the matcher.
+ */
+ASTWalker::ProfiledCallback::ProfiledCallback(ASTWalker* walker, string name){
+    this->walker = walker;
+    this->name = name;
+}
+
+/**
+ * Times a match and passes it on to the walker.
+ * @param result The match.
+ */
+void ASTWalker::ProfiledCallback::run(const MatchFinder::MatchResult &result){
+    RunStats::ScopedTimer timer(timing);
+    numMatches++;
+    walker->run(result);
+}
+
+/**
+ * Gets the name Clang profiles this callback's matcher under.
+ * @return The name of the matcher.
+ */
+StringRef ASTWalker::ProfiledCallback::getID() const {
+    return name;
+}
+
 /**
  * Prints the currently processed filename.
  * @param curFile The current file being processed.
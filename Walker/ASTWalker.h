@@ -31,6 +31,7 @@
 #include <vector>
 #include <tuple>
 #include <string>
+#include <memory>
 #include "clang/Frontend/FrontendActions.h"
 #include "clang/Tooling/CommonOptionsParser.h"
 #include "clang/Tooling/Tooling.h"
@@ -40,6 +41,7 @@
 #include "../Driver/ClangDriver.h"
 #include "../File/FileParse.h"
 #include "../Printer/Printer.h"
+#include "../Driver/RunStats.h"
 
 using namespace clang::ast_matchers;
 
@@ -55,16 +57,43 @@ public:
     /** Graph Operations */
     TAGraph* getGraph();
 
+    /** Stats */
+    RunStats::Timing getInsertTiming();
+    unsigned long long getNumNodes();
+    unsigned long long getNumEdges();
+
+    /** Matcher Profiling */
+    void enableProfiling();
+    void recordProfile(RunStats* stats);
+
     /** MD5 Operations */
     static std::string generateMD5(std::string text);
 
 protected:
     /** Protected Variables */
     TAGraph::ClangExclude exclusions;
+    RunStats::Timing insertTiming;
 
     /** Constructor */
     ASTWalker(TAGraph::ClangExclude ex, bool lowMemory, Printer* print, TAGraph* existing = nullptr);
 
+    /**
+     * Registers a matcher. When profiling, each matcher gets its own callback
+     * so its time and matches are kept apart from the others.
+     * @param finder The match finder.
+     * @param matcher The matcher.
+     * @param name The name the matcher is profiled under.
+     */
+    template <typename T> void addMatcher(MatchFinder* finder, const T& matcher, const char* name){
+        if (!profiling){
+            finder->addMatcher(matcher, this);
+            return;
+        }
+
+        profiledCallbacks.push_back(std::unique_ptr<ProfiledCallback>(new ProfiledCallback(this, name)));
+        finder->addMatcher(matcher, profiledCallbacks.back().get());
+    }
+
     /** Item Qualifiers */
     std::string generateFileName(const MatchFinder::MatchResult result,
                                  clang::SourceLocation loc, bool suppressOutput = false);
@@ -111,6 +140,21 @@ protected:
 /********************************************************************************************************************/
 
 private:
+    /** Times The Matches Of A Single Matcher */
+    class ProfiledCallback : public MatchFinder::MatchCallback {
+    public:
+        ProfiledCallback(ASTWalker* walker, std::string name);
+        void run(const MatchFinder::MatchResult &result) override;
+        llvm::StringRef getID() const override;
+
+        std::string name;
+        RunStats::Timing timing;
+        unsigned long long numMatches = 0;
+
+    private:
+        ASTWalker* walker;
+    };
+
     /** Private Const Variables */
     const static int ANON_SIZE = 4;
     const std::string ANON_LIST[ANON_SIZE] = {"(anonymous struct)", "(union struct)", "(anonymous)", "(anonymous union)"};
@@ -122,6 +166,10 @@ private:
     std::string curFileName;
     TAGraph* graph;
     Printer *clangPrinter;
+    unsigned long long numNodes = 0;
+    unsigned long long numEdges = 0;
+    bool profiling = false;
+    std::vector<std::unique_ptr<ProfiledCallback>> profiledCallbacks;
 
     /** Edge Processor */
     void processEdge(std::string srcID, std::string srcLabel, std::string dstID, std::string dstLabel,
@@ -48,6 +48,8 @@ BlobWalker::~BlobWalker(){ }
  * @param result The result that triggers this function.
  */
 void BlobWalker::run(const MatchFinder::MatchResult &result) {
+    RunStats::ScopedTimer timer(insertTiming);
+
     //Check if the current result fits any of our match criteria.
     if (const FunctionDecl *functionDecl = result.Nodes.getNodeAs<clang::FunctionDecl>(types[FUNC_DEC])) {
         //Get whether we have a system header.
@@ -238,93 +240,93 @@ void BlobWalker::generateASTMatches(MatchFinder *finder){
     //Function methods.
     if (!exclusions.cFunction){
         //Finds function declarations for current C/C++ file.
-        finder->addMatcher(functionDecl(isDefinition()).bind(types[FUNC_DEC]), this);
+        addMatcher(finder, functionDecl(isDefinition()).bind(types[FUNC_DEC]), types[FUNC_DEC]);
 
         //Finds function calls from one function to another.
-        finder->addMatcher(callExpr(hasAncestor(functionDecl().bind(types[FUNC_CALLER]))).bind(types[FUNC_CALLEE]), this);
+        addMatcher(finder, callExpr(hasAncestor(functionDecl().bind(types[FUNC_CALLER]))).bind(types[FUNC_CALLEE]), types[FUNC_CALLEE]);
     }
 
     //Variable methods.
     if (!exclusions.cVariable){
         //Finds variable declarations in functions AND in class decs.
-        finder->addMatcher(varDecl().bind(types[VAR_DEC]), this);
-        finder->addMatcher(fieldDecl().bind(types[FIELD_DEC]), this);
+        addMatcher(finder, varDecl().bind(types[VAR_DEC]), types[VAR_DEC]);
+        addMatcher(finder, fieldDecl().bind(types[FIELD_DEC]), types[FIELD_DEC]);
 
         //Adds scope for variables.
-        finder->addMatcher(varDecl(hasAncestor(functionDecl().bind(types[INSIDE_FUNC]))).bind(types[VAR_INSIDE]), this);
-        finder->addMatcher(fieldDecl(hasAncestor(functionDecl().bind(types[INSIDE_FUNC]))).bind(types[FIELD_INSIDE]), this);
-        finder->addMatcher(parmVarDecl(hasAncestor(functionDecl()
-                                                           .bind(types[FUNC_PARAM]))).bind(types[VAR_PARAM]), this);
+        addMatcher(finder, varDecl(hasAncestor(functionDecl().bind(types[INSIDE_FUNC]))).bind(types[VAR_INSIDE]), types[VAR_INSIDE]);
+        addMatcher(finder, fieldDecl(hasAncestor(functionDecl().bind(types[INSIDE_FUNC]))).bind(types[FIELD_INSIDE]), types[FIELD_INSIDE]);
+        addMatcher(finder, parmVarDecl(hasAncestor(functionDecl()
+                                                           .bind(types[FUNC_PARAM]))).bind(types[VAR_PARAM]), types[VAR_PARAM]);
         
         //Finds variable uses amongst functions.
-        finder->addMatcher(declRefExpr(hasDeclaration(varDecl().bind(types[VAR_CALLEE])),
+        addMatcher(finder, declRefExpr(hasDeclaration(varDecl().bind(types[VAR_CALLEE])),
                            hasAncestor(functionDecl().bind(types[VAR_CALLER])),
-                           hasParent(expr().bind(types[VAR_EXPR]))), this);
-        finder->addMatcher(declRefExpr(hasDeclaration(fieldDecl().bind(types[FIELD_CALLEE])),
+                           hasParent(expr().bind(types[VAR_EXPR]))), types[VAR_CALLEE]);
+        addMatcher(finder, declRefExpr(hasDeclaration(fieldDecl().bind(types[FIELD_CALLEE])),
                                        hasAncestor(functionDecl().bind(types[VAR_CALLER])),
-                                       hasParent(expr().bind(types[FIELD_EXPR]))), this);
+                                       hasParent(expr().bind(types[FIELD_EXPR]))), types[FIELD_CALLEE]);
     }
 
     //Class methods.
     if (!exclusions.cClass){
         //Finds class declarations.
-        finder->addMatcher(cxxRecordDecl(isClass()).bind(types[CLASS_DEC]), this);
+        addMatcher(finder, cxxRecordDecl(isClass()).bind(types[CLASS_DEC]), types[CLASS_DEC]);
     }
 
     //Enum methods.
     if (!exclusions.cEnum){
         //Finds enum declarations.
-        finder->addMatcher(enumDecl().bind(types[ENUM_DEC]), this);
+        addMatcher(finder, enumDecl().bind(types[ENUM_DEC]), types[ENUM_DEC]);
 
         //Finds enum constant declarations.
         //Also deals with their connections to enums.
-        finder->addMatcher(enumConstantDecl().bind(types[ENUM_CONST_DECL]), this);
-        finder->addMatcher(enumConstantDecl(hasAncestor(enumDecl().bind(types[ENUM_PARENT])))
-                .bind(types[ENUM_CONST_DECL]), this);
+        addMatcher(finder, enumConstantDecl().bind(types[ENUM_CONST_DECL]), types[ENUM_CONST_DECL]);
+        addMatcher(finder, enumConstantDecl(hasAncestor(enumDecl().bind(types[ENUM_PARENT])))
+                .bind(types[ENUM_CONST_DECL]), types[ENUM_CONST_DECL]);
 
         //Looks for enum references.
-        finder->addMatcher(varDecl(hasType(enumDecl().bind(types[ENUM_DEC_REF]))).bind(types[VAR_REF_ENUM]), this);
-        finder->addMatcher(fieldDecl(hasType(enumDecl().bind(types[ENUM_DEC_REF]))).bind(types[FIELD_REF_ENUM]), this);
+        addMatcher(finder, varDecl(hasType(enumDecl().bind(types[ENUM_DEC_REF]))).bind(types[VAR_REF_ENUM]), types[VAR_REF_ENUM]);
+        addMatcher(finder, fieldDecl(hasType(enumDecl().bind(types[ENUM_DEC_REF]))).bind(types[FIELD_REF_ENUM]), types[FIELD_REF_ENUM]);
     }
 
     //Struct methods.
     if (!exclusions.cStruct){
         //Builds the struct definition.
-        finder->addMatcher(recordDecl(isStruct()).bind(types[STRUCT_DECL]), this);
+        addMatcher(finder, recordDecl(isStruct()).bind(types[STRUCT_DECL]), types[STRUCT_DECL]);
 
         //Builds up struct.
-        finder->addMatcher(varDecl(hasAncestor(recordDecl(isStruct()).bind(types[STRUCT_REF])))
-                                   .bind(types[STRUCT_REF_ITEM]), this);
-        finder->addMatcher(fieldDecl(hasAncestor(recordDecl(isStruct()).bind(types[STRUCT_REF])))
-                                   .bind(types[STRUCT_REF_ITEM]), this);
-        finder->addMatcher(functionDecl(hasAncestor(recordDecl(isStruct()).bind(types[STRUCT_REF])))
-                                   .bind(types[STRUCT_REF_ITEM]), this);
+        addMatcher(finder, varDecl(hasAncestor(recordDecl(isStruct()).bind(types[STRUCT_REF])))
+                                   .bind(types[STRUCT_REF_ITEM]), types[STRUCT_REF_ITEM]);
+        addMatcher(finder, fieldDecl(hasAncestor(recordDecl(isStruct()).bind(types[STRUCT_REF])))
+                                   .bind(types[STRUCT_REF_ITEM]), types[STRUCT_REF_ITEM]);
+        addMatcher(finder, functionDecl(hasAncestor(recordDecl(isStruct()).bind(types[STRUCT_REF])))
+                                   .bind(types[STRUCT_REF_ITEM]), types[STRUCT_REF_ITEM]);
 
         //Builds the struct reference.
-        finder->addMatcher(varDecl(hasType(elaboratedType(namesType(recordType(hasDeclaration(recordDecl(isStruct())
-                           .bind(types[STRUCT_REF_DECL]))))))).bind(types[VAR_BOUND_STRUCT]), this);
-        finder->addMatcher(fieldDecl(hasType(elaboratedType(namesType(recordType(hasDeclaration(recordDecl(isStruct())
-                           .bind(types[STRUCT_REF_DECL]))))))).bind(types[FIELD_BOUND_STRUCT]), this);
+        addMatcher(finder, varDecl(hasType(elaboratedType(namesType(recordType(hasDeclaration(recordDecl(isStruct())
+                           .bind(types[STRUCT_REF_DECL]))))))).bind(types[VAR_BOUND_STRUCT]), types[VAR_BOUND_STRUCT]);
+        addMatcher(finder, fieldDecl(hasType(elaboratedType(namesType(recordType(hasDeclaration(recordDecl(isStruct())
+                           .bind(types[STRUCT_REF_DECL]))))))).bind(types[FIELD_BOUND_STRUCT]), types[FIELD_BOUND_STRUCT]);
     }
 
     //Union methods.
     if (!exclusions.cUnion){
         //Builds the union definition.
-        finder->addMatcher(recordDecl(isUnion()).bind(types[UNION_DECL]), this);
+        addMatcher(finder, recordDecl(isUnion()).bind(types[UNION_DECL]), types[UNION_DECL]);
 
         //Builds up union.
-        finder->addMatcher(varDecl(hasAncestor(recordDecl(isUnion()).bind(types[UNION_REF])))
-                                   .bind(types[UNION_REF_ITEM]), this);
-        finder->addMatcher(fieldDecl(hasAncestor(recordDecl(isUnion()).bind(types[UNION_REF])))
-                                   .bind(types[UNION_REF_ITEM]), this);
-        finder->addMatcher(functionDecl(hasAncestor(recordDecl(isUnion()).bind(types[UNION_REF])))
-                                   .bind(types[UNION_REF_ITEM]), this);
+        addMatcher(finder, varDecl(hasAncestor(recordDecl(isUnion()).bind(types[UNION_REF])))
+                                   .bind(types[UNION_REF_ITEM]), types[UNION_REF_ITEM]);
+        addMatcher(finder, fieldDecl(hasAncestor(recordDecl(isUnion()).bind(types[UNION_REF])))
+                                   .bind(types[UNION_REF_ITEM]), types[UNION_REF_ITEM]);
+        addMatcher(finder, functionDecl(hasAncestor(recordDecl(isUnion()).bind(types[UNION_REF])))
+                                   .bind(types[UNION_REF_ITEM]), types[UNION_REF_ITEM]);
 
         //Builds the struct reference.
-        finder->addMatcher(varDecl(hasType(elaboratedType(namesType(recordType(hasDeclaration(recordDecl(isUnion())
-                           .bind(types[UNION_REF_DECL]))))))).bind(types[VAR_BOUND_UNION]), this);
-        finder->addMatcher(fieldDecl(hasType(elaboratedType(namesType(recordType(hasDeclaration(recordDecl(isUnion())
-                           .bind(types[UNION_REF_DECL]))))))).bind(types[FIELD_BOUND_UNION]), this);
+        addMatcher(finder, varDecl(hasType(elaboratedType(namesType(recordType(hasDeclaration(recordDecl(isUnion())
+                           .bind(types[UNION_REF_DECL]))))))).bind(types[VAR_BOUND_UNION]), types[VAR_BOUND_UNION]);
+        addMatcher(finder, fieldDecl(hasType(elaboratedType(namesType(recordType(hasDeclaration(recordDecl(isUnion())
+                           .bind(types[UNION_REF_DECL]))))))).bind(types[FIELD_BOUND_UNION]), types[FIELD_BOUND_UNION]);
     }
 }
 
@@ -52,6 +52,8 @@ PartialWalker::~PartialWalker() { }
  * @param result The result that triggers this function.
  */
 void PartialWalker::run(const MatchFinder::MatchResult &result) {
+    RunStats::ScopedTimer timer(insertTiming);
+
     //Look for the AST matcher being triggered.
     if (const FunctionDecl *functionDecl = result.Nodes.getNodeAs<clang::FunctionDecl>(types[FUNC_DEC])) {
         //If a function has been found.
@@ -138,50 +140,50 @@ void PartialWalker::generateASTMatches(MatchFinder *finder) {
     //Function methods.
     if (!exclusions.cFunction){
         //Finds function declarations for current C/C++ file.
-        finder->addMatcher(functionDecl(isExpansionInMainFile()).bind(types[FUNC_DEC]), this);
+        addMatcher(finder, functionDecl(isExpansionInMainFile()).bind(types[FUNC_DEC]), types[FUNC_DEC]);
 
         //Finds function calls from one function to another.
-        finder->addMatcher(callExpr(isExpansionInMainFile(), hasAncestor(functionDecl().bind(types[CALLER]))).bind(types[FUNC_CALL]), this);
+        addMatcher(finder, callExpr(isExpansionInMainFile(), hasAncestor(functionDecl().bind(types[CALLER]))).bind(types[FUNC_CALL]), types[FUNC_CALL]);
     }
 
     //Variable methods.
     if (!exclusions.cVariable){
         //Finds variables in functions or in class declaration.
-        finder->addMatcher(varDecl(isExpansionInMainFile()).bind(types[VAR_DEC]), this);
+        addMatcher(finder, varDecl(isExpansionInMainFile()).bind(types[VAR_DEC]), types[VAR_DEC]);
 
         //Finds variable uses from a function to a variable.
-        finder->addMatcher(declRefExpr(hasDeclaration(varDecl(isExpansionInMainFile()).bind(types[VAR_CALL])),
+        addMatcher(finder, declRefExpr(hasDeclaration(varDecl(isExpansionInMainFile()).bind(types[VAR_CALL])),
                                        hasAncestor(functionDecl().bind(types[CALLER_VAR])),
-                                       hasParent(expr().bind(types[VAR_EXPR]))), this);
+                                       hasParent(expr().bind(types[VAR_EXPR]))), types[VAR_CALL]);
     }
 
     //Class methods.
     if (!exclusions.cClass){
         //Finds any class declarations.
-        finder->addMatcher(varDecl(isExpansionInMainFile(), hasAncestor(functionDecl().bind(types[CLASS_DEC_FUNC])))
-                                   .bind(types[CLASS_DEC_VAR]), this);
+        addMatcher(finder, varDecl(isExpansionInMainFile(), hasAncestor(functionDecl().bind(types[CLASS_DEC_FUNC])))
+                                   .bind(types[CLASS_DEC_VAR]), types[CLASS_DEC_VAR]);
     }
 
     if (!exclusions.cEnum){
         //Finds enum declarations (assuming they're defined in the source file).
-        finder->addMatcher(enumDecl(isExpansionInMainFile()).bind(types[ENUM_DEC]), this);
+        addMatcher(finder, enumDecl(isExpansionInMainFile()).bind(types[ENUM_DEC]), types[ENUM_DEC]);
 
         //Finds enums, adds them, and adds their associated references.
-        finder->addMatcher(varDecl(isExpansionInMainFile(),
-                                   hasType(enumType(hasDeclaration(enumDecl().bind(types[ENUM_DEC]))))).bind(types[ENUM_VAR]), this);
+        addMatcher(finder, varDecl(isExpansionInMainFile(),
+                                   hasType(enumType(hasDeclaration(enumDecl().bind(types[ENUM_DEC]))))).bind(types[ENUM_VAR]), types[ENUM_VAR]);
     }
 
     if (!exclusions.cStruct){
         //Finds struct declarations.
-        finder->addMatcher(recordDecl(isStruct(), isExpansionInMainFile()).bind(types[STRUCT_DECL]), this);
+        addMatcher(finder, recordDecl(isStruct(), isExpansionInMainFile()).bind(types[STRUCT_DECL]), types[STRUCT_DECL]);
 
         //Finds items that are part of structs.
-        finder->addMatcher(varDecl(isExpansionInMainFile(),
-                                   hasAncestor(recordDecl(isStruct()).bind(types[STRUCT_REF]))).bind(types[STRUCT_REF_ITEM]), this);
-        finder->addMatcher(fieldDecl(isExpansionInMainFile(),
-                                     hasAncestor(recordDecl(isStruct()).bind(types[STRUCT_REF]))).bind(types[STRUCT_REF_ITEM]), this);
-        finder->addMatcher(functionDecl(isExpansionInMainFile(),
-                                        hasAncestor(recordDecl(isStruct()).bind(types[STRUCT_REF]))).bind(types[STRUCT_REF_ITEM]), this);
+        addMatcher(finder, varDecl(isExpansionInMainFile(),
+                                   hasAncestor(recordDecl(isStruct()).bind(types[STRUCT_REF]))).bind(types[STRUCT_REF_ITEM]), types[STRUCT_REF_ITEM]);
+        addMatcher(finder, fieldDecl(isExpansionInMainFile(),
+                                     hasAncestor(recordDecl(isStruct()).bind(types[STRUCT_REF]))).bind(types[STRUCT_REF_ITEM]), types[STRUCT_REF_ITEM]);
+        addMatcher(finder, functionDecl(isExpansionInMainFile(),
+                                        hasAncestor(recordDecl(isStruct()).bind(types[STRUCT_REF]))).bind(types[STRUCT_REF_ITEM]), types[STRUCT_REF_ITEM]);
     }
 }
 